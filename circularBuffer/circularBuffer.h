@@ -2,11 +2,31 @@
  ******************************************************************************
  * @file	circularBuffer.h
  * @author	Hampus Sandberg
- * @version	0.1
- * @date	2013-02-10
+ * @version	0.4
+ * @date	2014-11-23
  * @brief	A circular buffer with functionality to insert and remove items
- *			The buffer will use CIRCULARBUFFER_SIZE + 5 bytes (37 bytes default) 
- *			of SRAM
+ *			The buffer is lock-free for one producer and one consumer, e.g.
+ *			an ISR inserting and a task removing, so no critical sections are
+ *			needed around the calls.
+ *
+ *			All functions are static inline so the compiler can inline them
+ *			into the ISRs that use them. The same header is used by the
+ *			bare-metal and the FreeRTOS drivers, the circularBuffer_xxx names
+ *			are kept for the bare-metal code. Include it as
+ *			"circularBuffer/circularBuffer.h" with the repository root on the
+ *			include path.
+ *
+ *			CircularBuffer_TypeDef and the CIRC_BUFFER_xxx functions use
+ *			CIRCULARBUFFER_SIZE and CIRCULARBUFFER_DATATYPE. Buffers that need
+ *			their own size or type are generated with CIRC_BUFFER_DECLARE,
+ *			which is the same implementation, e.g:
+ *
+ *			CIRC_BUFFER_DECLARE(PacketBuffer, Packet_TypeDef, 8)
+ *			CIRC_BUFFER_DECLARE(LogBuffer, uint8_t, 1024)
+ *
+ *			PacketBuffer_TypeDef rxPackets;
+ *			PacketBuffer_Init(&rxPackets);
+ *			PacketBuffer_Insert(&rxPackets, packet);
  ******************************************************************************
  */
 
@@ -16,47 +36,908 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f10x.h"
-#include "common.h"
+#include <string.h>
+#if defined(__cplusplus)
+#include <type_traits>
+#endif
+
+/*
+ * Define CIRCULARBUFFER_STATISTICS to count peak occupancy, inserts and drops
+ * for every buffer. Define CIRCULARBUFFER_TIMESTAMPS as well to also store the
+ * time every item was inserted, by default in FreeRTOS ticks. Bare-metal builds
+ * have to define CIRCULARBUFFER_TIMESTAMP() themselves, e.g. as DWT->CYCCNT.
+ * The statistics are written to an OUT_Device, and as the bare-metal and the
+ * FreeRTOS outstream headers have the same name but a different OUT_Device,
+ * CIRCULARBUFFER_OUTSTREAM_HEADER has to name the one the project links, e.g.
+ * "freertos-compatible/outstream/outstream.h"
+ */
+#if defined(CIRCULARBUFFER_TIMESTAMPS) && !defined(CIRCULARBUFFER_STATISTICS)
+#define CIRCULARBUFFER_STATISTICS
+#endif
+
+#if defined(CIRCULARBUFFER_STATISTICS)
+#if !defined(CIRCULARBUFFER_OUTSTREAM_HEADER)
+#error "Define CIRCULARBUFFER_OUTSTREAM_HEADER to the outstream header the project links"
+#endif
+#include CIRCULARBUFFER_OUTSTREAM_HEADER
+#endif
+
+#if defined(CIRCULARBUFFER_TIMESTAMPS) && !defined(CIRCULARBUFFER_TIMESTAMP)
+#include "FreeRTOS.h"
+#include "task.h"
+#define CIRCULARBUFFER_TIMESTAMP()	xTaskGetTickCountFromISR()
+#endif
 
 /* Defines -------------------------------------------------------------------*/
 #ifndef CIRCULARBUFFER_SIZE
-#warning "CIRCULARBUFFER_SIZE is not defined. Will now define it to 64"
+//#warning "CIRCULARBUFFER_SIZE is not defined. Will now define it to 64"
 #define CIRCULARBUFFER_SIZE	64
 #endif
 
 #ifndef CIRCULARBUFFER_DATATYPE
-#warning "CIRCULARBUFFER_DATATYPE is not defined. Will now define it to uint8_t"
+//#warning "CIRCULARBUFFER_DATATYPE is not defined. Will now define it to uint8_t"
 #define CIRCULARBUFFER_DATATYPE	uint8_t
 #endif
 
-#if (CIRCULARBUFFER_SIZE <= 0xFF)
-#define CIRCULARBUFFER_COUNTTYPE    uint8_t
+#if (CIRCULARBUFFER_SIZE & (CIRCULARBUFFER_SIZE - 1)) != 0
+#error "CIRCULARBUFFER_SIZE has to be a power of two"
+#endif
+
+#define CIRCULARBUFFER_MASK			(CIRCULARBUFFER_SIZE - 1)
+
+/*
+ * Makes sure the data in the buffer is written/read before the index that
+ * publishes it is updated, and that the index is read before the data
+ */
+#define CIRCULARBUFFER_MEMORY_BARRIER()	__DMB()
+
+/*
+ * memcpy and memchr can't be used on volatile data, e.g. when
+ * CIRCULARBUFFER_DATATYPE is volatile uint8_t as in hexapod/board.h, so
+ * buffers of volatile items are copied and searched one item at a time
+ */
+#if defined(__cplusplus)
+#define CIRCULARBUFFER_IS_VOLATILE(TYPE)	(std::is_volatile<TYPE>::value)
+#else
+#define CIRCULARBUFFER_IS_VOLATILE(TYPE)	_Generic((TYPE*)0, volatile TYPE*: 1, default: 0)
+#endif
+
+/* Names used by the bare-metal drivers */
+#define circularBuffer_Init		CIRC_BUFFER_Init
+#define circularBuffer_Insert	CIRC_BUFFER_Insert
+#define circularBuffer_Remove	CIRC_BUFFER_Remove
+#define circularBuffer_GetCount	CIRC_BUFFER_GetCount
+#define circularBuffer_IsEmpty	CIRC_BUFFER_IsEmpty
+#define circularBuffer_IsFull	CIRC_BUFFER_IsFull
+
+/* Typedefs ------------------------------------------------------------------*/
+/**
+ * @brief  What to do when inserting into a full buffer
+ */
+typedef enum
+{
+	CircularBufferPolicy_DropNewest,		/* The new data is dropped, the default */
+	CircularBufferPolicy_OverwriteOldest,	/* The oldest data is overwritten, e.g. for telemetry streams */
+} CircularBufferPolicy;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Atomically replace a value if it still has the expected value
+ * @param	Address: the value to replace
+ * @param	Expected: the value that Address should have
+ * @param	New: the new value
+ * @retval	(1) if the value was replaced, (0) if it had been changed by someone else
+ */
+static inline uint8_t CIRC_BUFFER_CompareAndSwap(volatile uint32_t* Address, uint32_t Expected, uint32_t New)
+{
+	do
+	{
+		if (__LDREXW((uint32_t*)Address) != Expected)
+		{
+			__CLREX();
+			return 0;
+		}
+	} while (__STREXW(New, (uint32_t*)Address) != 0);
+
+	return 1;
+}
+
+/* Statistics ----------------------------------------------------------------*/
+/*
+ * The statistics are generated together with every buffer type, so the
+ * timestamps are sized for it. Without CIRCULARBUFFER_STATISTICS all of the
+ * macros below expand to nothing. The timestamps are stored before the
+ * barrier that publishes the items, so the consumer never reads a stale one
+ */
+#if defined(CIRCULARBUFFER_TIMESTAMPS)
+#define CIRC_BUFFER_TIMESTAMPS_FIELD(SIZE)		uint32_t timestamps[SIZE];	/* The time each item was inserted */
+#define CIRC_BUFFER_STORE_TIMESTAMPS(BUFFER, IN, INSERTED, SIZE)														\
+	{																													\
+		uint32_t timestamp = CIRCULARBUFFER_TIMESTAMP();																\
+		for (uint32_t i = 0; i < (INSERTED); i++)																		\
+			(BUFFER)->statistics.timestamps[((IN) + i) & ((SIZE) - 1)] = timestamp;										\
+	}
+#define CIRC_BUFFER_DECLARE_TIMESTAMPS(NAME, SIZE)																		\
+	/**																													\
+	 * @brief	Get the time when the oldest item in the buffer was inserted											\
+	 * @param	Buffer: the buffer to check																				\
+	 * @param	Timestamp: where the timestamp should be stored, in CIRCULARBUFFER_TIMESTAMP() units					\
+	 * @retval	(1) if there was an item, (0) if the buffer was empty													\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline uint8_t NAME##_GetOldestTimestamp(NAME##_TypeDef* Buffer, uint32_t* Timestamp)						\
+	{																													\
+		uint32_t out = Buffer->out;																						\
+		if (Buffer->in == out)																							\
+			return 0;																									\
+																														\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		*Timestamp = Buffer->statistics.timestamps[out & ((SIZE) - 1)];													\
+		return 1;																										\
+	}
+#define CIRC_BUFFER_WRITE_OLDEST_AGE(NAME, BUFFER, OUTDEVICE)															\
+	{																													\
+		uint32_t timestamp;																								\
+		if (NAME##_GetOldestTimestamp(BUFFER, &timestamp))																\
+		{																												\
+			OUT_WriteString(OUTDEVICE, ", oldest age=");																\
+			OUT_WriteNumber(OUTDEVICE, CIRCULARBUFFER_TIMESTAMP() - timestamp, 0);										\
+		}																												\
+	}
+#else
+#define CIRC_BUFFER_TIMESTAMPS_FIELD(SIZE)
+#define CIRC_BUFFER_STORE_TIMESTAMPS(BUFFER, IN, INSERTED, SIZE)
+#define CIRC_BUFFER_DECLARE_TIMESTAMPS(NAME, SIZE)
+#define CIRC_BUFFER_WRITE_OLDEST_AGE(NAME, BUFFER, OUTDEVICE)
+#endif
+
+#if defined(CIRCULARBUFFER_STATISTICS)
+#define CIRC_BUFFER_STATISTICS_FIELD(SIZE)																				\
+	struct																												\
+	{																													\
+		uint32_t peakCount;		/* The highest number of items that has been in the buffer */							\
+		uint32_t inserts;		/* Number of items inserted */															\
+		uint32_t drops;			/* Number of new items dropped because the buffer was full */							\
+		CIRC_BUFFER_TIMESTAMPS_FIELD(SIZE)																				\
+	} statistics;				/* Statistics used to size the buffer, only updated by the producer */
+#define CIRC_BUFFER_UPDATE_STATISTICS(NAME, BUFFER, IN, INSERTED, DROPPED)	prv##NAME##_UpdateStatistics(BUFFER, IN, INSERTED, DROPPED)
+#define CIRC_BUFFER_RESET_STATISTICS(NAME, BUFFER)							NAME##_ResetStatistics(BUFFER)
+#define CIRC_BUFFER_DECLARE_STATISTICS(NAME, SIZE)																		\
+	/**																													\
+	 * @brief	Update the statistics after the producer has inserted items												\
+	 * @param	Buffer: the buffer to update																			\
+	 * @param	In: the in index before the items were inserted															\
+	 * @param	Inserted: number of items inserted																		\
+	 * @param	Dropped: number of items dropped because the buffer was full											\
+	 * @retval	None																									\
+	 */																													\
+	static inline void prv##NAME##_UpdateStatistics(NAME##_TypeDef* Buffer, uint32_t In, uint32_t Inserted, uint32_t Dropped) \
+	{																													\
+		Buffer->statistics.inserts += Inserted;																			\
+		Buffer->statistics.drops += Dropped;																			\
+																														\
+		uint32_t count = (In + Inserted) - Buffer->out;																	\
+		if (count > (SIZE))																								\
+			count = (SIZE);																								\
+		if (count > Buffer->statistics.peakCount)																		\
+			Buffer->statistics.peakCount = count;																		\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Reset the statistics for a buffer																		\
+	 * @param	Buffer: the buffer to reset the statistics for															\
+	 * @retval	None																									\
+	 */																													\
+	static inline void NAME##_ResetStatistics(NAME##_TypeDef* Buffer)													\
+	{																													\
+		Buffer->statistics.peakCount = 0;																				\
+		Buffer->statistics.inserts = 0;																					\
+		Buffer->statistics.drops = 0;																					\
+	}
+#define CIRC_BUFFER_DECLARE_STATISTICS_OUTPUT(NAME, SIZE)																\
+	CIRC_BUFFER_DECLARE_TIMESTAMPS(NAME, SIZE)																			\
+																														\
+	/**																													\
+	 * @brief	Write the statistics for a buffer to an OUT Device														\
+	 * @param	Buffer: the buffer to write the statistics for															\
+	 * @param	Name: name of the buffer to write before the statistics													\
+	 * @param	OutDevice: the OUT Device to write to																	\
+	 * @retval	None																									\
+	 */																													\
+	static inline void NAME##_DumpStatistics(NAME##_TypeDef* Buffer, const char* Name, OUT_Device* OutDevice)			\
+	{																													\
+		OUT_WriteString(OutDevice, Name);																				\
+		OUT_WriteString(OutDevice, ": size=");																			\
+		OUT_WriteNumber(OutDevice, (SIZE), 0);																			\
+		OUT_WriteString(OutDevice, ", count=");																			\
+		OUT_WriteNumber(OutDevice, NAME##_GetCount(Buffer), 0);															\
+		OUT_WriteString(OutDevice, ", peak=");																			\
+		OUT_WriteNumber(OutDevice, Buffer->statistics.peakCount, 0);													\
+		OUT_WriteString(OutDevice, ", inserts=");																		\
+		OUT_WriteNumber(OutDevice, Buffer->statistics.inserts, 0);														\
+		OUT_WriteString(OutDevice, ", drops=");																			\
+		OUT_WriteNumber(OutDevice, Buffer->statistics.drops, 0);														\
+		OUT_WriteString(OutDevice, ", overruns=");																		\
+		OUT_WriteNumber(OutDevice, Buffer->overruns, 0);																\
+		CIRC_BUFFER_WRITE_OLDEST_AGE(NAME, Buffer, OutDevice)															\
+		OUT_WriteString(OutDevice, "\r");																				\
+	}
 #else
-#define CIRCULARBUFFER_COUNTTYPE    uint16_t
+#define CIRC_BUFFER_STATISTICS_FIELD(SIZE)
+#define CIRC_BUFFER_UPDATE_STATISTICS(NAME, BUFFER, IN, INSERTED, DROPPED)	((void)(DROPPED))
+#define CIRC_BUFFER_RESET_STATISTICS(NAME, BUFFER)							((void)(BUFFER))
+#define CIRC_BUFFER_DECLARE_STATISTICS(NAME, SIZE)
+#define CIRC_BUFFER_DECLARE_STATISTICS_OUTPUT(NAME, SIZE)
 #endif
+
+/* Buffer generator ----------------------------------------------------------*/
+/*
+ * Generates NAME_TypeDef and the NAME_xxx functions for a buffer with SIZE
+ * items of TYPE. SIZE has to be a power of two, otherwise the compilation will
+ * fail on the NAME_SizeHasToBeAPowerOfTwo typedef. TYPE has to be a single
+ * type name that can be assigned, wrap arrays in a struct.
+ *
+ * in and out are free-running and only masked when the data array is
+ * accessed. in is only written by the producer and out is only written by the
+ * consumer, so no shared counter is needed. With
+ * CircularBufferPolicy_OverwriteOldest the producer can also move out, which
+ * is then done with compare-and-swap.
+ *
+ * Producer side:	NAME_Insert, NAME_InsertBlock, NAME_AcquireWrite, NAME_CommitWrite
+ * Consumer side:	NAME_Remove, NAME_RemoveItem, NAME_RemoveBlock, NAME_PeekBlock,
+ *					NAME_AcquireRead, NAME_ReleaseRead, NAME_StartPeeking, NAME_Peek,
+ *					NAME_PeekAt, NAME_Front, NAME_Skip, NAME_Drop
+ * Either side:		NAME_GetCount, NAME_IsEmpty, NAME_IsFull, NAME_GetOverruns
+ */
+#define CIRC_BUFFER_DECLARE(NAME, TYPE, SIZE)																			\
+	typedef char NAME##_SizeHasToBeAPowerOfTwo[((SIZE) > 0 && ((SIZE) & ((SIZE) - 1)) == 0) ? 1 : -1];					\
+																														\
+	/**																													\
+	 * @brief  Struct to handle a NAME buffer																			\
+	 */																													\
+	typedef struct																										\
+	{																													\
+		volatile uint32_t in;			/* Index where data should be written, only changed by the producer */			\
+		volatile uint32_t out;			/* Index where data should be read, only changed by the consumer */				\
+		uint32_t peekOut;				/* Index where data should be peeked at */										\
+		uint32_t readOut;				/* Index where the last region from NAME_AcquireRead started */					\
+		volatile uint32_t overruns;		/* Number of items overwritten because the buffer was full */					\
+		CircularBufferPolicy policy;	/* What to do when inserting into a full buffer */								\
+		uint8_t Initialized;			/* Set once init has been done on the buffer */									\
+		TYPE data[SIZE];				/* The actual buffer */															\
+		CIRC_BUFFER_STATISTICS_FIELD(SIZE)																				\
+	} NAME##_TypeDef;																									\
+																														\
+	CIRC_BUFFER_DECLARE_STATISTICS(NAME, SIZE)																			\
+																														\
+	/**																													\
+	 * @brief	Move the out index forward after data has been read														\
+	 * @param	Buffer: the buffer to update																			\
+	 * @param	Out: the out index the data was read at																	\
+	 * @param	Count: number of items that was read																	\
+	 * @retval	(1) if the items were consumed, (0) if the producer overwrote them										\
+	 *			while they were read and the read has to be done again													\
+	 */																													\
+	static inline uint8_t prv##NAME##_Consume(NAME##_TypeDef* Buffer, uint32_t Out, uint32_t Count)						\
+	{																													\
+		/* Make sure the data has been read before the slots are handed back to the producer */							\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+																														\
+		if (Buffer->policy == CircularBufferPolicy_OverwriteOldest)														\
+			return CIRC_BUFFER_CompareAndSwap(&Buffer->out, Out, Out + Count);											\
+																														\
+		Buffer->out = Out + Count;																						\
+		return 1;																										\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Make room for items by dropping the oldest items in the buffer											\
+	 * @param	Buffer: the buffer to make room in																		\
+	 * @param	In: the current in index																				\
+	 * @param	Count: number of items that should fit, at most SIZE													\
+	 * @retval	None																									\
+	 * @note	Only used by the producer with CircularBufferPolicy_OverwriteOldest										\
+	 */																													\
+	static inline void prv##NAME##_MakeRoom(NAME##_TypeDef* Buffer, uint32_t In, uint32_t Count)						\
+	{																													\
+		while (1)																										\
+		{																												\
+			uint32_t out = Buffer->out;																					\
+			uint32_t space = (SIZE) - (In - out);																		\
+			if (space >= Count)																							\
+				return;																									\
+																														\
+			if (CIRC_BUFFER_CompareAndSwap(&Buffer->out, out, out + (Count - space)))									\
+			{																											\
+				Buffer->overruns += Count - space;																		\
+				return;																									\
+			}																											\
+		}																												\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Copy data into the buffer storage starting at an index, in at most two segments							\
+	 *			or one item at a time for volatile items																\
+	 * @param	Buffer: the buffer to copy into																			\
+	 * @param	Index: the (unmasked) index to start at																	\
+	 * @param	Data: the data to copy																					\
+	 * @param	Count: number of items to copy, has to fit in the free space											\
+	 * @retval	None																									\
+	 */																													\
+	static inline void prv##NAME##_CopyIn(NAME##_TypeDef* Buffer, uint32_t Index, const TYPE* Data, uint32_t Count)		\
+	{																													\
+		uint32_t start = Index & ((SIZE) - 1);																			\
+		uint32_t firstCount = (SIZE) - start;																			\
+		if (firstCount > Count)																							\
+			firstCount = Count;																							\
+																														\
+		if (CIRCULARBUFFER_IS_VOLATILE(TYPE))																			\
+		{																												\
+			for (uint32_t i = 0; i < Count; i++)																		\
+				Buffer->data[(Index + i) & ((SIZE) - 1)] = Data[i];														\
+			return;																										\
+		}																												\
+																														\
+		memcpy((void*)&Buffer->data[start], (const void*)Data, firstCount * sizeof(TYPE));								\
+		memcpy((void*)&Buffer->data[0], (const void*)&Data[firstCount], (Count - firstCount) * sizeof(TYPE));			\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Copy data out of the buffer storage starting at an index, in at most two segments						\
+	 *			or one item at a time for volatile items																\
+	 * @param	Buffer: the buffer to copy from																			\
+	 * @param	Index: the (unmasked) index to start at																	\
+	 * @param	Data: where to store the data																			\
+	 * @param	Count: number of items to copy, has to be available in the buffer										\
+	 * @retval	None																									\
+	 */																													\
+	static inline void prv##NAME##_CopyOut(NAME##_TypeDef* Buffer, uint32_t Index, TYPE* Data, uint32_t Count)			\
+	{																													\
+		uint32_t start = Index & ((SIZE) - 1);																			\
+		uint32_t firstCount = (SIZE) - start;																			\
+		if (firstCount > Count)																							\
+			firstCount = Count;																							\
+																														\
+		if (CIRCULARBUFFER_IS_VOLATILE(TYPE))																			\
+		{																												\
+			for (uint32_t i = 0; i < Count; i++)																		\
+				Data[i] = Buffer->data[(Index + i) & ((SIZE) - 1)];														\
+			return;																										\
+		}																												\
+																														\
+		memcpy((void*)Data, (const void*)&Buffer->data[start], firstCount * sizeof(TYPE));								\
+		memcpy((void*)&Data[firstCount], (const void*)&Buffer->data[0], (Count - firstCount) * sizeof(TYPE));			\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Initializes the buffer with a specific policy for when it's full										\
+	 * @param	Buffer: the buffer that should be initialized. If the													\
+	 *			buffer already is initialized it will be reset															\
+	 * @param	Policy: what to do when inserting into a full buffer													\
+	 * @retval	None																									\
+	 */																													\
+	static inline void NAME##_InitWithPolicy(NAME##_TypeDef* Buffer, CircularBufferPolicy Policy)						\
+	{																													\
+		Buffer->in = 0;																									\
+		Buffer->out = 0;																								\
+		Buffer->peekOut = 0;																							\
+		Buffer->readOut = 0;																							\
+		Buffer->overruns = 0;																							\
+		Buffer->policy = Policy;																						\
+		Buffer->Initialized = 1;																						\
+		CIRC_BUFFER_RESET_STATISTICS(NAME, Buffer);																		\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Initializes the buffer, new items are dropped when it's full											\
+	 * @param	Buffer: the buffer that should be initialized. If the													\
+	 *			buffer already is initialized it will be reset															\
+	 * @retval	None																									\
+	 */																													\
+	static inline void NAME##_Init(NAME##_TypeDef* Buffer)																\
+	{																													\
+		NAME##_InitWithPolicy(Buffer, CircularBufferPolicy_DropNewest);													\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Insert an item in the front of the buffer																\
+	 * @param	Buffer: the buffer to insert into																		\
+	 * @param	Data: data to insert																					\
+	 * @retval	(1) if the item was inserted, (0) if the buffer was full and the item was dropped						\
+	 * @note	Should only be called from the producer side. With CircularBufferPolicy_OverwriteOldest					\
+	 *			the oldest item is dropped instead and the item is always inserted										\
+	 */																													\
+	static inline uint8_t NAME##_Insert(NAME##_TypeDef* Buffer, TYPE Data)												\
+	{																													\
+		uint32_t in = Buffer->in;																						\
+																														\
+		if (Buffer->policy == CircularBufferPolicy_OverwriteOldest)														\
+			prv##NAME##_MakeRoom(Buffer, in, 1);																		\
+		else if (in - Buffer->out == (SIZE))																			\
+		{																												\
+			CIRC_BUFFER_UPDATE_STATISTICS(NAME, Buffer, in, 0, 1);														\
+			return 0;																									\
+		}																												\
+																														\
+		Buffer->data[in & ((SIZE) - 1)] = Data;																			\
+		CIRC_BUFFER_STORE_TIMESTAMPS(Buffer, in, 1, SIZE)																\
+																														\
+		/* Publish the data to the consumer */																			\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		Buffer->in = in + 1;																							\
+		CIRC_BUFFER_UPDATE_STATISTICS(NAME, Buffer, in, 1, 0);															\
+																														\
+		return 1;																										\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Removes one item from the end of the buffer																\
+	 * @param	Buffer: buffer to remove from																			\
+	 * @param	Item: where to store the removed item																	\
+	 * @retval	(1) if an item was removed, (0) if the buffer was empty													\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline uint8_t NAME##_RemoveItem(NAME##_TypeDef* Buffer, TYPE* Item)											\
+	{																													\
+		uint32_t out;																									\
+																														\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			if (Buffer->in == out)																						\
+				return 0;																								\
+																														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+			*Item = Buffer->data[out & ((SIZE) - 1)];																	\
+		} while (!prv##NAME##_Consume(Buffer, out, 1));																	\
+																														\
+		return 1;																										\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Removes one item from the end of the buffer																\
+	 * @param	Buffer: buffer to remove from																			\
+	 * @retval	data removed from the end of the buffer, zero if the buffer was empty									\
+	 * @note	Should only be called from the consumer side. Use NAME_RemoveItem										\
+	 *			when zero is a valid item																				\
+	 */																													\
+	static inline TYPE NAME##_Remove(NAME##_TypeDef* Buffer)															\
+	{																													\
+		static TYPE empty;				/* Returned when the buffer is empty, zero as all statics */					\
+		TYPE data = empty;																								\
+		NAME##_RemoveItem(Buffer, &data);																				\
+		return data;																									\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Insert several items in the front of the buffer															\
+	 * @param	Buffer: the buffer to insert into																		\
+	 * @param	Data: the items to insert																				\
+	 * @param	Count: number of items in Data																			\
+	 * @retval	The number of items inserted, less than Count if the buffer got full									\
+	 * @note	Should only be called from the producer side. With CircularBufferPolicy_OverwriteOldest					\
+	 *			the oldest items are dropped to make room and all of Count is reported as								\
+	 *			inserted, even if only the last SIZE items could be kept												\
+	 */																													\
+	static inline uint32_t NAME##_InsertBlock(NAME##_TypeDef* Buffer, const TYPE* Data, uint32_t Count)					\
+	{																													\
+		uint32_t in = Buffer->in;																						\
+																														\
+		if (Buffer->policy == CircularBufferPolicy_OverwriteOldest)														\
+		{																												\
+			uint32_t inserted = Count;																					\
+			if (Count > (SIZE))																							\
+			{																											\
+				/* Only the newest items will fit */																	\
+				Buffer->overruns += Count - (SIZE);																		\
+				Data += Count - (SIZE);																					\
+				Count = (SIZE);																							\
+			}																											\
+			prv##NAME##_MakeRoom(Buffer, in, Count);																	\
+			prv##NAME##_CopyIn(Buffer, in, Data, Count);																\
+			CIRC_BUFFER_STORE_TIMESTAMPS(Buffer, in, Count, SIZE)														\
+																														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+			Buffer->in = in + Count;																					\
+			CIRC_BUFFER_UPDATE_STATISTICS(NAME, Buffer, in, Count, 0);													\
+																														\
+			return inserted;																							\
+		}																												\
+																														\
+		uint32_t space = (SIZE) - (in - Buffer->out);																	\
+		uint32_t dropped = 0;																							\
+		if (Count > space)																								\
+		{																												\
+			dropped = Count - space;																					\
+			Count = space;																								\
+		}																												\
+																														\
+		prv##NAME##_CopyIn(Buffer, in, Data, Count);																	\
+		CIRC_BUFFER_STORE_TIMESTAMPS(Buffer, in, Count, SIZE)															\
+																														\
+		/* Publish all of the data to the consumer at once */															\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		Buffer->in = in + Count;																						\
+		CIRC_BUFFER_UPDATE_STATISTICS(NAME, Buffer, in, Count, dropped);												\
+																														\
+		return Count;																									\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Removes several items from the end of the buffer														\
+	 * @param	Buffer: buffer to remove from																			\
+	 * @param	Data: where to store the removed items																	\
+	 * @param	Count: maximum number of items to remove																\
+	 * @retval	The number of items removed, less than Count if the buffer got empty									\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline uint32_t NAME##_RemoveBlock(NAME##_TypeDef* Buffer, TYPE* Data, uint32_t Count)						\
+	{																													\
+		uint32_t out, available;																						\
+																														\
+		/* Hand all of the slots back to the producer at once */														\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			available = Buffer->in - out;																				\
+			if (available > Count)																						\
+				available = Count;																						\
+																														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+			prv##NAME##_CopyOut(Buffer, out, Data, available);															\
+		} while (!prv##NAME##_Consume(Buffer, out, available));															\
+																														\
+		return available;																								\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Copies several items from the end of the buffer without removing them									\
+	 * @param	Buffer: buffer to peek at																				\
+	 * @param	Data: where to store the items																			\
+	 * @param	Count: maximum number of items to copy																	\
+	 * @retval	The number of items copied, less than Count if not that many was available								\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline uint32_t NAME##_PeekBlock(NAME##_TypeDef* Buffer, TYPE* Data, uint32_t Count)							\
+	{																													\
+		uint32_t out, available;																						\
+																														\
+		/* If out moved during the copy the producer has overwritten some of the data */								\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			available = Buffer->in - out;																				\
+			if (available > Count)																						\
+				available = Count;																						\
+																														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+			prv##NAME##_CopyOut(Buffer, out, Data, available);															\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+		} while (Buffer->out != out);																					\
+																														\
+		return available;																								\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get the largest contiguous free region in the buffer so it can be written								\
+	 *			to directly, e.g. by a DMA channel																		\
+	 * @param	Buffer: the buffer to write to																			\
+	 * @param	Data: will be set to point at the start of the free region												\
+	 * @param	MaxCount: the maximum number of items that are wanted													\
+	 * @retval	The number of items that can be written at Data, 0 if the buffer is full								\
+	 * @note	Should only be called from the producer side. The data is not visible									\
+	 *			to the consumer until NAME_CommitWrite() is called. Only free space										\
+	 *			is handed out, also with CircularBufferPolicy_OverwriteOldest											\
+	 */																													\
+	static inline uint32_t NAME##_AcquireWrite(NAME##_TypeDef* Buffer, TYPE** Data, uint32_t MaxCount)					\
+	{																													\
+		uint32_t in = Buffer->in;																						\
+		uint32_t space = (SIZE) - (in - Buffer->out);																	\
+		uint32_t contiguous = (SIZE) - (in & ((SIZE) - 1));																\
+																														\
+		if (space > contiguous)																							\
+			space = contiguous;																							\
+		if (space > MaxCount)																							\
+			space = MaxCount;																							\
+																														\
+		*Data = &Buffer->data[in & ((SIZE) - 1)];																		\
+		return space;																									\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Publish items written to a region from NAME_AcquireWrite()												\
+	 * @param	Buffer: the buffer that was written to																	\
+	 * @param	Count: the number of items written, can not be more than what was acquired								\
+	 * @retval	None																									\
+	 * @note	Should only be called from the producer side															\
+	 */																													\
+	static inline void NAME##_CommitWrite(NAME##_TypeDef* Buffer, uint32_t Count)										\
+	{																													\
+		uint32_t in = Buffer->in;																						\
+		CIRC_BUFFER_STORE_TIMESTAMPS(Buffer, in, Count, SIZE)															\
+																														\
+		/* Make sure the data written to the region is visible before it's published */									\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		Buffer->in = in + Count;																						\
+		CIRC_BUFFER_UPDATE_STATISTICS(NAME, Buffer, in, Count, 0);														\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get the largest contiguous region of data in the buffer so it can be read								\
+	 *			directly, e.g. by a DMA channel																			\
+	 * @param	Buffer: the buffer to read from																			\
+	 * @param	Data: will be set to point at the start of the data														\
+	 * @param	MaxCount: the maximum number of items that are wanted													\
+	 * @retval	The number of items that can be read at Data, 0 if the buffer is empty									\
+	 * @note	Should only be called from the consumer side. The region is not given									\
+	 *			back to the producer until NAME_ReleaseRead() is called. With											\
+	 *			CircularBufferPolicy_OverwriteOldest the producer can still overwrite the								\
+	 *			region, which can be detected with NAME_GetOverruns()													\
+	 */																													\
+	static inline uint32_t NAME##_AcquireRead(NAME##_TypeDef* Buffer, TYPE** Data, uint32_t MaxCount)					\
+	{																													\
+		uint32_t out = Buffer->out;																						\
+		uint32_t available = Buffer->in - out;																			\
+		uint32_t contiguous = (SIZE) - (out & ((SIZE) - 1));															\
+																														\
+		if (available > contiguous)																						\
+			available = contiguous;																						\
+		if (available > MaxCount)																						\
+			available = MaxCount;																						\
+																														\
+		/* Make sure the data is read after the in index */																\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		*Data = &Buffer->data[out & ((SIZE) - 1)];																		\
+		Buffer->readOut = out;																							\
+		return available;																								\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Give back items read from a region from NAME_AcquireRead()												\
+	 * @param	Buffer: the buffer that was read from																	\
+	 * @param	Count: the number of items read, can not be more than what was acquired									\
+	 * @retval	None																									\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline void NAME##_ReleaseRead(NAME##_TypeDef* Buffer, uint32_t Count)										\
+	{																													\
+		uint32_t target = Buffer->readOut + Count;																		\
+		uint32_t out;																									\
+																														\
+		/* Don't move out backwards if the producer already dropped the region */										\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			if ((int32_t)(target - out) <= 0)																			\
+				return;																									\
+		} while (!prv##NAME##_Consume(Buffer, out, target - out));														\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Start peeking at the buffer																				\
+	 * @param	Buffer: buffer to peek at																				\
+	 * @retval	None																									\
+	 */																													\
+	static inline void NAME##_StartPeeking(NAME##_TypeDef* Buffer)														\
+	{																													\
+		Buffer->peekOut = Buffer->out;																					\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Peeks at the item at the end of the buffer																\
+	 * @param	Buffer: buffer to peek at																				\
+	 * @retval	data at the end of the buffer																			\
+	 */																													\
+	static inline TYPE NAME##_Peek(NAME##_TypeDef* Buffer)																\
+	{																													\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		TYPE data = Buffer->data[Buffer->peekOut & ((SIZE) - 1)];														\
+		Buffer->peekOut++;																								\
+																														\
+		return data;																									\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get an item at an offset from the end of the buffer without removing it									\
+	 * @param	Buffer: buffer to peek at																				\
+	 * @param	Offset: offset from the oldest item, 0 is the oldest item												\
+	 * @param	Item: where to store the item																			\
+	 * @retval	(1) if there was an item at the offset, (0) otherwise													\
+	 * @note	Should only be called from the consumer side. Unlike NAME_Peek()										\
+	 *			no state in the buffer is changed, so it can be used from several places								\
+	 */																													\
+	static inline uint8_t NAME##_PeekAt(NAME##_TypeDef* Buffer, uint32_t Offset, TYPE* Item)							\
+	{																													\
+		uint32_t out;																									\
+																														\
+		/* If out moved during the read the producer has overwritten the item */										\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			if (Buffer->in - out <= Offset)																				\
+				return 0;																								\
+																														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+			*Item = Buffer->data[(out + Offset) & ((SIZE) - 1)];														\
+			CIRCULARBUFFER_MEMORY_BARRIER();																			\
+		} while (Buffer->out != out);																					\
+																														\
+		return 1;																										\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get the oldest item in the buffer without copying it													\
+	 * @param	Buffer: buffer to look in																				\
+	 * @retval	Pointer to the oldest item, 0 if the buffer was empty													\
+	 * @note	Should only be called from the consumer side. With														\
+	 *			CircularBufferPolicy_OverwriteOldest check NAME_GetOverruns() before									\
+	 *			trusting the item																						\
+	 */																													\
+	static inline TYPE* NAME##_Front(NAME##_TypeDef* Buffer)															\
+	{																													\
+		uint32_t out = Buffer->out;																						\
+		if (Buffer->in == out)																							\
+			return 0;																									\
+																														\
+		CIRCULARBUFFER_MEMORY_BARRIER();																				\
+		return &Buffer->data[out & ((SIZE) - 1)];																		\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Remove items from the end of the buffer without reading them											\
+	 * @param	Buffer: buffer to remove from																			\
+	 * @param	Count: maximum number of items to remove																\
+	 * @retval	The number of items removed, less than Count if the buffer got empty									\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline uint32_t NAME##_Skip(NAME##_TypeDef* Buffer, uint32_t Count)											\
+	{																													\
+		uint32_t out, available;																						\
+																														\
+		do																												\
+		{																												\
+			out = Buffer->out;																							\
+			available = Buffer->in - out;																				\
+			if (available > Count)																						\
+				available = Count;																						\
+		} while (!prv##NAME##_Consume(Buffer, out, available));															\
+																														\
+		return available;																								\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Remove the oldest item, e.g. after it was read with NAME_Front()										\
+	 * @param	Buffer: buffer to remove from																			\
+	 * @retval	None																									\
+	 * @note	Should only be called from the consumer side															\
+	 */																													\
+	static inline void NAME##_Drop(NAME##_TypeDef* Buffer)																\
+	{																													\
+		NAME##_Skip(Buffer, 1);																							\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get the current count for the buffer																	\
+	 * @param	Buffer: the buffer to get the count for																	\
+	 * @retval	the count value																							\
+	 */																													\
+	static inline uint32_t NAME##_GetCount(NAME##_TypeDef* Buffer)														\
+	{																													\
+		/* Read out first so a concurrent insert can only make the count larger, never invalid */						\
+		uint32_t out = Buffer->out;																						\
+		uint32_t in = Buffer->in;																						\
+		uint32_t count = in - out;																						\
+																														\
+		/* The producer might have dropped items after out was read */													\
+		if (count > (SIZE))																								\
+			count = (SIZE);																								\
+																														\
+		return count;																									\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Check if the buffer is empty																			\
+	 * @param	Buffer: the buffer to check																				\
+	 * @retval	(1) if it was empty, (0) otherwise																		\
+	 */																													\
+	static inline uint8_t NAME##_IsEmpty(NAME##_TypeDef* Buffer)														\
+	{																													\
+		return (NAME##_GetCount(Buffer) == 0);																			\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Check if the buffer is full																				\
+	 * @param	Buffer: the buffer to check																				\
+	 * @retval	(1) if it was full, (0) otherwise																		\
+	 */																													\
+	static inline uint8_t NAME##_IsFull(NAME##_TypeDef* Buffer)															\
+	{																													\
+		return (NAME##_GetCount(Buffer) == (SIZE));																		\
+	}																													\
+																														\
+	/**																													\
+	 * @brief	Get the number of items that have been lost because the buffer was full									\
+	 * @param	Buffer: the buffer to check																				\
+	 * @retval	The number of overwritten items with CircularBufferPolicy_OverwriteOldest								\
+	 * @note	Consumers can compare two readings to detect a gap in the data											\
+	 */																													\
+	static inline uint32_t NAME##_GetOverruns(NAME##_TypeDef* Buffer)													\
+	{																													\
+		return Buffer->overruns;																						\
+	}																													\
+																														\
+	CIRC_BUFFER_DECLARE_STATISTICS_OUTPUT(NAME, SIZE)
+
 /* Typedefs ------------------------------------------------------------------*/
+/* The buffer used by the drivers, sized with CIRCULARBUFFER_SIZE and CIRCULARBUFFER_DATATYPE */
+CIRC_BUFFER_DECLARE(CIRC_BUFFER, CIRCULARBUFFER_DATATYPE, CIRCULARBUFFER_SIZE)
+
+typedef CIRC_BUFFER_TypeDef CircularBuffer_TypeDef;
+
+/* Functions -----------------------------------------------------------------*/
 /**
- * @brief  Struct to handle a circular buffer
+ * @brief	Search for an item in the buffer without removing anything
+ * @param	CircularBuffer: buffer to search in
+ * @param	Value: the value to search for, e.g. a line or frame terminator
+ * @param	Index: will be set to the offset of the first match from the oldest item
+ * @retval	(1) if the value was found, (0) otherwise
+ * @note	Should only be called from the consumer side. Byte buffers are scanned
+ *			with memchr, one segment at a time, unless the bytes are volatile
  */
-typedef struct
+static inline uint8_t CIRC_BUFFER_FindByte(CircularBuffer_TypeDef* CircularBuffer, CIRCULARBUFFER_DATATYPE Value, uint32_t* Index)
 {
-	CIRCULARBUFFER_DATATYPE *in;							/** Pointer that points at the head where 
-																data should be written */
-	CIRCULARBUFFER_DATATYPE *out;							/** Pointer that points at the tail where 
-																data should be read */
-	CIRCULARBUFFER_DATATYPE data[CIRCULARBUFFER_SIZE];		/** The actual buffer */
-	CIRCULARBUFFER_COUNTTYPE count;							/** A counter for how much data there is
-																in the buffer */
-	Boolean Initialized;									/** Variable that is set once init has been
-																done on the buffer */
-} CircularBuffer_TypeDef;
-
-/* Function prototypes -------------------------------------------------------*/
-void circularBuffer_Init(CircularBuffer_TypeDef* CircularBuffer);
-void circularBuffer_Insert(CircularBuffer_TypeDef* CircularBuffer, CIRCULARBUFFER_DATATYPE Data);
-CIRCULARBUFFER_DATATYPE circularBuffer_Remove(CircularBuffer_TypeDef* CircularBuffer);
-CIRCULARBUFFER_COUNTTYPE circularBuffer_GetCount(CircularBuffer_TypeDef* CircularBuffer);
-uint8_t circularBuffer_IsEmpty(CircularBuffer_TypeDef* CircularBuffer);
-uint8_t circularBuffer_IsFull(CircularBuffer_TypeDef* CircularBuffer);
+	uint32_t out, available;
+	uint8_t found;
+
+	/* If out moved during the search the index is no longer valid */
+	do
+	{
+		out = CircularBuffer->out;
+		available = CircularBuffer->in - out;
+		found = 0;
+
+		CIRCULARBUFFER_MEMORY_BARRIER();
+		if (sizeof(CIRCULARBUFFER_DATATYPE) == 1 && !CIRCULARBUFFER_IS_VOLATILE(CIRCULARBUFFER_DATATYPE))
+		{
+			uint32_t start = out & CIRCULARBUFFER_MASK;
+			uint32_t firstCount = CIRCULARBUFFER_SIZE - start;
+			if (firstCount > available)
+				firstCount = available;
+
+			const uint8_t* first = (const uint8_t*)&CircularBuffer->data[start];
+			const uint8_t* match = (const uint8_t*)memchr(first, (uint8_t)Value, firstCount);
+			if (match != 0)
+			{
+				*Index = (uint32_t)(match - first);
+				found = 1;
+			}
+			else
+			{
+				const uint8_t* second = (const uint8_t*)&CircularBuffer->data[0];
+				match = (const uint8_t*)memchr(second, (uint8_t)Value, available - firstCount);
+				if (match != 0)
+				{
+					*Index = firstCount + (uint32_t)(match - second);
+					found = 1;
+				}
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < available; i++)
+			{
+				if (CircularBuffer->data[(out + i) & CIRCULARBUFFER_MASK] == Value)
+				{
+					*Index = i;
+					found = 1;
+					break;
+				}
+			}
+		}
+		CIRCULARBUFFER_MEMORY_BARRIER();
+	} while (CircularBuffer->out != out);
+
+	return found;
+}
 
 #endif /* CIRCULARBUFFER_H_ */
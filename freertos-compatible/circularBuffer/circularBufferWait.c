@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ * @file	circularBufferWait.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Contains the function implementations for waiting on a circular
+ *			buffer. The producer should call CIRC_BUFFER_NotifyConsumer... after
+ *			inserting and the consumer CIRC_BUFFER_NotifyProducer... after removing
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "circularBufferWait.h"
+
+/* Private defines -----------------------------------------------------------*/
+#if defined(CIRCULARBUFFER_NOTIFY_INDEX)
+#define NOTIFY_TAKE(TIMEOUT)					ulTaskNotifyTakeIndexed(CIRCULARBUFFER_NOTIFY_INDEX, pdTRUE, (TIMEOUT))
+#define NOTIFY_GIVE(TASK)						xTaskNotifyGiveIndexed((TASK), CIRCULARBUFFER_NOTIFY_INDEX)
+#define NOTIFY_GIVE_FROM_ISR(TASK, WOKEN)		vTaskNotifyGiveIndexedFromISR((TASK), CIRCULARBUFFER_NOTIFY_INDEX, (WOKEN))
+#else
+#define NOTIFY_TAKE(TIMEOUT)					ulTaskNotifyTake(pdTRUE, (TIMEOUT))
+#define NOTIFY_GIVE(TASK)						xTaskNotifyGive(TASK)
+#define NOTIFY_GIVE_FROM_ISR(TASK, WOKEN)		vTaskNotifyGiveFromISR((TASK), (WOKEN))
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Get the amount of data in a buffer
+ * @param	CircularBuffer: the buffer to check
+ * @retval	The number of items in the buffer
+ */
+static uint32_t prvGetCount(CircularBuffer_TypeDef* CircularBuffer)
+{
+	return CIRC_BUFFER_GetCount(CircularBuffer);
+}
+
+/**
+ * @brief	Get the free space in a buffer
+ * @param	CircularBuffer: the buffer to check
+ * @retval	The number of items that can be inserted
+ */
+static uint32_t prvGetSpace(CircularBuffer_TypeDef* CircularBuffer)
+{
+	return CIRCULARBUFFER_SIZE - CIRC_BUFFER_GetCount(CircularBuffer);
+}
+
+/**
+ * @brief	Block the calling task until a condition on the buffer is met
+ * @param	Wait: the wait struct to use
+ * @param	GetAmount: function that gets the current amount of data or space
+ * @param	Task: where the task waiting is published
+ * @param	Threshold: where the amount waited for is published
+ * @param	Count: the amount to wait for
+ * @param	Timeout: maximum time to wait in ticks
+ * @retval	SUCCESS: if the amount was available within the timeout
+ * @retval	ERROR: if the timeout expired
+ */
+static ErrorStatus prvWait(CircularBufferWait_TypeDef* Wait, uint32_t (*GetAmount)(CircularBuffer_TypeDef*),
+						   volatile TaskHandle_t* Task, volatile uint32_t* Threshold, uint32_t Count, TickType_t Timeout)
+{
+	TimeOut_t xTimeOut;
+	vTaskSetTimeOutState(&xTimeOut);
+
+	if (GetAmount(Wait->buffer) >= Count)
+		return SUCCESS;
+
+	ErrorStatus status;
+	while (1)
+	{
+		/* Publish the threshold and the task, then check again so a notification can't be missed */
+		*Threshold = Count;
+		__DMB();
+		*Task = xTaskGetCurrentTaskHandle();
+		__DMB();
+
+		if (GetAmount(Wait->buffer) < Count)
+		{
+			if (xTaskCheckForTimeOut(&xTimeOut, &Timeout) == pdTRUE)
+			{
+				status = ERROR;
+				break;
+			}
+			NOTIFY_TAKE(Timeout);
+		}
+
+		*Task = NULL;
+		if (GetAmount(Wait->buffer) >= Count)
+		{
+			status = SUCCESS;
+			break;
+		}
+	}
+
+	/*
+	 * A notifier that read the task before it was cleared can still give, drop a
+	 * notification that already came so it doesn't wake the task's next wait
+	 */
+	*Task = NULL;
+	__DMB();
+	NOTIFY_TAKE(0);
+	return status;
+}
+
+/**
+ * @brief	Wake the waiting task if its threshold has been reached
+ * @param	Wait: the wait struct to use
+ * @param	GetAmount: function that gets the current amount of data or space
+ * @param	Task: the task waiting
+ * @param	Threshold: the amount the task is waiting for
+ * @retval	The task to notify, NULL if no task should be notified
+ */
+static TaskHandle_t prvTaskToNotify(CircularBufferWait_TypeDef* Wait, uint32_t (*GetAmount)(CircularBuffer_TypeDef*),
+									volatile TaskHandle_t* Task, volatile uint32_t* Threshold)
+{
+	__DMB();
+	TaskHandle_t task = *Task;
+	if (task != NULL && GetAmount(Wait->buffer) >= *Threshold)
+	{
+		*Task = NULL;
+		return task;
+	}
+	return NULL;
+}
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Initializes the wait struct for a buffer
+ * @param	Wait: the wait struct to initialize
+ * @param	CircularBuffer: the buffer to wait on, it's not initialized here
+ * @retval	None
+ */
+void CIRC_BUFFER_WAIT_Init(CircularBufferWait_TypeDef* Wait, CircularBuffer_TypeDef* CircularBuffer)
+{
+	Wait->buffer = CircularBuffer;
+	Wait->xConsumerTask = NULL;
+	Wait->consumerThreshold = 0;
+	Wait->xProducerTask = NULL;
+	Wait->producerThreshold = 0;
+}
+
+/**
+ * @brief	Block the calling task until at least Count items are in the buffer
+ * @param	Wait: the wait struct to use
+ * @param	Count: the number of items to wait for, 1 to CIRCULARBUFFER_SIZE
+ * @param	Timeout: maximum time to wait in ticks
+ * @retval	SUCCESS: if the items are available
+ * @retval	ERROR: if the timeout expired
+ * @note	Should only be called from the consumer task
+ */
+ErrorStatus CIRC_BUFFER_WaitForCount(CircularBufferWait_TypeDef* Wait, uint32_t Count, TickType_t Timeout)
+{
+	return prvWait(Wait, prvGetCount, &Wait->xConsumerTask, &Wait->consumerThreshold, Count, Timeout);
+}
+
+/**
+ * @brief	Block the calling task until there is space for at least Count items in the buffer
+ * @param	Wait: the wait struct to use
+ * @param	Count: the number of items to wait for space for, 1 to CIRCULARBUFFER_SIZE
+ * @param	Timeout: maximum time to wait in ticks
+ * @retval	SUCCESS: if the space is available
+ * @retval	ERROR: if the timeout expired
+ * @note	Should only be called from the producer task
+ */
+ErrorStatus CIRC_BUFFER_WaitForSpace(CircularBufferWait_TypeDef* Wait, uint32_t Count, TickType_t Timeout)
+{
+	return prvWait(Wait, prvGetSpace, &Wait->xProducerTask, &Wait->producerThreshold, Count, Timeout);
+}
+
+/**
+ * @brief	Wake the consumer if enough data is available, call after inserting
+ * @param	Wait: the wait struct to use
+ * @retval	None
+ */
+void CIRC_BUFFER_NotifyConsumer(CircularBufferWait_TypeDef* Wait)
+{
+	TaskHandle_t task = prvTaskToNotify(Wait, prvGetCount, &Wait->xConsumerTask, &Wait->consumerThreshold);
+	if (task != NULL)
+		NOTIFY_GIVE(task);
+}
+
+/**
+ * @brief	Wake the consumer if enough data is available, call after inserting from an ISR
+ * @param	Wait: the wait struct to use
+ * @param	pxHigherPriorityTaskWoken: set to pdTRUE if a context switch should be requested, can be NULL
+ * @retval	None
+ */
+void CIRC_BUFFER_NotifyConsumerFromISR(CircularBufferWait_TypeDef* Wait, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	TaskHandle_t task = prvTaskToNotify(Wait, prvGetCount, &Wait->xConsumerTask, &Wait->consumerThreshold);
+	if (task != NULL)
+		NOTIFY_GIVE_FROM_ISR(task, pxHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief	Wake the producer if enough space is available, call after removing
+ * @param	Wait: the wait struct to use
+ * @retval	None
+ */
+void CIRC_BUFFER_NotifyProducer(CircularBufferWait_TypeDef* Wait)
+{
+	TaskHandle_t task = prvTaskToNotify(Wait, prvGetSpace, &Wait->xProducerTask, &Wait->producerThreshold);
+	if (task != NULL)
+		NOTIFY_GIVE(task);
+}
+
+/**
+ * @brief	Wake the producer if enough space is available, call after removing from an ISR
+ * @param	Wait: the wait struct to use
+ * @param	pxHigherPriorityTaskWoken: set to pdTRUE if a context switch should be requested, can be NULL
+ * @retval	None
+ */
+void CIRC_BUFFER_NotifyProducerFromISR(CircularBufferWait_TypeDef* Wait, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	TaskHandle_t task = prvTaskToNotify(Wait, prvGetSpace, &Wait->xProducerTask, &Wait->producerThreshold);
+	if (task != NULL)
+		NOTIFY_GIVE_FROM_ISR(task, pxHigherPriorityTaskWoken);
+}
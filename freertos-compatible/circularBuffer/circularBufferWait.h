@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @file	circularBufferWait.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Lets a task block on a circular buffer until a certain amount of
+ *			data or space is available. Uses direct to task notifications and
+ *			the waiting task is only woken when its threshold is reached
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CIRCULARBUFFERWAIT_H_
+#define CIRCULARBUFFERWAIT_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f10x.h"
+#include "circularBuffer/circularBuffer.h"
+
+/* Defines -------------------------------------------------------------------*/
+/*
+ * Define CIRCULARBUFFER_NOTIFY_INDEX to wait on a notification index of its own,
+ * which needs FreeRTOS 10.4 or later with configTASK_NOTIFICATION_ARRAY_ENTRIES
+ * above the index. Otherwise the default notification is used, so a task that
+ * waits on a buffer can't use it for anything else
+ */
+/* Typedefs ------------------------------------------------------------------*/
+/**
+ * @brief  Struct to handle waiting on a circular buffer
+ * @note	Only one task can wait for data and one task for space at a time,
+ * 			the same as the single consumer/single producer of the buffer
+ */
+typedef struct
+{
+	CircularBuffer_TypeDef* buffer;				/* The buffer to wait on */
+
+	volatile TaskHandle_t xConsumerTask;		/* Task waiting for data, NULL if no task is waiting */
+	volatile uint32_t consumerThreshold;		/* Amount of data the consumer is waiting for */
+
+	volatile TaskHandle_t xProducerTask;		/* Task waiting for space, NULL if no task is waiting */
+	volatile uint32_t producerThreshold;		/* Amount of space the producer is waiting for */
+} CircularBufferWait_TypeDef;
+
+/* Function prototypes -------------------------------------------------------*/
+void CIRC_BUFFER_WAIT_Init(CircularBufferWait_TypeDef* Wait, CircularBuffer_TypeDef* CircularBuffer);
+
+ErrorStatus CIRC_BUFFER_WaitForCount(CircularBufferWait_TypeDef* Wait, uint32_t Count, TickType_t Timeout);
+ErrorStatus CIRC_BUFFER_WaitForSpace(CircularBufferWait_TypeDef* Wait, uint32_t Count, TickType_t Timeout);
+
+void CIRC_BUFFER_NotifyConsumer(CircularBufferWait_TypeDef* Wait);
+void CIRC_BUFFER_NotifyConsumerFromISR(CircularBufferWait_TypeDef* Wait, BaseType_t* pxHigherPriorityTaskWoken);
+void CIRC_BUFFER_NotifyProducer(CircularBufferWait_TypeDef* Wait);
+void CIRC_BUFFER_NotifyProducerFromISR(CircularBufferWait_TypeDef* Wait, BaseType_t* pxHigherPriorityTaskWoken);
+
+#endif /* CIRCULARBUFFERWAIT_H_ */
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file	recordBuffer.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Contains the function implementations for the record buffer.
+ *			Has the same single producer/single consumer guarantees as the
+ *			circular buffer it's built on
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "recordBuffer.h"
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+/* Private typedefs ----------------------------------------------------------*/
+/* Fails to compile if the circular buffer can't store raw bytes */
+typedef char RecordBuffer_DataTypeHasToBeAByte[(sizeof(CIRCULARBUFFER_DATATYPE) == 1) ? 1 : -1];
+
+/* Private variables ---------------------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Initializes the record buffer
+ * @param	RecordBuffer: the buffer that should be initialized. If the
+ *			buffer already is initialized it will be reset
+ * @retval	None
+ */
+void RECORD_BUFFER_Init(RecordBuffer_TypeDef* RecordBuffer)
+{
+	/* Overwriting old data would break the record headers so new records are dropped */
+	CIRC_BUFFER_InitWithPolicy(&RecordBuffer->buffer, CircularBufferPolicy_DropNewest);
+}
+
+/**
+ * @brief	Add a record to the buffer
+ * @param	RecordBuffer: the buffer to add to
+ * @param	Data: the data in the record
+ * @param	Length: length of the record, 1 to RECORD_BUFFER_MAX_LENGTH
+ * @retval	(1) if the record was added, (0) if the length was invalid or it didn't fit
+ * @note	Should only be called from the producer side
+ */
+uint8_t RECORD_BUFFER_PushRecord(RecordBuffer_TypeDef* RecordBuffer, const uint8_t* Data, uint32_t Length)
+{
+	CircularBuffer_TypeDef* buffer = &RecordBuffer->buffer;
+	CIRCULARBUFFER_DATATYPE* region;
+
+	if (Length == 0 || Length > RECORD_BUFFER_MAX_LENGTH)
+		return 0;
+
+	uint32_t space = CIRCULARBUFFER_SIZE - CIRC_BUFFER_GetCount(buffer);
+	uint32_t contiguous = CIRC_BUFFER_AcquireWrite(buffer, &region, CIRCULARBUFFER_SIZE);
+
+	if (contiguous < Length + 1)
+	{
+		/*
+		 * The record doesn't fit before the end of the buffer. If it fits at the start
+		 * the rest of the end is padded, otherwise the buffer is too full for now
+		 */
+		uint32_t toEnd = CIRCULARBUFFER_SIZE - (buffer->in & CIRCULARBUFFER_MASK);
+		if (contiguous != toEnd || space < toEnd + Length + 1)
+			return 0;
+
+		region[0] = RECORD_BUFFER_PADDING;
+		CIRC_BUFFER_CommitWrite(buffer, toEnd);
+		CIRC_BUFFER_AcquireWrite(buffer, &region, CIRCULARBUFFER_SIZE);
+	}
+
+	region[0] = (uint8_t)Length;
+	if (CIRCULARBUFFER_IS_VOLATILE(CIRCULARBUFFER_DATATYPE))
+	{
+		for (uint32_t i = 0; i < Length; i++)
+			region[1 + i] = Data[i];
+	}
+	else
+		memcpy((void*)&region[1], Data, Length);
+	CIRC_BUFFER_CommitWrite(buffer, Length + 1);
+
+	return 1;
+}
+
+/**
+ * @brief	Get the oldest record in the buffer without copying it
+ * @param	RecordBuffer: the buffer to get the record from
+ * @param	Data: will be set to point at the data in the record
+ * @retval	The length of the record, 0 if the buffer is empty
+ * @note	Should only be called from the consumer side. The record stays in the
+ *			buffer until RECORD_BUFFER_ReleaseRecord() is called
+ */
+uint32_t RECORD_BUFFER_FrontRecord(RecordBuffer_TypeDef* RecordBuffer, uint8_t** Data)
+{
+	CircularBuffer_TypeDef* buffer = &RecordBuffer->buffer;
+	CIRCULARBUFFER_DATATYPE* region;
+
+	uint32_t available = CIRC_BUFFER_AcquireRead(buffer, &region, CIRCULARBUFFER_SIZE);
+	if (available == 0)
+		return 0;
+
+	if (region[0] == RECORD_BUFFER_PADDING)
+	{
+		/* The padding always reaches the end of the buffer and was committed at once */
+		CIRC_BUFFER_ReleaseRead(buffer, available);
+		available = CIRC_BUFFER_AcquireRead(buffer, &region, CIRCULARBUFFER_SIZE);
+		if (available == 0)
+			return 0;
+	}
+
+	*Data = (uint8_t*)&region[1];
+	return region[0];
+}
+
+/**
+ * @brief	Remove the oldest record after it has been read with RECORD_BUFFER_FrontRecord()
+ * @param	RecordBuffer: the buffer to remove the record from
+ * @retval	None
+ * @note	Should only be called from the consumer side
+ */
+void RECORD_BUFFER_ReleaseRecord(RecordBuffer_TypeDef* RecordBuffer)
+{
+	uint8_t* data;
+	uint32_t length = RECORD_BUFFER_FrontRecord(RecordBuffer, &data);
+
+	if (length != 0)
+		CIRC_BUFFER_ReleaseRead(&RecordBuffer->buffer, length + 1);
+}
+
+/**
+ * @brief	Copy the oldest record in the buffer and remove it
+ * @param	RecordBuffer: the buffer to get the record from
+ * @param	Buffer: where the data should be stored
+ * @param	BufferSize: size of Buffer, a longer record will be truncated
+ * @retval	The length of the record, 0 if the buffer is empty
+ * @note	Should only be called from the consumer side
+ */
+uint32_t RECORD_BUFFER_PopRecord(RecordBuffer_TypeDef* RecordBuffer, uint8_t* Buffer, uint32_t BufferSize)
+{
+	uint8_t* data;
+	uint32_t length = RECORD_BUFFER_FrontRecord(RecordBuffer, &data);
+
+	if (length != 0)
+	{
+		uint32_t count = (length < BufferSize) ? length : BufferSize;
+		if (CIRCULARBUFFER_IS_VOLATILE(CIRCULARBUFFER_DATATYPE))
+		{
+			const CIRCULARBUFFER_DATATYPE* record = (const CIRCULARBUFFER_DATATYPE*)data;
+			for (uint32_t i = 0; i < count; i++)
+				Buffer[i] = record[i];
+		}
+		else
+			memcpy(Buffer, data, count);
+		CIRC_BUFFER_ReleaseRead(&RecordBuffer->buffer, length + 1);
+	}
+
+	return length;
+}
+
+/**
+ * @brief	Check if the buffer is empty
+ * @param	RecordBuffer: the buffer to check
+ * @retval	(1) if there are no records, (0) otherwise
+ * @note	Doesn't change the buffer, padding is left for the consumer to release
+ */
+uint8_t RECORD_BUFFER_IsEmpty(RecordBuffer_TypeDef* RecordBuffer)
+{
+	CircularBuffer_TypeDef* buffer = &RecordBuffer->buffer;
+	uint32_t out = buffer->out;
+	uint32_t count = buffer->in - out;
+
+	if (count == 0)
+		return 1;
+
+	/* Make sure the header is read after the in index */
+	CIRCULARBUFFER_MEMORY_BARRIER();
+	if (buffer->data[out & CIRCULARBUFFER_MASK] != RECORD_BUFFER_PADDING)
+		return 0;
+
+	/* The padding always reaches the end of the buffer, anything after it is a record */
+	return (count == CIRCULARBUFFER_SIZE - (out & CIRCULARBUFFER_MASK));
+}
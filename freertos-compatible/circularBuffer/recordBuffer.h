@@ -0,0 +1,50 @@
+/**
+ ******************************************************************************
+ * @file	recordBuffer.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	A buffer for variable length records, e.g. radio packets, built on
+ *			the circular buffer. Every record is stored with a one byte length
+ *			header and is never split at the end of the buffer, so the oldest
+ *			record can always be read in place
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef RECORDBUFFER_H_
+#define RECORDBUFFER_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "circularBuffer/circularBuffer.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* The header byte value that marks unused space at the end of the buffer */
+#define RECORD_BUFFER_PADDING		(0xFF)
+
+/* A record and it's header can at most use half of the buffer to always fit after padding */
+#if ((CIRCULARBUFFER_SIZE / 2) - 1) < (RECORD_BUFFER_PADDING - 1)
+#define RECORD_BUFFER_MAX_LENGTH	((CIRCULARBUFFER_SIZE / 2) - 1)
+#else
+#define RECORD_BUFFER_MAX_LENGTH	(RECORD_BUFFER_PADDING - 1)
+#endif
+
+/* Typedefs ------------------------------------------------------------------*/
+/**
+ * @brief  Struct to handle a record buffer
+ * @note	CIRCULARBUFFER_DATATYPE has to be a byte type
+ */
+typedef struct
+{
+	CircularBuffer_TypeDef buffer;	/* The buffer the records and their headers are stored in */
+} RecordBuffer_TypeDef;
+
+/* Function prototypes -------------------------------------------------------*/
+void RECORD_BUFFER_Init(RecordBuffer_TypeDef* RecordBuffer);
+uint8_t RECORD_BUFFER_PushRecord(RecordBuffer_TypeDef* RecordBuffer, const uint8_t* Data, uint32_t Length);
+uint32_t RECORD_BUFFER_FrontRecord(RecordBuffer_TypeDef* RecordBuffer, uint8_t** Data);
+void RECORD_BUFFER_ReleaseRecord(RecordBuffer_TypeDef* RecordBuffer);
+uint32_t RECORD_BUFFER_PopRecord(RecordBuffer_TypeDef* RecordBuffer, uint8_t* Buffer, uint32_t BufferSize);
+uint8_t RECORD_BUFFER_IsEmpty(RecordBuffer_TypeDef* RecordBuffer);
+
+#endif /* RECORDBUFFER_H_ */
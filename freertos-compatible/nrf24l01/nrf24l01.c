@@ -15,10 +15,8 @@
 #include "nrf24l01.h"
 
 /* Private defines -----------------------------------------------------------*/
-#define CSN_LOW(DEVICE)				(Device->CSN_GPIO->BRR = Device->CSN_Pin)
-#define CSN_HIGH(DEVICE)			(Device->CSN_GPIO->BSRR = Device->CSN_Pin)
-#define SELECT_DEVICE(DEVICE)		(CSN_LOW(DEVICE))
-#define DESELECT_DEVICE(DEVICE)		(CSN_HIGH(DEVICE))
+#define SELECT_DEVICE(DEVICE)		(SPI_Select(&(DEVICE)->SPISlave, portMAX_DELAY))
+#define DESELECT_DEVICE(DEVICE)		(SPI_Deselect(&(DEVICE)->SPISlave))
 
 #define CE_LOW(DEVICE)				(Device->CE_GPIO->BRR = Device->CE_Pin)
 #define CE_HIGH(DEVICE)				(Device->CE_GPIO->BSRR = Device->CE_Pin)
@@ -29,9 +27,22 @@
 
 #define PIPE_FROM_STATUS(STATUS) 	(((STATUS) & 0xF) >> 1)
 
+#define IRQ_FLAGS					((1 << TX_DS) | (1 << MAX_RT) | (1 << RX_DR))
+
+#define MAX_DATA_COUNT_FOR(DEVICE)	((DEVICE)->DynamicPayloadLength ? MAX_DYNAMIC_DATA_COUNT : MAX_DATA_COUNT)
+
+/* Payloads with dynamic length have to be at least one byte */
+#define IS_VALID_DATA_COUNT(DEVICE, COUNT)	((COUNT) <= MAX_DATA_COUNT_FOR(DEVICE) && ((COUNT) != 0 || !(DEVICE)->DynamicPayloadLength))
+
 /* Private variables ---------------------------------------------------------*/
 /* Private Function Prototypes -----------------------------------------------*/
-
+static ErrorStatus prvEnableDynamicPayloadLength(NRF24L01_Device* Device);
+static void prvWriteStatus(NRF24L01_Device* Device, uint8_t Flags);
+static void prvWriteTxPayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount);
+static void prvTxStreamInterrupt(NRF24L01_Device* Device, uint8_t Status);
+static uint8_t prvGetStatus(NRF24L01_Device* Device, uint8_t* Streaming);
+static void prvHandleInterrupt(NRF24L01_Device* Device, uint8_t Status, uint8_t Streaming);
+static void prvInterruptTask(void* pvParameters);
 
 /* Functions -----------------------------------------------------------------*/
 /**
@@ -42,6 +53,10 @@
  */
 ErrorStatus NRF24L01_Init(NRF24L01_Device* Device)
 {
+	/* RF_CH is written with the rest of the configuration below, so check it before anything is set up */
+	if (Device->RfChannel > 125)
+		goto error;
+
 	/*
 	 * Create the binary semaphores:
 	 * The semaphore is created in the 'empty' state, meaning
@@ -50,6 +65,9 @@ ErrorStatus NRF24L01_Init(NRF24L01_Device* Device)
 	 */
 	Device->xTxSemaphore = xSemaphoreCreateBinary();
 	Device->xDataAvailableSemaphore = xSemaphoreCreateBinary();
+	Device->xTxFifoSemaphore = xSemaphoreCreateCounting(NRF24L01_TX_FIFO_SIZE, NRF24L01_TX_FIFO_SIZE);
+	Device->TxStreaming = 0;
+	Device->TxStreamDropped = 0;
 	xSemaphoreGive(Device->xTxSemaphore);
 	xSemaphoreGive(Device->xDataAvailableSemaphore);
 	/* Take the semaphore because no data is available yet */
@@ -58,9 +76,14 @@ ErrorStatus NRF24L01_Init(NRF24L01_Device* Device)
 	/* Initialize RX Buffers */
 	for (uint32_t i = 0; i < 6; i++)
 	{
-		CIRC_BUFFER_Init(&Device->RxPipeBuffer[i]);
+		CIRC_BUFFER_InitWithPolicy(&Device->RxPipeBuffer[i], Device->RxBufferPolicy);
+		CIRC_BUFFER_WAIT_Init(&Device->RxPipeWait[i], &Device->RxPipeBuffer[i]);
 	}
 
+	/* The interrupt task has to exist before the EXTI interrupt is enabled as NRF24L01_Interrupt notifies it */
+	if (xTaskCreate(prvInterruptTask, "nRF24L01", NRF24L01_INTERRUPT_TASK_STACK_SIZE, Device,
+					NRF24L01_INTERRUPT_TASK_PRIORITY, &Device->xInterruptTask) != pdPASS)
+		goto error;
 
 	/* Initialize GPIOs */
 	GPIO_InitTypeDef GPIO_InitStructure;
@@ -77,18 +100,6 @@ ErrorStatus NRF24L01_Init(NRF24L01_Device* Device)
 	GPIO_Init(Device->CE_GPIO, &GPIO_InitStructure);
 	DISABLE_DEVICE(Device);
 
-	/* Initialize CSN (Chip select) pin */
-	if (Device->CSN_GPIO == GPIOA)
-		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
-	else if (Device->CSN_GPIO == GPIOB)
-		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-
-	GPIO_InitStructure.GPIO_Mode 		= GPIO_Mode_Out_PP;
-	GPIO_InitStructure.GPIO_Pin 		= Device->CSN_Pin;
-	GPIO_InitStructure.GPIO_Speed 		= GPIO_Speed_50MHz;
-	GPIO_Init(Device->CSN_GPIO, &GPIO_InitStructure);
-	DESELECT_DEVICE(Device);
-
 	/* Initialize IRQ (Interrupt) pin */
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
 	if (Device->IRQ_GPIO == GPIOA)
@@ -134,43 +145,60 @@ ErrorStatus NRF24L01_Init(NRF24L01_Device* Device)
 	SPI_InitStructure.SPI_FirstBit 			= SPI_FirstBit_MSB;				/* See datasheet page 50 */
 	SPI_InitWithStructure(Device->SPIDevice, &SPI_InitStructure);
 
+	/* Initialize the nRF24L01 as a slave on the bus, which also sets up the CSN (Chip select) pin */
+	Device->SPISlave.SPIDevice 			= Device->SPIDevice;
+	Device->SPISlave.CS_GPIO 			= Device->CSN_GPIO;
+	Device->SPISlave.CS_Pin 			= Device->CSN_Pin;
+	Device->SPISlave.BaudRatePrescaler 	= SPI_BaudRatePrescaler_8;
+	Device->SPISlave.CPOL 				= SPI_CPOL_Low;
+	Device->SPISlave.CPHA 				= SPI_CPHA_1Edge;
+	Device->SPISlave.CS_HighTime 		= 50;		/* Tcwh, datasheet page 53 */
+	SPI_SlaveInit(&Device->SPISlave);
+
 	/* Wait 100ms for Power-On reset, see page 20 in datasheet */
 	vTaskDelay(100 / portTICK_PERIOD_MS);
 
-	/* Set RF Channel */
-	NRF24L01_SetRFChannel(Device, Device->RfChannel);
+	/*
+	 * Write the whole configuration in one bus session: RF channel, address
+	 * width, payload size for the pipes (same for all), enable all pipes and
+	 * set the TX address and the RX address for all pipes
+	 */
+	uint8_t payloadSize = PAYLOAD_SIZE;
+	uint8_t enabledPipes = 0x3F;
+	uint8_t addressWidth = Device->addressWidth;
+	const NRF24L01_RegisterWrite configuration[] = {
+		{RF_CH, 		&Device->RfChannel, 1},
+		{SETUP_AW, 		&addressWidth, 		1},
+		{RX_PW_P0, 		&payloadSize, 		1},
+		{RX_PW_P1, 		&payloadSize, 		1},
+		{RX_PW_P2, 		&payloadSize, 		1},
+		{RX_PW_P3, 		&payloadSize, 		1},
+		{RX_PW_P4, 		&payloadSize, 		1},
+		{RX_PW_P5, 		&payloadSize, 		1},
+		{EN_RXADDR, 	&enabledPipes, 		1},
+		{TX_ADDR, 		Device->TxAddress, 	5},
+		{RX_ADDR_P0, 	Device->RxAddress0, 5},
+		{RX_ADDR_P1, 	Device->RxAddress1, 5},
+		{RX_ADDR_P2, 	Device->RxAddress2, 1},
+		{RX_ADDR_P3, 	Device->RxAddress3, 1},
+		{RX_ADDR_P4, 	Device->RxAddress4, 1},
+		{RX_ADDR_P5, 	Device->RxAddress5, 1},
+	};
+	NRF24L01_WriteRegisters(Device, configuration, sizeof(configuration) / sizeof(configuration[0]));
 
 	/* Check that the RF channel was set */
 	if (NRF24L01_GetRFChannel(Device) != Device->RfChannel)
 		goto error;
 
-
-	/* Set payload size for the pipes, use same for all, and enable the pipes */
-	for (uint32_t pipe = 0; pipe < 6; pipe++)
-	{
-		NRF24L01_SetPayloadSizeForPipe(Device, 32, pipe);
-		NRF24L01_EnablePipe(Device, pipe);
-	}
-
-	/* Set the TX address */
-	NRF24L01_SetTxAddress(Device, Device->TxAddress);
-
-	/* Set RX address for all pipes */
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress0, 0);
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress1, 1);
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress2, 2);
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress3, 3);
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress4, 4);
-	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress5, 5);
+	/* RX_PW_Px is ignored for pipes with dynamic payload length */
+	if (Device->DynamicPayloadLength && prvEnableDynamicPayloadLength(Device) != SUCCESS)
+		goto error;
 
 	/* Flush the buffers to get rid of old data and reset the flags in the STATUS register */
 	NRF24L01_FlushTxBuffer(Device);
 	NRF24L01_FlushRxBuffer(Device);
 	NRF24L01_ResetAllFlags(Device);
 
-	/* Set the address width */
-	NRF24L01_SetAddressWidth(Device);
-
 	/* Power up the device i RX mode to start listening for packets */
 	NRF24L01_PowerUpInRxMode(Device);
 
@@ -189,8 +217,8 @@ error:
  */
 ErrorStatus NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount)
 {
-	/* You can only send the amount of data specified in MAX_DATA_COUNT */
-	if (DataCount > MAX_DATA_COUNT)
+	/* You can only send the amount of data specified in MAX_DATA_COUNT, MAX_DYNAMIC_DATA_COUNT with dynamic payload length */
+	if (!IS_VALID_DATA_COUNT(Device, DataCount))
 		return ERROR;
 
 	/* Try to take the semaphore */
@@ -200,22 +228,8 @@ ErrorStatus NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_
 		DISABLE_DEVICE(Device);				/* Disable the device while sending data to TX buffer */
 		NRF24L01_PowerUpInTxMode(Device);	/* Power up in TX mode */
 		NRF24L01_FlushTxBuffer(Device);		/* Flush the TX buffer */
+		prvWriteTxPayload(Device, Data, DataCount);
 
-		SELECT_DEVICE(Device);
-
-		SPI_WriteRead(Device->SPIDevice, W_TX_PAYLOAD);	/* We want to write the TX payload */
-		SPI_WriteRead(Device->SPIDevice, DataCount);	/* Write the data count */
-		uint32_t i;
-		for (i = 0; i < DataCount; i++)
-		{
-			SPI_WriteRead(Device->SPIDevice, Data[i]);	/* Write the data */
-		}
-		for (i++; i <= MAX_DATA_COUNT; i++)
-		{
-			SPI_WriteRead(Device->SPIDevice, PAYLOAD_FILLER_DATA);	/* Fill the rest of the payload with filler data */
-		}
-
-		DESELECT_DEVICE(Device);
 	    ENABLE_DEVICE(Device);
 
 	    return SUCCESS;
@@ -224,6 +238,95 @@ ErrorStatus NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_
 		return ERROR;
 }
 
+/**
+ * @brief	Starts streaming payloads, the device stays in TX mode until NRF24L01_StopTxStream
+ * @param	Device: The device to use
+ * @param	Timeout: Max number of ticks to wait for an ongoing transmission
+ * @retval	SUCCESS if streaming was started, ERROR otherwise
+ */
+ErrorStatus NRF24L01_StartTxStream(NRF24L01_Device* Device, TickType_t Timeout)
+{
+	if (xSemaphoreTake(Device->xTxSemaphore, Timeout) != pdTRUE)
+		return ERROR;
+
+	DISABLE_DEVICE(Device);
+	NRF24L01_PowerUpInTxMode(Device);
+	NRF24L01_FlushTxBuffer(Device);
+	DISABLE_DEVICE(Device);		/* Transmitting starts when the first payload is written */
+	Device->TxFifoWritten = 0;
+	Device->TxFifoFreed = 0;
+	Device->TxStreaming = 1;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Queues a payload in the TX FIFO while streaming
+ * @param	Device: The device to use
+ * @param	Data: Pointer to where the data is stored
+ * @param	DataCount: The number of bytes in Data
+ * @param	Timeout: Max number of ticks to wait for room in the TX FIFO
+ * @retval	SUCCESS if the payload was queued, ERROR otherwise
+ * @note	Up to NRF24L01_TX_FIFO_SIZE payloads are queued in the nRF24L01 and
+ *			CE stays high while there are payloads left, so they are sent back
+ *			to back without going through RX mode in between
+ */
+ErrorStatus NRF24L01_StreamPayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount, TickType_t Timeout)
+{
+	if (!Device->TxStreaming || !IS_VALID_DATA_COUNT(Device, DataCount))
+		return ERROR;
+
+	if (xSemaphoreTake(Device->xTxFifoSemaphore, Timeout) != pdTRUE)
+		return ERROR;
+
+	/* W_TX_PAYLOAD can be written while the FIFO is being sent */
+	prvWriteTxPayload(Device, Data, DataCount);
+	ENABLE_DEVICE(Device);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Waits for the queued payloads to be sent and goes back to RX mode
+ * @param	Device: The device to use
+ * @param	Timeout: Max number of ticks to wait for each queued payload
+ * @retval	SUCCESS if all payloads were sent, ERROR if it timed out and the rest was flushed
+ * @note	The FIFO is flushed and the flags are cleared before the stream ends
+ *			under the same bus hold, so a late TX_DS is either handled as part of
+ *			the stream or not seen at all. The counts taken here and the counts
+ *			of the flushed payloads are given back
+ */
+ErrorStatus NRF24L01_StopTxStream(NRF24L01_Device* Device, TickType_t Timeout)
+{
+	if (!Device->TxStreaming)
+		return ERROR;
+
+	/* All counts are back when the TX FIFO is empty */
+	uint32_t taken = 0;
+	while (taken < NRF24L01_TX_FIFO_SIZE && xSemaphoreTake(Device->xTxFifoSemaphore, Timeout) == pdTRUE)
+		taken++;
+
+	uint8_t flushTx = FLUSH_TX;
+	uint8_t clearFlags[2] = {W_REGISTER | STATUS, (1 << TX_DS) | (1 << MAX_RT)};
+	SELECT_DEVICE(Device);
+	SPI_Transfer(Device->SPIDevice, &flushTx, 0, sizeof(flushTx), portMAX_DELAY);
+	SPI_Reselect(&Device->SPISlave);
+	SPI_Transfer(Device->SPIDevice, clearFlags, 0, sizeof(clearFlags), portMAX_DELAY);
+	uint32_t flushed = Device->TxFifoWritten - Device->TxFifoFreed;
+	Device->TxFifoFreed = Device->TxFifoWritten;
+	Device->TxStreaming = 0;
+	DESELECT_DEVICE(Device);
+
+	NRF24L01_PowerUpInRxMode(Device);
+
+	/* Leave the semaphore full for the next stream */
+	for (uint32_t i = 0; i < taken + flushed; i++)
+		xSemaphoreGive(Device->xTxFifoSemaphore);
+
+	xSemaphoreGive(Device->xTxSemaphore);
+	return (taken == NRF24L01_TX_FIFO_SIZE) ? SUCCESS : ERROR;
+}
+
 /**
  * @brief
  * @param	Device: The device to use
@@ -232,7 +335,7 @@ ErrorStatus NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_
 void NRF24L01_ReadRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Buffer, uint8_t BufferSize)
 {
 	SELECT_DEVICE(Device);
-	uint8_t status = SPI_WriteRead(Device->SPIDevice, R_REGISTER | Register);
+	SPI_WriteRead(Device->SPIDevice, R_REGISTER | Register);
 
 	/* R_REGISTER command only have 5 data bytes, datasheet page 51 */
 	if (BufferSize > 5)
@@ -255,7 +358,7 @@ void NRF24L01_WriteRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t*
 {
 	DISABLE_DEVICE(Device);	 /* W_REGISTER is executable in power down or standby modes only */
 	SELECT_DEVICE(Device);
-	uint8_t status = SPI_WriteRead(Device->SPIDevice, W_REGISTER | Register);
+	SPI_WriteRead(Device->SPIDevice, W_REGISTER | Register);
 
 	/* W_REGISTER command only have 5 data bytes, datasheet page 51 */
 	if (BufferSize > 5)
@@ -265,7 +368,43 @@ void NRF24L01_WriteRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t*
 	for (int32_t i = BufferSize-1; i >= 0; i--)
 	{
 		/* Have to do WriteRead for some reason, otherwise one byte will be lost */
-		status = SPI_WriteRead(Device->SPIDevice, Buffer[i]);
+		SPI_WriteRead(Device->SPIDevice, Buffer[i]);
+	}
+	DESELECT_DEVICE(Device);
+	ENABLE_DEVICE(Device);
+}
+
+/**
+ * @brief	Writes several registers in one bus session
+ * @param	Device: The device to use
+ * @param	Writes: The registers to write, in order
+ * @param	WriteCount: The number of registers in Writes
+ * @retval	None
+ * @note	The bus is only taken once and CE is only toggled once. CSN still goes
+ *			high between the registers as every command starts at its falling edge
+ */
+void NRF24L01_WriteRegisters(NRF24L01_Device* Device, const NRF24L01_RegisterWrite* Writes, uint8_t WriteCount)
+{
+	DISABLE_DEVICE(Device);	 /* W_REGISTER is executable in power down or standby modes only */
+	SELECT_DEVICE(Device);
+	for (uint32_t i = 0; i < WriteCount; i++)
+	{
+		/* Start a new command for every register */
+		if (i != 0)
+			SPI_Reselect(&Device->SPISlave);
+
+		/* W_REGISTER command only have 5 data bytes, datasheet page 51 */
+		uint8_t size = Writes[i].Size;
+		if (size > 5)
+			size = 5;
+
+		/* LSByte first, datasheet page 50 */
+		uint8_t command[6];
+		command[0] = W_REGISTER | Writes[i].Register;
+		for (uint32_t j = 0; j < size; j++)
+			command[1 + j] = Writes[i].Value[size - 1 - j];
+
+		SPI_Transfer(Device->SPIDevice, command, 0, size + 1, portMAX_DELAY);
 	}
 	DESELECT_DEVICE(Device);
 	ENABLE_DEVICE(Device);
@@ -387,8 +526,7 @@ void NRF24L01_FlushRxBuffer(NRF24L01_Device* Device)
  */
 void NRF24L01_ResetAllFlags(NRF24L01_Device* Device)
 {
-	uint8_t data = (1 << TX_DS) | (1 << MAX_RT) | (1 << RX_DR);
-	NRF24L01_WriteRegister(Device, STATUS, &data, 1);
+	prvWriteStatus(Device, (1 << TX_DS) | (1 << MAX_RT) | (1 << RX_DR));
 }
 
 /**
@@ -398,8 +536,7 @@ void NRF24L01_ResetAllFlags(NRF24L01_Device* Device)
  */
 void NRF24L01_ResetDataReadyFlag(NRF24L01_Device* Device)
 {
-	uint8_t data = (1 << RX_DR);
-	NRF24L01_WriteRegister(Device, STATUS, &data, 1);
+	prvWriteStatus(Device, (1 << RX_DR));
 }
 
 /**
@@ -409,8 +546,7 @@ void NRF24L01_ResetDataReadyFlag(NRF24L01_Device* Device)
  */
 void NRF24L01_ResetTxFlags(NRF24L01_Device* Device)
 {
-	uint8_t data = (1 << TX_DS) | (1 << MAX_RT);
-	NRF24L01_WriteRegister(Device, STATUS, &data, 1);
+	prvWriteStatus(Device, (1 << TX_DS) | (1 << MAX_RT));
 }
 
 /**
@@ -467,11 +603,37 @@ uint8_t NRF24L01_GetStatus(NRF24L01_Device* Device)
 /**
  * @brief	Get data from the RX buffer
  * @param	Device: The device to use
- * @param	Storage: Pointer to where the data should be stored
+ * @param	Storage: Pointer to where the data should be stored, room for PAYLOAD_SIZE bytes
  * @retval	The amount of data received
  */
 uint8_t NRF24L01_GetDataFromRxBuffer(NRF24L01_Device* Device, uint8_t* Buffer)
 {
+	if (Device->DynamicPayloadLength)
+	{
+		SELECT_DEVICE(Device);
+		SPI_WriteRead(Device->SPIDevice, R_RX_PL_WID);
+		uint8_t width = SPI_WriteRead(Device->SPIDevice, NOP);
+		DESELECT_DEVICE(Device);
+
+		/*
+		 * The whole payload is data so it can be 1 to 32 bytes. A width larger than
+		 * PAYLOAD_SIZE means the payload is corrupt and it has to be flushed, see page 63
+		 * in the nRF24L01+ datasheet. Reading a payload removes it, the others stay
+		 */
+		if (width == 0 || width > PAYLOAD_SIZE)
+		{
+			NRF24L01_FlushRxBuffer(Device);
+			return 0;
+		}
+
+		SELECT_DEVICE(Device);
+		SPI_WriteRead(Device->SPIDevice, R_RX_PAYLOAD);
+		SPI_Transfer(Device->SPIDevice, 0, Buffer, width, portMAX_DELAY);
+		DESELECT_DEVICE(Device);
+
+		return width;
+	}
+
 	SELECT_DEVICE(Device);
 	SPI_WriteRead(Device->SPIDevice, R_RX_PAYLOAD);
 	uint8_t dataCount = SPI_WriteRead(Device->SPIDevice, NOP);
@@ -526,6 +688,26 @@ uint32_t NRF24L01_GetAvailableDataForAllPipes(NRF24L01_Device* Device)
 	return sum;
 }
 
+/**
+ * @brief	Block the calling task until a pipe has a certain amount of data
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe to wait for data on
+ * @param	DataCount: The amount of data to wait for, 1 to NRF24L01_MAX_AVAILABLE_DATA
+ * @param	Timeout: Maximum time to wait in ticks
+ * @retval	SUCCESS: If the data is available
+ * @retval	ERROR: If the timeout expired or the pipe is invalid
+ * @note	The task is only woken when DataCount is reached, only one task can
+ *			wait on each pipe at a time
+ */
+ErrorStatus NRF24L01_WaitForDataInPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t DataCount, TickType_t Timeout)
+{
+	if (Pipe < 6)
+	{
+		return CIRC_BUFFER_WaitForCount(&Device->RxPipeWait[Pipe], DataCount, Timeout);
+	}
+	return ERROR;
+}
+
 /**
  * @brief	Get data from a specified pipe
  * @param	Device: The device to use
@@ -540,10 +722,7 @@ void NRF24L01_GetDataFromPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* pB
 {
 	if (Pipe < 6)
 	{
-		for (uint32_t i = 0; i < BufferSize; i++)
-		{
-			pBuffer[i] = CIRC_BUFFER_Remove(&Device->RxPipeBuffer[Pipe]);
-		}
+		CIRC_BUFFER_RemoveBlock(&Device->RxPipeBuffer[Pipe], pBuffer, BufferSize);
 	}
 }
 
@@ -559,14 +738,23 @@ void NRF24L01_PeekAtDataInPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* p
 {
 	if (Pipe < 6)
 	{
-		/* Start peeking */
-		CIRC_BUFFER_StartPeeking(&Device->RxPipeBuffer[Pipe]);
+		CIRC_BUFFER_PeekBlock(&Device->RxPipeBuffer[Pipe], pBuffer, BufferSize);
+	}
+}
 
-		for (uint32_t i = 0; i < BufferSize; i++)
-		{
-			pBuffer[i] = CIRC_BUFFER_Peek(&Device->RxPipeBuffer[Pipe]);
-		}
+/**
+ * @brief	Get the number of bytes lost in a pipe because it's buffer was full
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe to check
+ * @retval	The number of overwritten bytes when RxBufferPolicy is CircularBufferPolicy_OverwriteOldest
+ */
+uint32_t NRF24L01_GetOverrunsForPipe(NRF24L01_Device* Device, uint8_t Pipe)
+{
+	if (Pipe < 6)
+	{
+		return CIRC_BUFFER_GetOverruns(&Device->RxPipeBuffer[Pipe]);
 	}
+	return 0;
 }
 
 /**
@@ -576,7 +764,274 @@ void NRF24L01_PeekAtDataInPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* p
  */
 void NRF24L01_SetAddressWidth(NRF24L01_Device* Device)
 {
-	NRF24L01_WriteRegister(Device, SETUP_AW, &Device->addressWidth, 1);
+	uint8_t addressWidth = (uint8_t)Device->addressWidth;
+	NRF24L01_WriteRegister(Device, SETUP_AW, &addressWidth, 1);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Enables dynamic payload length on all pipes
+ * @param	Device: The device to use
+ * @retval	SUCCESS if FEATURE could be written, ERROR otherwise
+ * @note	The nRF24L01 (non plus) ignores writes to FEATURE and DYNPD until
+ *			ACTIVATE has been sent, the nRF24L01+ doesn't need it
+ */
+static ErrorStatus prvEnableDynamicPayloadLength(NRF24L01_Device* Device)
+{
+	uint8_t feature = (1 << EN_DPL);
+	uint8_t readBack = 0;
+	NRF24L01_WriteRegister(Device, FEATURE, &feature, 1);
+	NRF24L01_ReadRegister(Device, FEATURE, &readBack, 1);
+	if (readBack != feature)
+	{
+		uint8_t activate[2] = {ACTIVATE, ACTIVATE_FEATURES};
+		DISABLE_DEVICE(Device);
+		SELECT_DEVICE(Device);
+		SPI_Transfer(Device->SPIDevice, activate, 0, sizeof(activate), portMAX_DELAY);
+		DESELECT_DEVICE(Device);
+		ENABLE_DEVICE(Device);
+
+		NRF24L01_WriteRegister(Device, FEATURE, &feature, 1);
+		NRF24L01_ReadRegister(Device, FEATURE, &readBack, 1);
+		if (readBack != feature)
+			return ERROR;
+	}
+
+	uint8_t dynamicPipes = (1 << DPL_P5) | (1 << DPL_P4) | (1 << DPL_P3) | (1 << DPL_P2) | (1 << DPL_P1) | (1 << DPL_P0);
+	NRF24L01_WriteRegister(Device, DYNPD, &dynamicPipes, 1);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Clears flags in the STATUS register
+ * @param	Device: The device to use
+ * @param	Flags: The flags to clear, a flag is cleared by writing 1 to it
+ * @retval	None
+ * @note	Unlike the other registers STATUS can be written in any mode, so CE is
+ *			left alone. Pulling it low would stop a TX stream in the middle
+ */
+static void prvWriteStatus(NRF24L01_Device* Device, uint8_t Flags)
+{
+	uint8_t command[2] = {W_REGISTER | STATUS, Flags};
+	SELECT_DEVICE(Device);
+	SPI_Transfer(Device->SPIDevice, command, 0, sizeof(command), portMAX_DELAY);
+	DESELECT_DEVICE(Device);
+}
+
+/**
+ * @brief	Writes a payload to the TX FIFO
+ * @param	Device: The device to use
+ * @param	Data: Pointer to where the data is stored
+ * @param	DataCount: The number of bytes in Data, at most MAX_DATA_COUNT or MAX_DYNAMIC_DATA_COUNT
+ * @retval	None
+ * @note	The command, the data count, the data and the filler data for the rest of
+ *			the payload are written straight from where they are as one transfer.
+ *			With DynamicPayloadLength only the command and the data are written
+ */
+static void prvWriteTxPayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount)
+{
+	uint8_t command = W_TX_PAYLOAD;
+	uint8_t header[2] = {W_TX_PAYLOAD, DataCount};
+	SPI_Segment segments[3] = {
+		{header, 0, sizeof(header), 0},
+		{Data, 0, DataCount, 0},
+		{0, 0, 0, PAYLOAD_FILLER_DATA},
+	};
+	uint8_t segmentCount = 3;
+
+	/* The receiver gets the data count from the payload width */
+	if (Device->DynamicPayloadLength)
+	{
+		segments[0].TxData = &command;
+		segments[0].Length = 1;
+		segmentCount = 2;
+	}
+	else
+		segments[2].Length = MAX_DATA_COUNT - DataCount;
+
+	SELECT_DEVICE(Device);
+	SPI_TransferSegments(Device->SPIDevice, segments, segmentCount, portMAX_DELAY);
+	/* Counted before the bus is released so the interrupt task never finds the payload in the FIFO without it */
+	Device->TxFifoWritten++;
+	DESELECT_DEVICE(Device);
+}
+
+/**
+ * @brief	Handles the TX interrupts while streaming
+ * @param	Device: The device to use
+ * @param	Status: The STATUS register
+ * @retval	None
+ * @note	The bus is held from before FIFO_STATUS is read until the counts are
+ *			given back. Payloads are written under the bus, so none can be written
+ *			in between and TxFifoWritten matches what is in the FIFO.
+ *			The flags are cleared before FIFO_STATUS is read, so a payload sent
+ *			after the read sets TX_DS again and brings the task back. FIFO_STATUS
+ *			only tells if the FIFO is empty or full, in between at most two
+ *			payloads are left. A count is given back for every written payload
+ *			that is known to have left the FIFO. After MAX_RT the FIFO is flushed
+ *			before the flags are cleared, as nothing is sent until then, and the
+ *			stream continues
+ */
+static void prvTxStreamInterrupt(NRF24L01_Device* Device, uint8_t Status)
+{
+	uint8_t clearFlags[2] = {W_REGISTER | STATUS, Status & ((1 << TX_DS) | (1 << MAX_RT))};
+	uint8_t readFifoStatus[2] = {R_REGISTER | FIFO_STATUS, NOP};
+	uint8_t fifoStatus[2] = {0, 0};
+	uint8_t flushTx = FLUSH_TX;
+	uint8_t maxRetransmits = Status & (1 << MAX_RT);
+
+	SELECT_DEVICE(Device);
+	/* NRF24L01_StopTxStream ended the stream while this task waited for the bus */
+	if (!Device->TxStreaming)
+	{
+		DESELECT_DEVICE(Device);
+		return;
+	}
+	uint32_t written = Device->TxFifoWritten;
+	if (!maxRetransmits)
+	{
+		SPI_Transfer(Device->SPIDevice, clearFlags, 0, sizeof(clearFlags), portMAX_DELAY);
+		SPI_Reselect(&Device->SPISlave);
+	}
+	SPI_Transfer(Device->SPIDevice, readFifoStatus, fifoStatus, sizeof(readFifoStatus), portMAX_DELAY);
+
+	uint32_t inFifo = written - Device->TxFifoFreed;
+	uint32_t left = NRF24L01_TX_FIFO_SIZE - 1;
+	if (fifoStatus[1] & (1 << TX_EMPTY))
+		left = 0;
+	else if (fifoStatus[1] & (1 << FIFO_FULL))
+		left = NRF24L01_TX_FIFO_SIZE;
+	if (left > inFifo)
+		left = inFifo;
+
+	if (maxRetransmits)
+	{
+		/* The payload that wasn't acknowledged holds up the rest, drop them all */
+		Device->TxStreamDropped += left;
+		left = 0;
+		SPI_Reselect(&Device->SPISlave);
+		SPI_Transfer(Device->SPIDevice, &flushTx, 0, sizeof(flushTx), portMAX_DELAY);
+		SPI_Reselect(&Device->SPISlave);
+		SPI_Transfer(Device->SPIDevice, clearFlags, 0, sizeof(clearFlags), portMAX_DELAY);
+	}
+
+	/* Nothing left to send, go to standby until the next payload is written */
+	if (left == 0)
+		DISABLE_DEVICE(Device);
+
+	while (written - Device->TxFifoFreed > left)
+	{
+		Device->TxFifoFreed++;
+		xSemaphoreGive(Device->xTxFifoSemaphore);
+	}
+	DESELECT_DEVICE(Device);
+}
+
+/**
+ * @brief	Reads the STATUS register and if a TX stream is going on
+ * @param	Device: The device to use
+ * @param	Streaming: Where to store TxStreaming
+ * @retval	The status register
+ * @note	Both are read under the same bus hold. NRF24L01_StopTxStream clears the
+ *			TX flags under the bus before it ends the stream, so TX flags read
+ *			together with Streaming == 0 never belong to a stream
+ */
+static uint8_t prvGetStatus(NRF24L01_Device* Device, uint8_t* Streaming)
+{
+	SELECT_DEVICE(Device);
+	uint8_t status = SPI_WriteRead(Device->SPIDevice, NOP);
+	*Streaming = Device->TxStreaming;
+	DESELECT_DEVICE(Device);
+
+	return status;
+}
+
+/**
+ * @brief	Handles the flags set in the STATUS register
+ * @param	Device: The device to use
+ * @param	Status: The STATUS register
+ * @param	Streaming: TxStreaming when the STATUS register was read
+ * @retval	None
+ * @note	Runs in the interrupt task as it needs the bus
+ */
+static void prvHandleInterrupt(NRF24L01_Device* Device, uint8_t Status, uint8_t Streaming)
+{
+	/* Payload sent or max retransmits while streaming, refill the TX FIFO */
+	if (Streaming && (Status & ((1 << TX_DS) | (1 << MAX_RT))))
+	{
+		prvTxStreamInterrupt(Device, Status);
+	}
+	/* Data Sent TX FIFO interrupt, asserted when packet transmitted on TX */
+	else if (Status & (1 << TX_DS))
+	{
+		NRF24L01_PowerUpInRxMode(Device);
+		NRF24L01_ResetTxFlags(Device);
+		/* Give the semaphore because we are done transmitting */
+		xSemaphoreGive(Device->xTxSemaphore);
+	}
+	/* Maximum number of TX retransmits interrupt */
+	else if (Status & (1 << MAX_RT))
+	{
+		NRF24L01_PowerUpInRxMode(Device);
+		NRF24L01_ResetTxFlags(Device);
+		/* Give the semaphore because we are done transmitting */
+		xSemaphoreGive(Device->xTxSemaphore);
+	}
+	/* Data Ready interrupt */
+	else if (Status & (1 << RX_DR))
+	{
+		/*
+		 * RX_DR is cleared first so a payload received while the FIFO is read sets it
+		 * again. The FIFO can hold more than one payload, read until RX_P_NO says it's empty
+		 */
+		NRF24L01_ResetDataReadyFlag(Device);
+		uint8_t pipe = PIPE_FROM_STATUS(Status);
+		while (pipe < 6)
+		{
+			uint8_t buffer[PAYLOAD_SIZE] = {};
+			uint8_t availableData = NRF24L01_GetDataFromRxBuffer(Device, buffer);
+			/* The data count byte without dynamic payload length isn't checked by NRF24L01_GetDataFromRxBuffer */
+			if (availableData > MAX_DATA_COUNT_FOR(Device))
+				availableData = MAX_DATA_COUNT_FOR(Device);
+
+			/* The buffer is lock-free for this task as producer, what happens when it's full depends on RxBufferPolicy */
+			CIRC_BUFFER_InsertBlock(&Device->RxPipeBuffer[pipe], buffer, availableData);
+			/* Wake a task waiting on this pipe if it has enough data now */
+			CIRC_BUFFER_NotifyConsumer(&Device->RxPipeWait[pipe]);
+			/* Give the xDataAvailableSemaphore to indicate there is new data available */
+			xSemaphoreGive(Device->xDataAvailableSemaphore);
+
+			pipe = PIPE_FROM_STATUS(NRF24L01_GetStatus(Device));
+		}
+	}
+}
+
+/**
+ * @brief	Task handling the IRQ pin
+ * @param	pvParameters: The device to use
+ * @retval	None
+ * @note	Handling the interrupt needs the SPI bus. The bus is a binary semaphore,
+ *			not a mutex: queued transactions keep it and their DMA interrupt gives
+ *			it back, and an ISR can't wait for it. The IRQ pin stays low while any
+ *			flag is set and the EXTI line only triggers on the falling edge, so
+ *			the flags are handled until they are all cleared
+ */
+static void prvInterruptTask(void* pvParameters)
+{
+	NRF24L01_Device* Device = (NRF24L01_Device*)pvParameters;
+
+	while (1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		uint8_t streaming;
+		uint8_t status = prvGetStatus(Device, &streaming);
+		while (status & IRQ_FLAGS)
+		{
+			prvHandleInterrupt(Device, status, streaming);
+			status = prvGetStatus(Device, &streaming);
+		}
+	}
 }
 
 /* Debug Print ---------------------------------------------------------------*/
@@ -700,42 +1155,15 @@ void NRF24L01_PrintDebugInfo(NRF24L01_Device* Device)
 #endif
 
 /* Interrupt Service Routines ------------------------------------------------*/
+/**
+ * @brief	Call from the EXTI interrupt for the IRQ pin
+ * @param	Device: The device to use
+ * @retval	None
+ * @note	Only wakes the interrupt task, the bus is never taken from here
+ */
 void NRF24L01_Interrupt(NRF24L01_Device* Device)
 {
-	uint8_t status = NRF24L01_GetStatus(Device);
-	/* Data Sent TX FIFO interrupt, asserted when packet transmitted on TX */
-	if (status & (1 << TX_DS))
-	{
-		NRF24L01_PowerUpInRxMode(Device);
-		NRF24L01_ResetTxFlags(Device);
-		/* Give the semaphore because we are done transmitting */
-		xSemaphoreGiveFromISR(Device->xTxSemaphore, NULL);
-	}
-	/* Maximum number of TX retransmits interrupt */
-	else if (status & (1 << MAX_RT))
-	{
-		NRF24L01_PowerUpInRxMode(Device);
-		NRF24L01_ResetTxFlags(Device);
-		/* Give the semaphore because we are done transmitting */
-		xSemaphoreGiveFromISR(Device->xTxSemaphore, NULL);
-	}
-	/* Data Ready interrupt */
-	else if (status & (1 << RX_DR))
-	{
-		uint8_t pipe = PIPE_FROM_STATUS(status);
-		if (pipe < 6)
-		{
-			uint8_t buffer[32] = {};
-			uint8_t availableData = NRF24L01_GetDataFromRxBuffer(Device, buffer);
-
-			for (uint32_t i = 0; i < availableData; i++)
-			{
-				if (!CIRC_BUFFER_IsFull(&Device->RxPipeBuffer[pipe]))
-					CIRC_BUFFER_Insert(&Device->RxPipeBuffer[pipe], buffer[i]);
-			}
-			/* Give the xDataAvailableSemaphore to indicate there is new data available */
-			xSemaphoreGiveFromISR(Device->xDataAvailableSemaphore, NULL);
-		}
-		NRF24L01_ResetDataReadyFlag(Device);
-	}
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(Device->xInterruptTask, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
@@ -15,9 +15,11 @@
 /* Includes ------------------------------------------------------------------*/
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 #include "stm32f10x.h"
 #include <stdio.h>
 #include "circularBuffer/circularBuffer.h"
+#include "circularBuffer/circularBufferWait.h"
 #include "spi/spi.h"
 
 /* Defines -------------------------------------------------------------------*/
@@ -28,9 +30,20 @@
 
 #define PAYLOAD_SIZE		32
 #define DATA_COUNT_INDEX	0
-#define MAX_DATA_COUNT		PAYLOAD_SIZE-1	// 1 byte datacount
+#define MAX_DATA_COUNT		(PAYLOAD_SIZE-1)	// 1 byte datacount
+#define MAX_DYNAMIC_DATA_COUNT	(PAYLOAD_SIZE)	// No datacount with dynamic payload length, the width is the count
 #define PAYLOAD_FILLER_DATA	0xFF
 
+#define NRF24L01_TX_FIFO_SIZE	(3)		/* Number of payloads the TX FIFO in the nRF24L01 can hold */
+
+/* The interrupt task does all bus traffic for the IRQ pin, so it should run before the tasks using the device */
+#ifndef NRF24L01_INTERRUPT_TASK_PRIORITY
+#define NRF24L01_INTERRUPT_TASK_PRIORITY	(configMAX_PRIORITIES - 1)
+#endif
+#ifndef NRF24L01_INTERRUPT_TASK_STACK_SIZE
+#define NRF24L01_INTERRUPT_TASK_STACK_SIZE	(configMINIMAL_STACK_SIZE + 64)
+#endif
+
 /* Typedefs ------------------------------------------------------------------*/
 typedef enum
 {
@@ -39,6 +52,13 @@ typedef enum
 	NRF24L01AddressWidth_5bytes = 0x03,
 } NRF24L01AddressWidth;
 
+typedef struct
+{
+	uint8_t Register;		/* The register to write */
+	const uint8_t* Value;	/* The value to write, [MSByte ... LSByte] as for NRF24L01_WriteRegister */
+	uint8_t Size;			/* Number of bytes in Value, 1 to 5 */
+} NRF24L01_RegisterWrite;
+
 typedef struct
 {
 	char* NRF24L01_DeviceName;
@@ -56,10 +76,15 @@ typedef struct
 	uint8_t IRQ_NVIC_IRQChannel;
 
 	SPI_Device* SPIDevice;			/* SPI Device to use */
+	SPI_Slave SPISlave;				/* The device on the SPI bus, set up from CSN_Pin/CSN_GPIO by NRF24L01_Init */
 
 	CircularBuffer_TypeDef RxPipeBuffer[6];	/* Buffer for the six RX Pipes */
+	CircularBufferPolicy RxBufferPolicy;	/* What to do when a RX Pipe buffer is full, defaults to dropping new data */
+	CircularBufferWait_TypeDef RxPipeWait[6];	/* For tasks waiting on data in a RX Pipe */
 
+	TaskHandle_t xInterruptTask;				/* Task handling the IRQ pin, woken by NRF24L01_Interrupt */
 	SemaphoreHandle_t xTxSemaphore;				/* Semaphore for handling TX synchronization */
+	SemaphoreHandle_t xTxFifoSemaphore;			/* Counting semaphore with one count for each free payload in the TX FIFO while streaming */
 	SemaphoreHandle_t xDataAvailableSemaphore;	/* Semaphore for when data is available.
 												 * Will be given when data is available on any pipe
 												 */
@@ -77,7 +102,13 @@ typedef struct
 	uint8_t* RxAddress6;
 	uint8_t* RxAddress;
 
+	uint8_t DynamicPayloadLength;	/* Set before NRF24L01_Init to only send the data, all devices have to use the same setting */
+
 	uint8_t InTxMode;
+	volatile uint8_t TxStreaming;	/* Set between NRF24L01_StartTxStream and NRF24L01_StopTxStream */
+	uint32_t TxStreamDropped;		/* Number of streamed payloads flushed after MAX_RT */
+	uint32_t TxFifoWritten;			/* Payloads written to the TX FIFO while streaming, counted with the bus held */
+	uint32_t TxFifoFreed;			/* Payloads the interrupt task has given the TX FIFO count back for */
 
 } NRF24L01_Device;
 
@@ -86,9 +117,13 @@ typedef struct
 ErrorStatus NRF24L01_Init(NRF24L01_Device* Device);
 
 ErrorStatus NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount);
+ErrorStatus NRF24L01_StartTxStream(NRF24L01_Device* Device, TickType_t Timeout);
+ErrorStatus NRF24L01_StreamPayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount, TickType_t Timeout);
+ErrorStatus NRF24L01_StopTxStream(NRF24L01_Device* Device, TickType_t Timeout);
 
 void NRF24L01_ReadRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Buffer, uint8_t BufferSize);
 void NRF24L01_WriteRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Buffer, uint8_t BufferSize);
+void NRF24L01_WriteRegisters(NRF24L01_Device* Device, const NRF24L01_RegisterWrite* Writes, uint8_t WriteCount);
 
 void NRF24L01_SetTxAddress(NRF24L01_Device* Device, uint8_t* Address);
 void NRF24L01_SetRxAddressForPipe(NRF24L01_Device* Device, uint8_t* Address, uint8_t Pipe);
@@ -112,8 +147,10 @@ uint8_t NRF24L01_GetStatus(NRF24L01_Device* Device);
 uint8_t NRF24L01_GetDataFromRxBuffer(NRF24L01_Device* Device, uint8_t* Buffer);
 uint32_t NRF24L01_GetAvailableDataForPipe(NRF24L01_Device* Device, uint8_t Pipe);
 uint32_t NRF24L01_GetAvailableDataForAllPipes(NRF24L01_Device* Device);
+ErrorStatus NRF24L01_WaitForDataInPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t DataCount, TickType_t Timeout);
 void NRF24L01_GetDataFromPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* pBuffer, uint8_t BufferSize);
 void NRF24L01_PeekAtDataInPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* pBuffer, uint8_t BufferSize);
+uint32_t NRF24L01_GetOverrunsForPipe(NRF24L01_Device* Device, uint8_t Pipe);
 
 void NRF24L01_SetAddressWidth(NRF24L01_Device* Device);
 
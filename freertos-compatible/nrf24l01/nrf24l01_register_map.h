@@ -44,8 +44,9 @@
 #define RX_PW_P5    0x16
 #define FIFO_STATUS 0x17
 #define DYNPD		0x1C
+#define FEATURE		0x1D
 
-#define IS_VALID_REGISTER(REGISTER)		((REGISTER) >= CONFIG && (REGISTER) <= DYNPD)
+#define IS_VALID_REGISTER(REGISTER)		((REGISTER) >= CONFIG && (REGISTER) <= FEATURE)
 
 /* Bit Names -----------------------------------------------------------------*/
 #define MASK_RX_DR  6
@@ -86,6 +87,15 @@
 #define TX_EMPTY    4
 #define RX_FULL     1
 #define RX_EMPTY    0
+#define DPL_P5      5
+#define DPL_P4      4
+#define DPL_P3      3
+#define DPL_P2      2
+#define DPL_P1      1
+#define DPL_P0      0
+#define EN_DPL      2
+#define EN_ACK_PAY  1
+#define EN_DYN_ACK  0
 
 /* Pipes ---------------------------------------------------------------------*/
 #define PIPE_0		0x01
@@ -110,6 +120,8 @@
 #define R_REGISTER    0x00
 #define W_REGISTER    0x20
 #define REGISTER_MASK 0x1F
+#define ACTIVATE      0x50
+#define R_RX_PL_WID   0x60
 #define R_RX_PAYLOAD  0x61
 #define W_TX_PAYLOAD  0xA0
 #define FLUSH_TX      0xE1
@@ -117,8 +129,11 @@
 #define REUSE_TX_PL   0xE3
 #define NOP           0xFF
 
+#define ACTIVATE_FEATURES	0x73	/* Data byte for ACTIVATE that unlocks FEATURE, DYNPD and R_RX_PL_WID on the nRF24L01 without + */
+
 #define IS_VALID_COMMAND(COMMAND)	((COMMAND) == R_REGISTER || (COMMAND) == W_REGISTER || \
 									(COMMAND) == REGISTER_MASK || (COMMAND) == R_RX_PAYLOAD || \
 									(COMMAND) == W_TX_PAYLOAD || (COMMAND) == FLUSH_TX || \
 									(COMMAND) == FLUSH_RX || (COMMAND) == REUSE_TX_PL || \
+									(COMMAND) == ACTIVATE || (COMMAND) == R_RX_PL_WID || \
 									(COMMAND) == NOP)
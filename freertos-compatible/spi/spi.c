@@ -2,9 +2,14 @@
  ******************************************************************************
  * @file	spi.c
  * @author	Hampus Sandberg
- * @version	0.1
- * @date	2014-05-04
- * @brief
+ * @version	0.2
+ * @date	2014-11-16
+ * @brief	Transfers are done with the DMA1 channels for SPIx:
+ *			SPI1: RX = DMA1_Channel2, TX = DMA1_Channel3
+ *			SPI2: RX = DMA1_Channel4, TX = DMA1_Channel5
+ *			The application has to call SPI_DMAInterrupt() from the IRQ handler
+ *			of the RX channel, e.g. DMA1_Channel2_IRQHandler for SPI1, and
+ *			SPI_Interrupt() from SPIx_IRQHandler
  ******************************************************************************
  */
 
@@ -12,6 +17,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "spi.h"
 
+#include <string.h>
+
 /* Private defines -----------------------------------------------------------*/
 #define SCK_Pin_1	(GPIO_Pin_5)
 #define MISO_Pin_1	(GPIO_Pin_6)
@@ -21,8 +28,429 @@
 #define MISO_Pin_2	(GPIO_Pin_14)
 #define MOSI_Pin_2	(GPIO_Pin_15)
 
+#if defined(SPI_TIMING)
+#define TIMING_START(VARIABLE)				uint32_t VARIABLE = SPI_CYCLE_COUNTER()
+#define TIMING_STOP(DEVICE, KIND, START)	prvRecordTiming(&(DEVICE)->statistics.KIND, SPI_CYCLE_COUNTER() - (START))
+#else
+#define TIMING_START(VARIABLE)
+#define TIMING_STOP(DEVICE, KIND, START)
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+static const uint8_t dummyTxByte = SPI_DUMMY_BYTE;
+
 /* Private functions ---------------------------------------------------------*/
+#if defined(SPI_TIMING)
+/**
+ * @brief	Adds a measured duration
+ * @param	Timing: the timing to add the duration to
+ * @param	Cycles: the duration
+ * @retval	None
+ */
+static void prvRecordTiming(SPI_Timing* Timing, uint32_t Cycles)
+{
+	uint32_t bucket = 0;
+	for (uint32_t limit = Cycles >> 5; limit != 0 && bucket < SPI_HISTOGRAM_BUCKETS - 1; limit >>= 1)
+		bucket++;
+
+	Timing->count++;
+	Timing->totalCycles += Cycles;
+	if (Cycles > Timing->maxCycles)
+		Timing->maxCycles = Cycles;
+	Timing->histogram[bucket]++;
+}
+
+/**
+ * @brief	Writes a timing as "name: count=.., avg=.., max=.., histogram=a b c .."
+ * @param	Timing: the timing to write
+ * @param	Name: name of the timing
+ * @param	OutDevice: where to write it
+ * @retval	None
+ */
+static void prvDumpTiming(const SPI_Timing* Timing, const char* Name, OUT_Device* OutDevice)
+{
+	OUT_WriteString(OutDevice, Name);
+	OUT_WriteString(OutDevice, ": count=");
+	OUT_WriteNumber(OutDevice, Timing->count, 0);
+	OUT_WriteString(OutDevice, ", avg=");
+	OUT_WriteNumber(OutDevice, (Timing->count != 0) ? Timing->totalCycles / Timing->count : 0, 0);
+	OUT_WriteString(OutDevice, ", max=");
+	OUT_WriteNumber(OutDevice, Timing->maxCycles, 0);
+	OUT_WriteString(OutDevice, ", histogram=");
+	for (uint32_t i = 0; i < SPI_HISTOGRAM_BUCKETS; i++)
+	{
+		OUT_WriteNumber(OutDevice, Timing->histogram[i], 0);
+		OUT_WriteString(OutDevice, " ");
+	}
+	OUT_WriteString(OutDevice, "\r");
+}
+#endif
+
+/**
+ * @brief	Initializes one of the DMA channels used by SPIx
+ * @param	SPIDevice: the device the channel belongs to
+ * @param	Channel: the DMA channel
+ * @param	Direction: DMA_DIR_PeripheralSRC for RX, DMA_DIR_PeripheralDST for TX
+ * @param	Priority: priority for the channel
+ * @retval	None
+ */
+static void prvInitDMAChannel(SPI_Device* SPIDevice, DMA_Channel_TypeDef* Channel, uint32_t Direction, uint32_t Priority)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	DMA_DeInit(Channel);
+	DMA_InitStructure.DMA_PeripheralBaseAddr 	= (uint32_t)&SPIDevice->SPIx->DR;
+	DMA_InitStructure.DMA_MemoryBaseAddr 		= (uint32_t)&SPIDevice->dummyByte;
+	DMA_InitStructure.DMA_DIR 					= Direction;
+	DMA_InitStructure.DMA_BufferSize 			= 1;
+	DMA_InitStructure.DMA_PeripheralInc 		= DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc 			= DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize 	= DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize 		= DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode 					= DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority 				= Priority;
+	DMA_InitStructure.DMA_M2M 					= DMA_M2M_Disable;
+	DMA_Init(Channel, &DMA_InitStructure);
+}
+
+/**
+ * @brief	Prepares a DMA channel for a new transfer
+ * @param	Channel: the DMA channel
+ * @param	Address: memory address to transfer to/from
+ * @param	Increment: (1) if the memory address should be incremented, (0) to use the same byte
+ * @param	Length: number of bytes to transfer
+ * @retval	None
+ * @note	Writes the registers directly as this is done for every transfer
+ */
+static inline void prvPrepareDMAChannel(DMA_Channel_TypeDef* Channel, uint32_t Address, uint8_t Increment, uint16_t Length)
+{
+	uint32_t ccr = Channel->CCR & ~(DMA_CCR1_EN | DMA_CCR1_MINC | DMA_CCR1_CIRC | DMA_CCR1_HTIE);
+	if (Increment)
+		ccr |= DMA_CCR1_MINC;
+
+	Channel->CCR = ccr;
+	Channel->CMAR = Address;
+	Channel->CNDTR = Length;
+}
+
+/**
+ * @brief	Stops both DMA channels
+ * @param	SPIDevice: the device to stop the channels for
+ * @retval	None
+ */
+static inline void prvStopDMA(SPI_Device* SPIDevice)
+{
+	SPIDevice->DMA_TxChannel->CCR &= ~DMA_CCR1_EN;
+	SPIDevice->DMA_RxChannel->CCR &= ~DMA_CCR1_EN;
+	SPIDevice->SPIx->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+	DMA_ClearITPendingBit(SPIDevice->DMA_TxGlobalIT);
+	DMA_ClearITPendingBit(SPIDevice->DMA_RxGlobalIT);
+}
+
+/**
+ * @brief	Starts a transfer with DMA
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, NULL to write FillByte
+ * @param	FillByte: the byte to write when TxData is NULL, has to stay valid during the transfer
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer
+ * @retval	None
+ */
+static void prvStartDMATransfer(SPI_Device* SPIDevice, const uint8_t* TxData, const uint8_t* FillByte, uint8_t* RxData, uint16_t Length)
+{
+	SPI_COUNT(SPIDevice, transfers[SPI_TransferMode_DMA], 1);
+	SPI_COUNT(SPIDevice, bytes[SPI_TransferMode_DMA], Length);
+
+	if (RxData != 0)
+		prvPrepareDMAChannel(SPIDevice->DMA_RxChannel, (uint32_t)RxData, 1, Length);
+	else
+		prvPrepareDMAChannel(SPIDevice->DMA_RxChannel, (uint32_t)&SPIDevice->dummyByte, 0, Length);
+
+	if (TxData != 0)
+		prvPrepareDMAChannel(SPIDevice->DMA_TxChannel, (uint32_t)TxData, 1, Length);
+	else
+		prvPrepareDMAChannel(SPIDevice->DMA_TxChannel, (uint32_t)FillByte, 0, Length);
+
+	/* Start RX before TX so the first received byte can't be missed */
+	SPIDevice->DMA_RxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->DMA_TxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->SPIx->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+/**
+ * @brief	Starts a transfer driven by the SPI interrupt
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, NULL to write FillByte
+ * @param	FillByte: the byte to write when TxData is NULL
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer
+ * @retval	None
+ * @note	The next byte is written when the previous one has been received, so
+ *			there is one RXNE interrupt per byte and the receiver can never overrun
+ */
+static void prvStartIRQTransfer(SPI_Device* SPIDevice, const uint8_t* TxData, const uint8_t* FillByte, uint8_t* RxData, uint16_t Length)
+{
+	SPI_COUNT(SPIDevice, transfers[SPI_TransferMode_Interrupt], 1);
+	SPI_COUNT(SPIDevice, bytes[SPI_TransferMode_Interrupt], Length);
+
+	SPIDevice->irqRxData = RxData;
+	SPIDevice->irqCount = Length;
+	SPIDevice->irqFillByte = *FillByte;
+
+	uint8_t firstByte = *FillByte;
+	if (TxData != 0)
+	{
+		firstByte = *TxData;
+		TxData++;
+	}
+	SPIDevice->irqTxData = TxData;
+
+	SPIDevice->SPIx->CR2 |= SPI_CR2_RXNEIE;
+	SPIDevice->SPIx->DR = firstByte;
+}
+
+/**
+ * @brief	Stops an interrupt driven transfer
+ * @param	SPIDevice: the device to stop the transfer for
+ * @retval	None
+ */
+static inline void prvStopIRQTransfer(SPI_Device* SPIDevice)
+{
+	SPIDevice->SPIx->CR2 &= ~SPI_CR2_RXNEIE;
+	SPIDevice->irqCount = 0;
+
+	/* Don't leave a received byte behind for the next transfer */
+	(void)SPIDevice->SPIx->DR;
+}
+
+/**
+ * @brief	Configures the bus for a slave without selecting it
+ * @param	SPIDevice: the bus, has to be owned by the caller
+ * @param	Slave: the slave whose clock settings should be used
+ * @retval	None
+ */
+static void prvConfigureForSlave(SPI_Device* SPIDevice, SPI_Slave* Slave)
+{
+	if (SPIDevice->activeSlave != Slave)
+	{
+		/* The clock settings can only be changed when SPIx is disabled */
+		SPIDevice->SPIx->CR1 = Slave->cr1 & ~SPI_CR1_SPE;
+		SPIDevice->SPIx->CR1 = Slave->cr1;
+		SPIDevice->activeSlave = Slave;
+		SPI_COUNT(SPIDevice, slaveSwitches, 1);
+	}
+}
+
+/**
+ * @brief	Configures the bus for a slave and selects it
+ * @param	SPIDevice: the bus, has to be owned by the caller
+ * @param	Slave: the slave to select
+ * @retval	None
+ */
+static void prvActivateSlave(SPI_Device* SPIDevice, SPI_Slave* Slave)
+{
+	prvConfigureForSlave(SPIDevice, Slave);
+	Slave->CS_GPIO->BRR = Slave->CS_Pin;
+	SPI_COUNT(SPIDevice, selects, 1);
+}
+
+/**
+ * @brief	Starts the next segment of a queued transaction that isn't empty
+ * @param	SPIDevice: the bus, has to be owned by the queue
+ * @param	Transaction: the transaction to continue, segmentIndex is the next segment
+ * @retval	(1) if a segment was started, (0) if there were no more segments
+ */
+static uint8_t prvStartNextSegment(SPI_Device* SPIDevice, SPI_Transaction* Transaction)
+{
+	while (Transaction->segmentIndex < Transaction->SegmentCount)
+	{
+		const SPI_Segment* segment = &Transaction->Segments[Transaction->segmentIndex++];
+		if (segment->Length != 0)
+		{
+			prvStartDMATransfer(SPIDevice, segment->TxData, &segment->FillByte, segment->RxData, segment->Length);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief	Starts a queued transaction
+ * @param	SPIDevice: the bus, has to be owned by the queue
+ * @param	Transaction: the transaction to start
+ * @retval	None
+ */
+static void prvStartTransaction(SPI_Device* SPIDevice, SPI_Transaction* Transaction)
+{
+#if defined(SPI_TIMING)
+	SPIDevice->transactionStart = SPI_CYCLE_COUNTER();
+#endif
+	SPIDevice->activeTransaction = Transaction;
+	prvActivateSlave(SPIDevice, Transaction->Slave);
+
+	if (Transaction->Segments == 0)
+		prvStartDMATransfer(SPIDevice, Transaction->TxData, &dummyTxByte, Transaction->RxData, Transaction->Length);
+	else
+	{
+		Transaction->segmentIndex = 0;
+		prvStartNextSegment(SPIDevice, Transaction);
+	}
+}
+
+/**
+ * @brief	Gives back the bus, or hands it over to the queue if something was
+ *			submitted while it was taken
+ * @param	SPIDevice: the bus, has to be owned by the calling task
+ * @retval	None
+ */
+static void prvReleaseBus(SPI_Device* SPIDevice)
+{
+	taskENTER_CRITICAL();
+	SPI_Transaction* next = SPIDevice->queueHead;
+	if (next == 0)
+		xSemaphoreGive(SPIDevice->xBusSemaphore);
+	taskEXIT_CRITICAL();
+
+	if (next != 0)
+		prvStartTransaction(SPIDevice, next);
+}
+
+/**
+ * @brief	Handles the DMA interrupt while a stream is running
+ * @param	SPIDevice: the device the interrupt is for
+ * @param	Stream: the running stream
+ * @retval	None
+ */
+static void prvStreamInterrupt(SPI_Device* SPIDevice, SPI_Stream* Stream)
+{
+	uint8_t halfDone = (DMA_GetITStatus(SPIDevice->DMA_RxHalfIT) != RESET);
+	uint8_t fullDone = (DMA_GetITStatus(SPIDevice->DMA_RxCompleteIT) != RESET);
+
+	/* Both halves done means the last callback was too late and a half was overwritten */
+	if (halfDone && fullDone)
+		Stream->Overruns++;
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	if (halfDone)
+	{
+		DMA_ClearITPendingBit(SPIDevice->DMA_RxHalfIT);
+		Stream->Callback(Stream, 0, &xHigherPriorityTaskWoken);
+	}
+	if (fullDone)
+	{
+		DMA_ClearITPendingBit(SPIDevice->DMA_RxCompleteIT);
+		Stream->Callback(Stream, 1, &xHigherPriorityTaskWoken);
+	}
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief	Writes and receives a block of data by polling the flags
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, NULL to write FillByte
+ * @param	FillByte: the byte to write when TxData is NULL
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer
+ * @retval	None
+ */
+static void prvPollTransfer(SPI_Device* SPIDevice, const uint8_t* TxData, const uint8_t* FillByte, uint8_t* RxData, uint16_t Length)
+{
+	SPI_COUNT(SPIDevice, transfers[SPI_TransferMode_Polled], 1);
+	SPI_COUNT(SPIDevice, bytes[SPI_TransferMode_Polled], Length);
+
+	SPI_TypeDef* SPIx = SPIDevice->SPIx;
+	for (uint32_t i = 0; i < Length; i++)
+	{
+		while (!(SPIx->SR & SPI_SR_TXE));
+		SPIx->DR = (TxData != 0) ? TxData[i] : *FillByte;
+
+		while (!(SPIx->SR & SPI_SR_RXNE));
+		uint8_t receivedByte = (uint8_t)SPIx->DR;
+		if (RxData != 0)
+			RxData[i] = receivedByte;
+	}
+}
+
+/**
+ * @brief	Writes and receives a block of data in a specific way and waits for it to finish
+ * @param	SPIDevice: the device to use
+ * @param	Mode: how the transfer should be done
+ * @param	TxData: data to write, NULL to write FillByte
+ * @param	FillByte: the byte to write when TxData is NULL
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer, at least 1
+ * @param	Timeout: max number of ticks to wait for the transfer to finish
+ * @retval	SUCCESS if the transfer finished, ERROR if it timed out and was stopped
+ */
+static ErrorStatus prvTransferWithMode(SPI_Device* SPIDevice, SPI_TransferMode Mode, const uint8_t* TxData, const uint8_t* FillByte, uint8_t* RxData, uint16_t Length, TickType_t Timeout)
+{
+	TIMING_START(start);
+	if (Mode == SPI_TransferMode_Polled)
+	{
+		prvPollTransfer(SPIDevice, TxData, FillByte, RxData, Length);
+		TIMING_STOP(SPIDevice, transferTime, start);
+		return SUCCESS;
+	}
+
+	uint8_t useDMA = (Mode == SPI_TransferMode_DMA);
+	if (useDMA)
+		prvStartDMATransfer(SPIDevice, TxData, FillByte, RxData, Length);
+	else
+		prvStartIRQTransfer(SPIDevice, TxData, FillByte, RxData, Length);
+
+	if (xSemaphoreTake(SPIDevice->xTransferSemaphore, Timeout) != pdTRUE)
+	{
+		if (useDMA)
+			prvStopDMA(SPIDevice);
+		else
+			prvStopIRQTransfer(SPIDevice);
+		/* The transfer might have finished after all, don't let it complete the next transfer */
+		xSemaphoreTake(SPIDevice->xTransferSemaphore, 0);
+		SPI_COUNT(SPIDevice, timeouts, 1);
+		return ERROR;
+	}
+
+	TIMING_STOP(SPIDevice, transferTime, start);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Writes and receives a block of data and waits for it to finish
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, NULL to write FillByte
+ * @param	FillByte: the byte to write when TxData is NULL
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer
+ * @param	Timeout: max number of ticks to wait for the transfer to finish
+ * @retval	SUCCESS if the transfer finished, ERROR if it timed out and was stopped
+ */
+static ErrorStatus prvTransfer(SPI_Device* SPIDevice, const uint8_t* TxData, const uint8_t* FillByte, uint8_t* RxData, uint16_t Length, TickType_t Timeout)
+{
+	if (Length == 0)
+		return SUCCESS;
+
+	return prvTransferWithMode(SPIDevice, SPI_GetTransferMode(SPIDevice, Length), TxData, FillByte, RxData, Length, Timeout);
+}
+
+/**
+ * @brief	Measures how many cycles a transfer of dummy bytes takes
+ * @param	SPIDevice: the device to use
+ * @param	Mode: how the transfer should be done
+ * @param	Length: number of bytes to transfer
+ * @retval	The average number of cycles
+ */
+static uint32_t prvMeasureTransfer(SPI_Device* SPIDevice, SPI_TransferMode Mode, uint16_t Length)
+{
+	const uint32_t iterations = 4;
+	uint32_t start = DWT->CYCCNT;
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		prvTransferWithMode(SPIDevice, Mode, 0, &dummyTxByte, 0, Length, portMAX_DELAY);
+	}
+
+	return (DWT->CYCCNT - start) / iterations;
+}
+
 /* Functions -----------------------------------------------------------------*/
 /**
  * @brief	Initializes the SPI
@@ -53,22 +481,50 @@ void SPI_Device_Init(SPI_Device* SPIDevice)
  */
 void SPI_InitWithStructure(SPI_Device* SPIDevice, SPI_InitTypeDef* SPI_InitStructure)
 {
-	SPIDevice->receivedByte = 0;
+	/* Every slave driver on the bus will try to initialize it, only the first one does */
+	if (SPIDevice->Initialized)
+		return;
+
+	SPIDevice->dummyByte = 0;
+	SPIDevice->activeSlave = 0;
+	SPIDevice->PollMaxLength = SPI_POLL_MAX_LENGTH;
+	SPIDevice->DMAMinLength = SPI_DMA_MIN_LENGTH;
+
+#if defined(SPI_CYCLE_COUNTER_DWT)
+	/* Start the cycle counter used to measure the transfers */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	SPIDevice->queueHead = 0;
+	SPIDevice->queueTail = 0;
+	SPIDevice->activeTransaction = 0;
+	SPIDevice->activeStream = 0;
 
 	/*
-	 * Create the binary semaphores:
+	 * Create the binary semaphore:
 	 * The semaphore is created in the 'empty' state, meaning
 	 * the semaphore must first be given before it can be taken (obtained)
 	 * using the xSemaphoreTake() function.
 	 */
-	SPIDevice->xTxSemaphore = xSemaphoreCreateBinary();
-	SPIDevice->xRxSemaphore = xSemaphoreCreateBinary();
-	xSemaphoreGive(SPIDevice->xTxSemaphore);				/* We know TX should be empty from the beginning */
-	xSemaphoreGive(SPIDevice->xRxSemaphore);
-	xSemaphoreTake(SPIDevice->xRxSemaphore, portMAX_DELAY);
+	SPIDevice->xTransferSemaphore = xSemaphoreCreateBinary();
+	/* Not a mutex as the bus is given back from the DMA interrupt when the queue is done */
+	SPIDevice->xBusSemaphore = xSemaphoreCreateBinary();
+	xSemaphoreGive(SPIDevice->xBusSemaphore);
+
+	/* Enable DMA1 clock */
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
 
+	uint8_t dmaIRQChannel = 0;
 	if (SPIDevice->SPI_Channel == 1)
 	{
+		SPIDevice->DMA_RxChannel 	= DMA1_Channel2;
+		SPIDevice->DMA_TxChannel 	= DMA1_Channel3;
+		SPIDevice->DMA_RxCompleteIT = DMA1_IT_TC2;
+		SPIDevice->DMA_RxHalfIT 	= DMA1_IT_HT2;
+		SPIDevice->DMA_RxGlobalIT 	= DMA1_IT_GL2;
+		SPIDevice->DMA_TxGlobalIT 	= DMA1_IT_GL3;
+		dmaIRQChannel 				= DMA1_Channel2_IRQn;
+
 		/* Enable GPIOx clock */
 		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
 		RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
@@ -100,6 +556,14 @@ void SPI_InitWithStructure(SPI_Device* SPIDevice, SPI_InitTypeDef* SPI_InitStruc
 	}
 	else if (SPIDevice->SPI_Channel == 2)
 	{
+		SPIDevice->DMA_RxChannel 	= DMA1_Channel4;
+		SPIDevice->DMA_TxChannel 	= DMA1_Channel5;
+		SPIDevice->DMA_RxCompleteIT = DMA1_IT_TC4;
+		SPIDevice->DMA_RxHalfIT 	= DMA1_IT_HT4;
+		SPIDevice->DMA_RxGlobalIT 	= DMA1_IT_GL4;
+		SPIDevice->DMA_TxGlobalIT 	= DMA1_IT_GL5;
+		dmaIRQChannel 				= DMA1_Channel4_IRQn;
+
 		/* Enable GPIOx clock */
 		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
 		RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
@@ -133,13 +597,29 @@ void SPI_InitWithStructure(SPI_Device* SPIDevice, SPI_InitTypeDef* SPI_InitStruc
 	SPI_Init(SPIDevice->SPIx, SPI_InitStructure);
 
 	/*
-	 * Enable SPI_I2S_IT_RXNE interrupt
-	 * SPI_I2S_IT_TXE interrupt will only be enabled when a write should happen
-	 * */
-	SPI_I2S_ITConfig(SPIDevice->SPIx, SPI_I2S_IT_RXNE, ENABLE);
+	 * Initialize the DMA channels, RX has the higher priority so the received
+	 * byte is always read before the next one arrives
+	 */
+	prvInitDMAChannel(SPIDevice, SPIDevice->DMA_RxChannel, DMA_DIR_PeripheralSRC, DMA_Priority_VeryHigh);
+	prvInitDMAChannel(SPIDevice, SPIDevice->DMA_TxChannel, DMA_DIR_PeripheralDST, DMA_Priority_High);
+
+	/* The whole transfer is done when the last byte has been received */
+	DMA_ITConfig(SPIDevice->DMA_RxChannel, DMA_IT_TC, ENABLE);
+
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel 						= dmaIRQChannel;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority 	= configLIBRARY_LOWEST_INTERRUPT_PRIORITY - 1;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority 			= 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd 					= ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	/* The DMA requests in SPIx are only enabled during DMA transfers */
+	SPIDevice->irqCount = 0;
 
 	/* Enable SPIx */
 	SPI_Cmd(SPIDevice->SPIx, ENABLE);
+
+	SPIDevice->Initialized = 1;
 }
 
 /**
@@ -149,40 +629,527 @@ void SPI_InitWithStructure(SPI_Device* SPIDevice, SPI_InitTypeDef* SPI_InitStruc
  */
 uint8_t SPI_WriteRead(SPI_Device* SPIDevice, uint8_t Data)
 {
-	/* Enable SPI_MASTER TXE interrupt */
-	SPI_I2S_ITConfig(SPIDevice->SPIx, SPI_I2S_IT_TXE, ENABLE);
-	/* Try to take the TX Semaphore */
-	xSemaphoreTake(SPIDevice->xTxSemaphore, portMAX_DELAY);
+	uint8_t receivedByte = 0;
+	SPI_Transfer(SPIDevice, &Data, &receivedByte, 1, portMAX_DELAY);
 
-	/* Send byte through the SPIx peripheral */
-	SPIDevice->SPIx->DR = Data;
+	/* Return the byte read from the SPI bus */
+	return receivedByte;
+}
 
-	/* Try to take the RX Semaphore */
-	xSemaphoreTake(SPIDevice->xRxSemaphore, portMAX_DELAY);
+/**
+ * @brief	Writes and receives a block of data
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, if NULL SPI_DUMMY_BYTE is written Length times
+ * @param	RxData: where to store the received data, if NULL it's thrown away
+ * @param	Length: number of bytes to transfer
+ * @param	Timeout: max number of ticks to wait for the transfer to finish
+ * @retval	SUCCESS if the transfer finished, ERROR if it timed out and was stopped
+ * @note	The calling task is blocked until the transfer is done, unless it's
+ *			short enough to be polled. TxData and RxData can be the same buffer
+ */
+ErrorStatus SPI_Transfer(SPI_Device* SPIDevice, const uint8_t* TxData, uint8_t* RxData, uint16_t Length, TickType_t Timeout)
+{
+	return prvTransfer(SPIDevice, TxData, &dummyTxByte, RxData, Length, Timeout);
+}
 
-	/* Return the byte read from the SPI bus */
-	return SPIDevice->receivedByte;
+/**
+ * @brief	Sets the thresholds used to decide how transfers are done
+ * @param	SPIDevice: the device to set the thresholds for
+ * @param	PollMaxLength: transfers up to this length are polled, 0 to never poll
+ * @param	DMAMinLength: transfers from this length are done with DMA, the ones
+ *			between PollMaxLength and DMAMinLength by the SPI interrupt
+ * @retval	None
+ */
+void SPI_SetThresholds(SPI_Device* SPIDevice, uint16_t PollMaxLength, uint16_t DMAMinLength)
+{
+	SPIDevice->PollMaxLength = PollMaxLength;
+	SPIDevice->DMAMinLength = DMAMinLength;
+}
+
+/**
+ * @brief	Gets how a transfer of a specific length will be done
+ * @param	SPIDevice: the device to use
+ * @param	Length: number of bytes to transfer
+ * @retval	The mode that will be used
+ */
+SPI_TransferMode SPI_GetTransferMode(SPI_Device* SPIDevice, uint16_t Length)
+{
+	if (Length <= SPIDevice->PollMaxLength)
+		return SPI_TransferMode_Polled;
+	else if (Length < SPIDevice->DMAMinLength)
+		return SPI_TransferMode_Interrupt;
+	else
+		return SPI_TransferMode_DMA;
+}
+
+/**
+ * @brief	Measures the thresholds between the transfer modes on the running board
+ *			and sets them for the bus of the slave
+ * @param	Slave: the slave whose clock settings should be used
+ * @retval	None
+ * @note	Has to be called from a task. Dummy bytes are transferred with the
+ *			chip select of the slave high so no slave sees them. Polling is used as
+ *			long as polling the bytes takes less time than what blocking the task
+ *			costs on top of the time on the bus, and DMA from the length where
+ *			it's faster than the SPI interrupt. Uses the DWT cycle counter
+ */
+void SPI_Calibrate(SPI_Slave* Slave)
+{
+	SPI_Device* SPIDevice = Slave->SPIDevice;
+	xSemaphoreTake(SPIDevice->xBusSemaphore, portMAX_DELAY);
+
+	/* Use the clock of the slave, but don't select it */
+	prvConfigureForSlave(SPIDevice, Slave);
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	uint16_t pollMaxLength = 0;
+	uint16_t dmaMinLength = 0;
+	for (uint16_t length = 1; length <= SPI_CALIBRATION_MAX_LENGTH; length++)
+	{
+		uint32_t polled = prvMeasureTransfer(SPIDevice, SPI_TransferMode_Polled, length);
+		uint32_t interrupt = prvMeasureTransfer(SPIDevice, SPI_TransferMode_Interrupt, length);
+		uint32_t dma = prvMeasureTransfer(SPIDevice, SPI_TransferMode_DMA, length);
+
+		/* Polling takes about as long as the bytes are on the bus, the rest of a blocking transfer is overhead */
+		uint32_t blocking = (interrupt < dma) ? interrupt : dma;
+		if (pollMaxLength == length - 1 && blocking > polled && polled <= blocking - polled)
+			pollMaxLength = length;
+
+		if (dmaMinLength == 0 && dma <= interrupt)
+			dmaMinLength = length;
+	}
+
+	if (dmaMinLength == 0)
+		dmaMinLength = SPI_CALIBRATION_MAX_LENGTH + 1;
+	if (dmaMinLength <= pollMaxLength)
+		dmaMinLength = pollMaxLength + 1;
+	SPI_SetThresholds(SPIDevice, pollMaxLength, dmaMinLength);
+#if defined(SPI_STATISTICS)
+	/* Don't let the dummy transfers show up in the statistics */
+	SPI_ResetStatistics(SPIDevice);
+#endif
+
+	prvReleaseBus(SPIDevice);
+}
+
+#if defined(SPI_STATISTICS)
+/**
+ * @brief	Gets a consistent copy of the statistics for a bus
+ * @param	SPIDevice: the device to get the statistics for
+ * @param	Statistics: where to store the copy
+ * @retval	None
+ */
+void SPI_GetStatistics(SPI_Device* SPIDevice, SPI_Statistics* Statistics)
+{
+	taskENTER_CRITICAL();
+	*Statistics = SPIDevice->statistics;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	Resets the statistics for a bus
+ * @param	SPIDevice: the device to reset the statistics for
+ * @retval	None
+ */
+void SPI_ResetStatistics(SPI_Device* SPIDevice)
+{
+	taskENTER_CRITICAL();
+	memset(&SPIDevice->statistics, 0, sizeof(SPIDevice->statistics));
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	Writes the statistics for a bus
+ * @param	SPIDevice: the device to write the statistics for
+ * @param	Name: name to write before the statistics
+ * @param	OutDevice: where to write the statistics
+ * @retval	None
+ */
+void SPI_DumpStatistics(SPI_Device* SPIDevice, const char* Name, OUT_Device* OutDevice)
+{
+	SPI_Statistics statistics;
+	SPI_GetStatistics(SPIDevice, &statistics);
+
+	static const char* modeNames[] = {"polled", "interrupt", "dma"};
+	OUT_WriteString(OutDevice, Name);
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		OUT_WriteString(OutDevice, (i == 0) ? ": " : ", ");
+		OUT_WriteString(OutDevice, modeNames[i]);
+		OUT_WriteString(OutDevice, "=");
+		OUT_WriteNumber(OutDevice, statistics.transfers[i], 0);
+		OUT_WriteString(OutDevice, "/");
+		OUT_WriteNumber(OutDevice, statistics.bytes[i], 0);
+		OUT_WriteString(OutDevice, " bytes");
+	}
+	OUT_WriteString(OutDevice, ", timeouts=");
+	OUT_WriteNumber(OutDevice, statistics.timeouts, 0);
+	OUT_WriteString(OutDevice, ", selects=");
+	OUT_WriteNumber(OutDevice, statistics.selects, 0);
+	OUT_WriteString(OutDevice, ", slave switches=");
+	OUT_WriteNumber(OutDevice, statistics.slaveSwitches, 0);
+	OUT_WriteString(OutDevice, ", spi irqs=");
+	OUT_WriteNumber(OutDevice, statistics.spiInterrupts, 0);
+	OUT_WriteString(OutDevice, ", dma irqs=");
+	OUT_WriteNumber(OutDevice, statistics.dmaInterrupts, 0);
+	OUT_WriteString(OutDevice, "\r");
+
+#if defined(SPI_TIMING)
+	prvDumpTiming(&statistics.transferTime, "  transfer cycles", OutDevice);
+	prvDumpTiming(&statistics.busWaitTime, "  bus wait cycles", OutDevice);
+#endif
+}
+#endif
+
+/**
+ * @brief	Writes and receives several segments of data back to back
+ * @param	SPIDevice: the device to use
+ * @param	Segments: the segments to transfer, in order
+ * @param	SegmentCount: number of segments
+ * @param	Timeout: max number of ticks to wait for each segment to finish
+ * @retval	SUCCESS if all segments were transferred, ERROR if one timed out
+ * @note	Nothing is copied, each segment is transferred straight from/to its
+ *			own buffers. The slave should be selected for the whole call
+ */
+ErrorStatus SPI_TransferSegments(SPI_Device* SPIDevice, const SPI_Segment* Segments, uint8_t SegmentCount, TickType_t Timeout)
+{
+	for (uint32_t i = 0; i < SegmentCount; i++)
+	{
+		const SPI_Segment* segment = &Segments[i];
+		if (prvTransfer(SPIDevice, segment->TxData, &segment->FillByte, segment->RxData, segment->Length, Timeout) != SUCCESS)
+			return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Initializes a slave on an SPI bus
+ * @param	Slave: the slave to initialize, the SPI_Device has to be initialized first
+ * @retval	None
+ */
+void SPI_SlaveInit(SPI_Slave* Slave)
+{
+	/* Initialize CS (Chip select) pin */
+	if (Slave->CS_GPIO == GPIOA)
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+	else if (Slave->CS_GPIO == GPIOB)
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+	else if (Slave->CS_GPIO == GPIOC)
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
+
+	GPIO_InitTypeDef GPIO_InitStructure;
+	GPIO_InitStructure.GPIO_Mode 		= GPIO_Mode_Out_PP;
+	GPIO_InitStructure.GPIO_Pin 		= Slave->CS_Pin;
+	GPIO_InitStructure.GPIO_Speed 		= GPIO_Speed_50MHz;
+	GPIO_Init(Slave->CS_GPIO, &GPIO_InitStructure);
+	Slave->CS_GPIO->BSRR = Slave->CS_Pin;
+
+	/* Use the bus settings but with the clock of the slave */
+	uint16_t cr1 = Slave->SPIDevice->SPIx->CR1 & ~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA);
+	Slave->cr1 = cr1 | Slave->BaudRatePrescaler | Slave->CPOL | Slave->CPHA;
+}
+
+/**
+ * @brief	Takes the bus and selects a slave
+ * @param	Slave: the slave to select
+ * @param	Timeout: max number of ticks to wait for the bus
+ * @retval	SUCCESS if the slave was selected, ERROR if the bus wasn't available in time
+ * @note	Has to be called from a task. The bus is owned by the calling task
+ *			until SPI_Deselect() is called
+ */
+ErrorStatus SPI_Select(SPI_Slave* Slave, TickType_t Timeout)
+{
+	SPI_Device* SPIDevice = Slave->SPIDevice;
+	TIMING_START(start);
+	if (xSemaphoreTake(SPIDevice->xBusSemaphore, Timeout) != pdTRUE)
+		return ERROR;
+	TIMING_STOP(SPIDevice, busWaitTime, start);
+
+	prvActivateSlave(SPIDevice, Slave);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Deselects a slave and gives back the bus
+ * @param	Slave: the slave to deselect
+ * @retval	None
+ */
+void SPI_Deselect(SPI_Slave* Slave)
+{
+	SPI_Device* SPIDevice = Slave->SPIDevice;
+	Slave->CS_GPIO->BSRR = Slave->CS_Pin;
+	prvReleaseBus(SPIDevice);
+}
+
+/**
+ * @brief	Ends the command of a selected slave and starts the next one without
+ *			giving back the bus, chip select is high for at least CS_HighTime
+ * @param	Slave: the slave selected with SPI_Select
+ * @retval	None
+ * @note	Two stores to the port are only a few cycles apart, too short for e.g.
+ *			the 50 ns Tcwh of the nRF24L01. Every read of the port waits for the
+ *			APB bus and takes at least two cycles, so the pin is read back until
+ *			enough cycles have passed
+ */
+void SPI_Reselect(SPI_Slave* Slave)
+{
+	const uint32_t cyclesPerUs = SPI_CPU_CLOCK_HZ / 1000000;
+	uint32_t reads = (Slave->CS_HighTime * cyclesPerUs + 999) / 1000 / 2 + 1;
+
+	Slave->CS_GPIO->BSRR = Slave->CS_Pin;
+	for (uint32_t i = 0; i < reads; i++)
+		(void)Slave->CS_GPIO->ODR;
+	Slave->CS_GPIO->BRR = Slave->CS_Pin;
+	SPI_COUNT(Slave->SPIDevice, selects, 1);
+}
+
+/**
+ * @brief	Writes and receives a block of data with a slave as one transaction
+ * @param	Slave: the slave to transfer data with
+ * @param	TxData: data to write, if NULL SPI_DUMMY_BYTE is written Length times
+ * @param	RxData: where to store the received data, if NULL it's thrown away
+ * @param	Length: number of bytes to transfer
+ * @param	Timeout: max number of ticks to wait for the bus and for the transfer
+ * @retval	SUCCESS if the transfer finished, ERROR otherwise
+ */
+ErrorStatus SPI_SlaveTransfer(SPI_Slave* Slave, const uint8_t* TxData, uint8_t* RxData, uint16_t Length, TickType_t Timeout)
+{
+	if (SPI_Select(Slave, Timeout) != SUCCESS)
+		return ERROR;
+
+	ErrorStatus status = SPI_Transfer(Slave->SPIDevice, TxData, RxData, Length, Timeout);
+	SPI_Deselect(Slave);
+	return status;
+}
+
+/**
+ * @brief	Writes and receives several segments of data with a slave as one transaction
+ * @param	Slave: the slave to transfer data with
+ * @param	Segments: the segments to transfer, in order
+ * @param	SegmentCount: number of segments
+ * @param	Timeout: max number of ticks to wait for the bus and for each segment
+ * @retval	SUCCESS if the transfer finished, ERROR otherwise
+ */
+ErrorStatus SPI_SlaveTransferSegments(SPI_Slave* Slave, const SPI_Segment* Segments, uint8_t SegmentCount, TickType_t Timeout)
+{
+	if (SPI_Select(Slave, Timeout) != SUCCESS)
+		return ERROR;
+
+	ErrorStatus status = SPI_TransferSegments(Slave->SPIDevice, Segments, SegmentCount, Timeout);
+	SPI_Deselect(Slave);
+	return status;
+}
+
+/**
+ * @brief	Queues a transaction and returns immediately
+ * @param	Transaction: the transaction to queue, has to stay valid until Done is set,
+ *			as do its buffers and segments
+ * @retval	SUCCESS if the transaction was queued, ERROR if it was empty
+ * @note	The transactions on a bus are done in the order they were submitted.
+ *			Has to be called from a task
+ */
+ErrorStatus SPI_Submit(SPI_Transaction* Transaction)
+{
+	if (Transaction->Segments == 0 && Transaction->Length == 0)
+		return ERROR;
+
+	/* There has to be something to transfer, the DMA interrupt is what moves the queue forward */
+	if (Transaction->Segments != 0)
+	{
+		uint32_t length = 0;
+		for (uint32_t i = 0; i < Transaction->SegmentCount; i++)
+			length += Transaction->Segments[i].Length;
+		if (length == 0)
+			return ERROR;
+	}
+
+	SPI_Device* SPIDevice = Transaction->Slave->SPIDevice;
+	Transaction->Done = 0;
+	Transaction->next = 0;
+
+	/* If the queue is idle it has to take the bus, otherwise the DMA interrupt will get to it */
+	taskENTER_CRITICAL();
+	uint8_t start = 0;
+	if (SPIDevice->queueHead == 0)
+	{
+		SPIDevice->queueHead = Transaction;
+		start = (xSemaphoreTake(SPIDevice->xBusSemaphore, 0) == pdTRUE);
+	}
+	else
+		SPIDevice->queueTail->next = Transaction;
+	SPIDevice->queueTail = Transaction;
+	taskEXIT_CRITICAL();
+
+	/* If the bus was taken SPI_Deselect will start the queue */
+	if (start)
+		prvStartTransaction(SPIDevice, Transaction);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Starts streaming data with a slave until SPI_StopStream() is called
+ * @param	Stream: the stream to start, has to stay valid until it's stopped
+ * @param	Timeout: max number of ticks to wait for the bus
+ * @retval	SUCCESS if the stream was started, ERROR if the bus wasn't available in time
+ * @note	Has to be called from a task. The slave stays selected and the bus is
+ *			owned by the stream until it's stopped. The DMA channels run in
+ *			circular mode over the 2 * HalfLength byte buffers, so there are no
+ *			gaps on the bus as long as the callback is done with a half before
+ *			the other half is done
+ */
+ErrorStatus SPI_StartStream(SPI_Stream* Stream, TickType_t Timeout)
+{
+	if (Stream->HalfLength == 0 || Stream->Callback == 0)
+		return ERROR;
+
+	SPI_Device* SPIDevice = Stream->Slave->SPIDevice;
+	TIMING_START(start);
+	if (xSemaphoreTake(SPIDevice->xBusSemaphore, Timeout) != pdTRUE)
+		return ERROR;
+	TIMING_STOP(SPIDevice, busWaitTime, start);
+
+	prvActivateSlave(SPIDevice, Stream->Slave);
+	Stream->Overruns = 0;
+	SPIDevice->activeStream = Stream;
+	SPI_COUNT(SPIDevice, transfers[SPI_TransferMode_DMA], 1);
+
+	uint16_t length = 2 * Stream->HalfLength;
+	if (Stream->RxData != 0)
+		prvPrepareDMAChannel(SPIDevice->DMA_RxChannel, (uint32_t)Stream->RxData, 1, length);
+	else
+		prvPrepareDMAChannel(SPIDevice->DMA_RxChannel, (uint32_t)&SPIDevice->dummyByte, 0, length);
+
+	if (Stream->TxData != 0)
+		prvPrepareDMAChannel(SPIDevice->DMA_TxChannel, (uint32_t)Stream->TxData, 1, length);
+	else
+		prvPrepareDMAChannel(SPIDevice->DMA_TxChannel, (uint32_t)&dummyTxByte, 0, length);
+
+	SPIDevice->DMA_RxChannel->CCR |= DMA_CCR1_CIRC | DMA_CCR1_HTIE;
+	SPIDevice->DMA_TxChannel->CCR |= DMA_CCR1_CIRC;
+
+	/* Start RX before TX so the first received byte can't be missed */
+	SPIDevice->DMA_RxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->DMA_TxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->SPIx->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Stops a stream, deselects the slave and gives back the bus
+ * @param	Stream: the stream to stop
+ * @retval	None
+ * @note	Has to be called from a task. The transfer is stopped where it is, the
+ *			byte being transferred when it's stopped is thrown away
+ */
+void SPI_StopStream(SPI_Stream* Stream)
+{
+	SPI_Device* SPIDevice = Stream->Slave->SPIDevice;
+
+	taskENTER_CRITICAL();
+	prvStopDMA(SPIDevice);
+	SPIDevice->activeStream = 0;
+	taskEXIT_CRITICAL();
+
+	/* Let the last byte finish before the chip select goes high */
+	while (SPIDevice->SPIx->SR & SPI_SR_BSY);
+	(void)SPIDevice->SPIx->DR;
+
+	SPI_Deselect(Stream->Slave);
 }
 
 /* Interrupt Handlers --------------------------------------------------------*/
+/**
+ * @brief	Interrupt handler for SPIx
+ * @param	SPIDevice: the device the interrupt is for
+ * @retval	None
+ * @note	Streams the bytes of an interrupt driven transfer and wakes up the
+ *			waiting task when the last byte has been received
+ */
 void SPI_Interrupt(SPI_Device* SPIDevice)
 {
-	/* Transmit buffer empty interrupt */
-	if (SPI_I2S_GetITStatus(SPIDevice->SPIx, SPI_I2S_IT_TXE) != RESET)
+	SPI_TypeDef* SPIx = SPIDevice->SPIx;
+	if (!(SPIx->CR2 & SPI_CR2_RXNEIE) || !(SPIx->SR & SPI_SR_RXNE))
+		return;
+	SPI_COUNT(SPIDevice, spiInterrupts, 1);
+
+	/* Reading DR clears RXNE */
+	uint8_t receivedByte = (uint8_t)SPIx->DR;
+	if (SPIDevice->irqRxData != 0)
+		*SPIDevice->irqRxData++ = receivedByte;
+
+	if (--SPIDevice->irqCount != 0)
+	{
+		if (SPIDevice->irqTxData != 0)
+			SPIx->DR = *SPIDevice->irqTxData++;
+		else
+			SPIx->DR = SPIDevice->irqFillByte;
+	}
+	else
 	{
-		/* Release the semaphore */
-		xSemaphoreGiveFromISR(SPIDevice->xTxSemaphore, NULL);
+		SPIx->CR2 &= ~SPI_CR2_RXNEIE;
 
-		/* Disable SPI_MASTER TXE interrupt */
-		SPI_I2S_ITConfig(SPIDevice->SPIx, SPI_I2S_IT_TXE, DISABLE);
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		xSemaphoreGiveFromISR(SPIDevice->xTransferSemaphore, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 	}
-	/* Receive buffer not empty interrupt */
-	else if (SPI_I2S_GetITStatus(SPIDevice->SPIx, SPI_I2S_IT_RXNE) != RESET)
+}
+
+/**
+ * @brief	Interrupt handler for the DMA RX channel of SPIx
+ * @param	SPIDevice: the device the interrupt is for
+ * @retval	None
+ */
+void SPI_DMAInterrupt(SPI_Device* SPIDevice)
+{
+	SPI_Stream* stream = SPIDevice->activeStream;
+	if (stream != 0)
+	{
+		prvStreamInterrupt(SPIDevice, stream);
+		return;
+	}
+
+	if (DMA_GetITStatus(SPIDevice->DMA_RxCompleteIT) != RESET)
 	{
-		/* Release the semaphore */
-		xSemaphoreGiveFromISR(SPIDevice->xRxSemaphore, NULL);
+		prvStopDMA(SPIDevice);
+		SPI_COUNT(SPIDevice, dmaInterrupts, 1);
+
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		SPI_Transaction* transaction = SPIDevice->activeTransaction;
+		/* Continue with the next segment under the same chip select */
+		if (transaction != 0 && transaction->Segments != 0 && prvStartNextSegment(SPIDevice, transaction))
+			return;
+
+		if (transaction != 0)
+		{
+			transaction->Slave->CS_GPIO->BSRR = transaction->Slave->CS_Pin;
+			SPIDevice->activeTransaction = 0;
+			TIMING_STOP(SPIDevice, transferTime, SPIDevice->transactionStart);
+
+			/* Start the next transaction before the callbacks to keep the bus busy */
+			SPI_Transaction* next = transaction->next;
+			SPIDevice->queueHead = next;
+			if (next != 0)
+				prvStartTransaction(SPIDevice, next);
+			else
+			{
+				SPIDevice->queueTail = 0;
+				xSemaphoreGiveFromISR(SPIDevice->xBusSemaphore, &xHigherPriorityTaskWoken);
+			}
+
+			transaction->Done = 1;
+			if (transaction->Callback != 0)
+				transaction->Callback(transaction, &xHigherPriorityTaskWoken);
+			if (transaction->NotifyTask != 0)
+				vTaskNotifyGiveFromISR(transaction->NotifyTask, &xHigherPriorityTaskWoken);
+		}
+		else
+			xSemaphoreGiveFromISR(SPIDevice->xTransferSemaphore, &xHigherPriorityTaskWoken);
 
-		/* Read the byte received in order to clear the interrupt flag */
-		SPIDevice->receivedByte = SPI_I2S_ReceiveData(SPIDevice->SPIx);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 	}
 }
@@ -2,9 +2,35 @@
  ******************************************************************************
  * @file	spi.h
  * @author	Hampus Sandberg
- * @version	0.1
- * @date	2014-05-04
- * @brief	Manage SPI
+ * @version	0.2
+ * @date	2014-11-16
+ * @brief	Manage SPI. How a transfer is done depends on its length:
+ *			- Up to PollMaxLength bytes the CPU polls TXE/RXNE, as it's done
+ *			  before a task switch would be
+ *			- Shorter than DMAMinLength bytes the SPI interrupt streams the
+ *			  bytes and the task is woken up once
+ *			- Longer transfers are done with DMA
+ *			The thresholds are per SPI_Device and can be changed at runtime with
+ *			SPI_SetThresholds() or measured on the board with SPI_Calibrate().
+ *
+ *			Several slaves can share one SPI_Device. Each SPI_Slave has its own
+ *			chip select pin, clock prescaler and clock mode, and a slave is
+ *			selected with SPI_Select() which takes the bus. CR1 is only
+ *			reprogrammed when a different slave than last time is selected.
+ *
+ *			SPI_Submit() queues an SPI_Transaction and returns immediately. The
+ *			queued transactions are done back to back with DMA from the DMA
+ *			interrupt, which calls the callback and/or notifies the task of
+ *			each transaction when it's done.
+ *
+ *			A transfer can also be described as a list of SPI_Segment, e.g. a
+ *			command header, the payload and padding, which are transferred
+ *			back to back under one chip select without copying them together.
+ *
+ *			SPI_StartStream() transfers an SPI_Stream continuously with circular
+ *			DMA until SPI_StopStream(). The buffers are split in two halves and
+ *			the callback is called when a half is done, so it can be processed
+ *			while the other half is transferred
  ******************************************************************************
  */
 
@@ -15,26 +41,221 @@
 /* Includes ------------------------------------------------------------------*/
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 #include "stm32f10x.h"
 
 /* Defines -------------------------------------------------------------------*/
+#define SPI_DUMMY_BYTE	(0xFF)	/* Byte written when a transfer has no TX data */
+
+#ifndef SPI_POLL_MAX_LENGTH
+#define SPI_POLL_MAX_LENGTH	(2)		/* Default for transfers that are polled */
+#endif
+
+#ifndef SPI_DMA_MIN_LENGTH
+#define SPI_DMA_MIN_LENGTH	(8)		/* Default for transfers that are done with DMA */
+#endif
+
+#define SPI_CALIBRATION_MAX_LENGTH	(32)	/* Longest transfer measured by SPI_Calibrate */
+
+#ifndef SPI_CPU_CLOCK_HZ
+#define SPI_CPU_CLOCK_HZ	(72000000)	/* Core clock, used for the chip select high time in SPI_Reselect */
+#endif
+
+/*
+ * Define SPI_STATISTICS to count transfers, bytes, chip selects and interrupts
+ * for every bus. Use it to check which transfer modes the drivers end up using
+ * and how much interrupt load they cause. Define SPI_TIMING as well to also
+ * measure how long transfers take and how long tasks wait for the bus, by
+ * default with the DWT cycle counter. Define SPI_CYCLE_COUNTER() to use
+ * another clock, e.g. a simulated one. The statistics are written with the
+ * FreeRTOS outstream, so freertos-compatible has to come before the root of
+ * the repository on the include path, where the bare-metal one is
+ */
+#if defined(SPI_TIMING) && !defined(SPI_STATISTICS)
+#define SPI_STATISTICS
+#endif
+
+#if defined(SPI_STATISTICS)
+#include "outstream/outstream.h"
+#define SPI_COUNT(DEVICE, FIELD, AMOUNT)	((DEVICE)->statistics.FIELD += (AMOUNT))
+#else
+#define SPI_COUNT(DEVICE, FIELD, AMOUNT)
+#endif
+
+#if defined(SPI_TIMING) && !defined(SPI_CYCLE_COUNTER)
+#define SPI_CYCLE_COUNTER()		(DWT->CYCCNT)
+#define SPI_CYCLE_COUNTER_DWT
+#endif
+
+#define SPI_HISTOGRAM_BUCKETS	(16)	/* Bucket 0 is below 32 cycles, bucket n is below 32 << n cycles and the last one is the rest */
+
 /* Typedefs ------------------------------------------------------------------*/
+typedef enum
+{
+	SPI_TransferMode_Polled,
+	SPI_TransferMode_Interrupt,
+	SPI_TransferMode_DMA,
+} SPI_TransferMode;
+
+#if defined(SPI_TIMING)
+/**
+ * @brief  Measured durations of one kind, in cycles of SPI_CYCLE_COUNTER()
+ */
+typedef struct
+{
+	uint32_t count;								/* Number of durations measured */
+	uint32_t totalCycles;						/* Sum of all durations */
+	uint32_t maxCycles;							/* The longest duration */
+	uint32_t histogram[SPI_HISTOGRAM_BUCKETS];	/* Number of durations in each bucket */
+} SPI_Timing;
+#endif
+
+#if defined(SPI_STATISTICS)
+/**
+ * @brief  Statistics for an SPI bus
+ */
+typedef struct
+{
+	uint32_t transfers[3];		/* Number of transfers started in each SPI_TransferMode */
+	uint32_t bytes[3];			/* Number of bytes transferred in each SPI_TransferMode */
+	uint32_t timeouts;			/* Number of blocking transfers that were stopped after a timeout */
+	uint32_t selects;			/* Number of times a chip select was pulled low */
+	uint32_t slaveSwitches;		/* Number of times CR1 was rewritten for another slave */
+	uint32_t spiInterrupts;		/* Number of SPI interrupts handled */
+	uint32_t dmaInterrupts;		/* Number of DMA transfer complete interrupts handled */
+#if defined(SPI_TIMING)
+	SPI_Timing transferTime;	/* From start to done for blocking transfers and queued transactions */
+	SPI_Timing busWaitTime;		/* How long SPI_Select and SPI_StartStream waited for the bus */
+#endif
+} SPI_Statistics;
+#endif
+
+typedef struct SPI_Slave SPI_Slave;
+typedef struct SPI_Transaction SPI_Transaction;
+typedef struct SPI_Stream SPI_Stream;
+
+/* Called from the DMA interrupt when a transaction is done, can not submit new transactions */
+typedef void (*SPI_TransactionCallback)(SPI_Transaction* Transaction, BaseType_t* pxHigherPriorityTaskWoken);
+
+/* Called from the DMA interrupt when Half (0 or 1) of the stream buffers has been transferred */
+typedef void (*SPI_StreamCallback)(SPI_Stream* Stream, uint8_t Half, BaseType_t* pxHigherPriorityTaskWoken);
+
 typedef struct
 {
 	uint8_t SPI_Channel;		/* Channel for the SPI periperal */
 	SPI_TypeDef* SPIx;			/* SPI peripheral to use */
 
-	uint8_t receivedByte;
+	uint8_t dummyByte;			/* Where the RX data ends up when a transfer has no RX buffer */
+
+	uint16_t PollMaxLength;		/* Transfers up to this length are polled */
+	uint16_t DMAMinLength;		/* Transfers from this length are done with DMA, the ones in between by the SPI interrupt */
+
+	DMA_Channel_TypeDef* DMA_RxChannel;	/* DMA channel for SPIx_RX, set by SPI_InitWithStructure */
+	DMA_Channel_TypeDef* DMA_TxChannel;	/* DMA channel for SPIx_TX, set by SPI_InitWithStructure */
+	uint32_t DMA_RxCompleteIT;			/* Transfer complete interrupt for the RX channel */
+	uint32_t DMA_RxHalfIT;				/* Half transfer interrupt for the RX channel */
+	uint32_t DMA_RxGlobalIT;			/* Global interrupt for the RX channel */
+	uint32_t DMA_TxGlobalIT;			/* Global interrupt for the TX channel */
+
+	const uint8_t* irqTxData;			/* Next byte to write in an interrupt driven transfer, NULL for dummy bytes */
+	uint8_t* irqRxData;					/* Where to store the next received byte, NULL to throw it away */
+	uint8_t irqFillByte;				/* Byte to write when irqTxData is NULL */
+	volatile uint16_t irqCount;			/* Bytes left to receive in an interrupt driven transfer */
 
-	SemaphoreHandle_t xTxSemaphore;
-	SemaphoreHandle_t xRxSemaphore;
+	SemaphoreHandle_t xTransferSemaphore;	/* Given when a DMA transfer is done */
+	SemaphoreHandle_t xBusSemaphore;		/* Taken by the slave that has selected the bus, or by the queue */
+	SPI_Slave* activeSlave;					/* The slave that CR1 is configured for */
+
+	SPI_Transaction* queueHead;				/* The transaction in progress, NULL when the queue is idle */
+	SPI_Transaction* queueTail;				/* The last submitted transaction */
+	SPI_Transaction* activeTransaction;		/* Set while a queued transaction is transferred */
+	SPI_Stream* activeStream;				/* Set while a stream is running */
+
+	uint8_t Initialized;		/* Set once SPI_InitWithStructure has been done */
+#if defined(SPI_STATISTICS)
+	SPI_Statistics statistics;	/* Counters, see SPI_GetStatistics */
+#endif
+#if defined(SPI_TIMING)
+	uint32_t transactionStart;	/* SPI_CYCLE_COUNTER() when the active queued transaction was started */
+#endif
 } SPI_Device;
 
+struct SPI_Slave
+{
+	SPI_Device* SPIDevice;			/* The bus the slave is connected to */
+	GPIO_TypeDef* CS_GPIO;			/* Chip select port */
+	uint16_t CS_Pin;				/* Chip select pin, active low */
+	uint16_t BaudRatePrescaler;		/* SPI_BaudRatePrescaler_x for the max clock of the slave */
+	uint16_t CPOL;					/* SPI_CPOL_x */
+	uint16_t CPHA;					/* SPI_CPHA_x */
+	uint16_t CS_HighTime;			/* Shortest time in ns chip select has to be high between two commands, for SPI_Reselect */
+
+	uint16_t cr1;					/* CR1 for the slave, calculated by SPI_SlaveInit */
+};
+
+typedef struct
+{
+	const uint8_t* TxData;				/* Data to write, NULL to write FillByte Length times */
+	uint8_t* RxData;					/* Where to store the received data, NULL to throw it away */
+	uint16_t Length;					/* Number of bytes in the segment, can be 0 */
+	uint8_t FillByte;					/* Byte to write when TxData is NULL */
+} SPI_Segment;
+
+struct SPI_Transaction
+{
+	SPI_Slave* Slave;					/* The slave to do the transaction with */
+	const uint8_t* TxData;				/* Data to write, NULL for SPI_DUMMY_BYTE */
+	uint8_t* RxData;					/* Where to store the received data, NULL to throw it away */
+	uint16_t Length;					/* Number of bytes to transfer, has to be at least 1 */
+	const SPI_Segment* Segments;		/* Transfer these segments instead of TxData/RxData/Length if not NULL */
+	uint8_t SegmentCount;				/* Number of segments in Segments */
+	SPI_TransactionCallback Callback;	/* Called when done, can be NULL */
+	TaskHandle_t NotifyTask;			/* Task to notify with vTaskNotifyGiveFromISR when done, can be NULL */
+	void* Context;						/* Free for the submitter to use */
+
+	volatile uint8_t Done;				/* Set when the transaction is done */
+	uint8_t segmentIndex;				/* The segment being transferred */
+	SPI_Transaction* next;				/* Next transaction in the queue */
+};
+
+struct SPI_Stream
+{
+	SPI_Slave* Slave;					/* The slave to stream data with, selected until the stream is stopped */
+	const uint8_t* TxData;				/* 2 * HalfLength bytes written over and over, NULL for SPI_DUMMY_BYTE */
+	uint8_t* RxData;					/* 2 * HalfLength bytes where the received data is stored, NULL to throw it away */
+	uint16_t HalfLength;				/* Number of bytes in each half of the buffers, has to be at least 1 */
+	SPI_StreamCallback Callback;		/* Called when a half is done, has to be set */
+	void* Context;						/* Free for the application to use */
+
+	volatile uint32_t Overruns;			/* Number of times both halves were done before the interrupt was handled */
+};
+
 /* Function prototypes -------------------------------------------------------*/
 void SPI_Device_Init(SPI_Device* SPIDevice);
 void SPI_InitWithStructure(SPI_Device* SPIDevice, SPI_InitTypeDef* SPI_InitStructure);
 uint8_t SPI_WriteRead(SPI_Device* SPIDevice, uint8_t Data);
+ErrorStatus SPI_Transfer(SPI_Device* SPIDevice, const uint8_t* TxData, uint8_t* RxData, uint16_t Length, TickType_t Timeout);
+void SPI_SetThresholds(SPI_Device* SPIDevice, uint16_t PollMaxLength, uint16_t DMAMinLength);
+SPI_TransferMode SPI_GetTransferMode(SPI_Device* SPIDevice, uint16_t Length);
+void SPI_Calibrate(SPI_Slave* Slave);
+#if defined(SPI_STATISTICS)
+void SPI_GetStatistics(SPI_Device* SPIDevice, SPI_Statistics* Statistics);
+void SPI_ResetStatistics(SPI_Device* SPIDevice);
+void SPI_DumpStatistics(SPI_Device* SPIDevice, const char* Name, OUT_Device* OutDevice);
+#endif
+ErrorStatus SPI_TransferSegments(SPI_Device* SPIDevice, const SPI_Segment* Segments, uint8_t SegmentCount, TickType_t Timeout);
+
+void SPI_SlaveInit(SPI_Slave* Slave);
+ErrorStatus SPI_Select(SPI_Slave* Slave, TickType_t Timeout);
+void SPI_Deselect(SPI_Slave* Slave);
+void SPI_Reselect(SPI_Slave* Slave);
+ErrorStatus SPI_SlaveTransfer(SPI_Slave* Slave, const uint8_t* TxData, uint8_t* RxData, uint16_t Length, TickType_t Timeout);
+ErrorStatus SPI_SlaveTransferSegments(SPI_Slave* Slave, const SPI_Segment* Segments, uint8_t SegmentCount, TickType_t Timeout);
+ErrorStatus SPI_Submit(SPI_Transaction* Transaction);
+ErrorStatus SPI_StartStream(SPI_Stream* Stream, TickType_t Timeout);
+void SPI_StopStream(SPI_Stream* Stream);
 
 void SPI_Interrupt(SPI_Device* SPIDevice);
+void SPI_DMAInterrupt(SPI_Device* SPIDevice);
 
 #endif /* SPI_H_ */
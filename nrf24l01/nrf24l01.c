@@ -42,6 +42,7 @@ TODO:
 #define IsValidPipe(PIPE)				((PIPE) < 6)
 #define GetPipeNumber(DEVICE) 			(((NRF24L01_GetStatus(DEVICE)) & 0xF) >> 1)
 #define GetPipeFromStatus(THE_STATUS) 	(((THE_STATUS) & 0xF) >> 1)
+#define IsValidPayloadWidth(WIDTH)		((WIDTH) != 0 && (WIDTH) <= PAYLOAD_SIZE)	/* Anything else from R_RX_PL_WID is corrupt */
 
 #define DEFAULT_CHANNEL		66
 
@@ -53,14 +54,62 @@ TODO:
 
 #define MAX_PIPES			6
 
+/*
+ * Define NRF24L01_SPI_INLINE to let the driver access the SPI registers of
+ * Device->SPIx directly instead of calling SPIx_WriteRead/SPIx_Write through
+ * the function pointers. Every byte then compiles to an inline SR/DR sequence.
+ * Also define NRF24L01_SPIx(DEVICE) as e.g. (SPI1) when all devices in the
+ * build share one peripheral so its address is a constant
+ */
+#if defined(NRF24L01_SPI_INLINE)
+#if !defined(NRF24L01_SPIx)
+#define NRF24L01_SPIx(DEVICE)			((DEVICE)->SPIx)
+#endif
+#define SPI_WRITE_READ(DEVICE, DATA)	prvSpiWriteRead(NRF24L01_SPIx(DEVICE), DATA)
+#define SPI_WRITE(DEVICE, DATA)			prvSpiWrite(NRF24L01_SPIx(DEVICE), DATA)
+#else
+#define SPI_WRITE_READ(DEVICE, DATA)	((DEVICE)->SPIx_WriteRead(DATA))
+#define SPI_WRITE(DEVICE, DATA)			((DEVICE)->SPIx_Write(DATA))
+#endif
+
 
 /* Private variables ---------------------------------------------------------*/
 /* Private Function Prototypes -----------------------------------------------*/
 static void enableRf(NRF24L01_Device* Device) { GPIO_SetBits(Device->CE_GPIO, Device->CE_Pin); }
 static void disableRf(NRF24L01_Device* Device) { GPIO_ResetBits(Device->CE_GPIO, Device->CE_Pin); }
 
-static void selectNrf24l01(NRF24L01_Device* Device) { GPIO_ResetBits(Device->CSN_GPIO, Device->CSN_Pin); }
+static void selectNrf24l01(NRF24L01_Device* Device);
 static void deselectNrf24l01(NRF24L01_Device* Device) { GPIO_SetBits(Device->CSN_GPIO, Device->CSN_Pin); }
+static Boolean claimDMA(NRF24L01_Device* Device);
+static Boolean deferInterrupt(NRF24L01_Device* Device);
+
+#if defined(NRF24L01_SPI_INLINE)
+/**
+ * @brief	Writes and receives a byte, same as SPI1_WriteRead
+ * @param	SPIx: the SPI peripheral to use
+ * @param	Data: data to be written to the SPI
+ * @retval	The received data
+ */
+static inline uint8_t prvSpiWriteRead(SPI_TypeDef* SPIx, uint8_t Data)
+{
+	while ((SPIx->SR & SPI_I2S_FLAG_TXE) == RESET);
+	SPIx->DR = Data;
+	while ((SPIx->SR & SPI_I2S_FLAG_RXNE) == RESET);
+	return SPIx->DR;
+}
+
+/**
+ * @brief	Writes a byte without waiting for the received byte, same as SPI1_Write
+ * @param	SPIx: the SPI peripheral to use
+ * @param	Data: data to be written to the SPI
+ * @retval	None
+ */
+static inline void prvSpiWrite(SPI_TypeDef* SPIx, uint8_t Data)
+{
+	while ((SPIx->SR & SPI_I2S_FLAG_TXE) == RESET);
+	SPIx->DR = Data;
+}
+#endif
 
 static void writeRegisterOneByte(NRF24L01_Device* Device, uint8_t Register, uint8_t Data);
 static void prvReadRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Storage, uint8_t ByteCount);
@@ -69,8 +118,16 @@ static void writeRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t * D
 static void flushTX(NRF24L01_Device* Device);
 static void flushRX(NRF24L01_Device* Device);
 static void resetToRx(NRF24L01_Device* Device);
-
-static uint8_t getData(NRF24L01_Device* Device, uint8_t* Storage);
+static void enableDynamicPayloadLength(NRF24L01_Device* Device);
+static uint8_t getPayloadWidth(NRF24L01_Device* Device);
+
+static void readPayloads(NRF24L01_Device* Device, uint8_t Pipe);
+static Boolean startReadPayload(NRF24L01_Device* Device, uint8_t Pipe, uint8_t Width);
+static void readPayload(NRF24L01_Device* Device, uint8_t* Payload, uint8_t Width);
+static void storePayload(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* Payload, uint8_t Width);
+static void storeData(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* Data, uint8_t DataCount);
+static void writePayloadDone(void* Context);
+static void readPayloadDone(void* Context);
 static uint8_t dataReady(NRF24L01_Device* Device);
 
 static void powerUpRx(NRF24L01_Device* Device);
@@ -86,9 +143,11 @@ static void powerUpTx(NRF24L01_Device* Device);
 void NRF24L01_Init(NRF24L01_Device* Device)
 {
 	Device->ChecksumErrors = 0;
+	Device->DMABusy = False;
+	Device->PendingInterrupt = False;
 	
 	uint8_t i;
-	for (i = 0; i < MAX_PIPES; i++) { circularBuffer_Init(&Device->RxPipeBuffer[i]); }
+	for (i = 0; i < MAX_PIPES; i++) { NRF24L01_PipeBuffer_Init(&Device->RxPipeBuffer[i]); }
 	
 	GPIO_InitTypeDef GPIO_InitStructure;
 
@@ -161,6 +220,9 @@ void NRF24L01_Init(NRF24L01_Device* Device)
 	writeRegisterOneByte(Device, RX_PW_P3, PAYLOAD_SIZE);
 	writeRegisterOneByte(Device, RX_PW_P4, PAYLOAD_SIZE);
 	writeRegisterOneByte(Device, RX_PW_P5, PAYLOAD_SIZE);
+
+	/* RX_PW_Px is ignored for pipes with dynamic payload length */
+	if (Device->DynamicPayloadLength) enableDynamicPayloadLength(Device);
 	
 	// Enable all RX pipes
 	NRF24L01_EnablePipes(Device, ALL_PIPES);
@@ -211,12 +273,21 @@ void NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataC
 	flushTX(Device);
     
     selectNrf24l01(Device);
-    Device->SPIx_Write(W_TX_PAYLOAD);
-	Device->SPIx_Write(DataCount);	// Write data count
+    SPI_WRITE(Device, W_TX_PAYLOAD);
 	uint8_t i;
-	for (i = 0; i < DataCount; i++) Device->SPIx_Write(Data[i]);		// Write data
-	Device->SPIx_Write(checksum);	// Write checksum
-	for (i++; i <= MAX_DATA_COUNT; i++) Device->SPIx_Write(PAYLOAD_FILLER_DATA);	// Fill the rest of the payload
+	if (Device->DynamicPayloadLength)
+	{
+		/* The receiver gets the length from the payload width */
+		for (i = 0; i < DataCount; i++) SPI_WRITE(Device, Data[i]);		// Write data
+		SPI_WRITE(Device, checksum);	// Write checksum
+	}
+	else
+	{
+		SPI_WRITE(Device, DataCount);	// Write data count
+		for (i = 0; i < DataCount; i++) SPI_WRITE(Device, Data[i]);		// Write data
+		SPI_WRITE(Device, checksum);	// Write checksum
+		for (i++; i <= MAX_DATA_COUNT; i++) SPI_WRITE(Device, PAYLOAD_FILLER_DATA);	// Fill the rest of the payload
+	}
     deselectNrf24l01(Device);
     
     enableRf(Device);
@@ -268,6 +339,80 @@ void NRF24L01_Write(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount)
 }
 
 
+/**
+ * @brief	Starts writing a payload with DMA and returns without waiting for the SPI transfer
+ * @param	Device: The device to use
+ * @param	Data: Pointer to where the data is stored, copied before returning
+ * @param	DataCount: The number of bytes in Data
+ * @retval	SUCCESS if the payload is being written, ERROR if the device has no DMA,
+ *			is busy or is still sending the last payload
+ * @note	Devices on different SPI peripherals can transfer at the same time, e.g.
+ *			one can load its TX FIFO while the other one is read
+ */
+ErrorStatus NRF24L01_StartWritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount)
+{
+	if (DataCount > MAX_DATA_COUNT || Device->SPIx_TransferDMA == 0 || Device->DMABusy || Device->InTxMode)
+		return ERROR;
+
+	disableRf(Device);
+	powerUpTx(Device);
+	flushTX(Device);
+
+	/* DMABuffer is only filled once the bus is claimed, a transfer started by NRF24L01_Interrupt may be using it */
+	if (!claimDMA(Device))
+	{
+		/* Back to RX mode as before the call, the flags belong to the running transfer */
+		Device->InTxMode = False;
+		RxPowerup(Device);
+		enableRf(Device);
+		return ERROR;
+	}
+
+	/* Same payload as NRF24L01_WritePayload: data count, data, checksum and filler */
+	uint8_t* buffer = Device->DMABuffer;
+	uint8_t length = PAYLOAD_SIZE + 1;
+	uint8_t i;
+	buffer[0] = W_TX_PAYLOAD;
+	if (Device->DynamicPayloadLength)
+	{
+		/* Only data and checksum */
+		for (i = 0; i < DataCount; i++) buffer[1 + i] = Data[i];
+		buffer[1 + i] = NRF24L01_GetChecksum(Device, Data, DataCount);
+		length = DataCount + 2;
+	}
+	else
+	{
+		buffer[1] = DataCount;
+		for (i = 0; i < DataCount; i++) buffer[2 + i] = Data[i];
+		buffer[2 + i] = NRF24L01_GetChecksum(Device, Data, DataCount);
+		for (i++; i <= MAX_DATA_COUNT; i++) buffer[2 + i] = PAYLOAD_FILLER_DATA;
+	}
+
+	/* The bus is claimed, select without waiting for DMABusy */
+	GPIO_ResetBits(Device->CSN_GPIO, Device->CSN_Pin);
+	if (Device->SPIx_TransferDMA(buffer, 0, length, writePayloadDone, Device) != SUCCESS)
+	{
+		deselectNrf24l01(Device);
+		Device->DMABusy = False;
+		Device->InTxMode = False;
+		RxPowerup(Device);
+		enableRf(Device);
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Checks if a DMA transfer is in progress on the device
+ * @param	Device: The device to use
+ * @retval	True if the device is busy, False otherwise
+ * @note	The blocking functions wait until this is False before they use the bus
+ */
+Boolean NRF24L01_IsBusy(NRF24L01_Device* Device)
+{
+	return Device->DMABusy;
+}
+
 /**
  * @brief	Set the address for the different RX pipes on the nRF24L01
  * @param	Device: The device to use
@@ -281,12 +426,12 @@ uint8_t NRF24L01_SetRxPipeAddressSeparated(NRF24L01_Device* Device, uint8_t Pipe
 	if (Pipe <= 1)
 	{
 		selectNrf24l01(Device);
-		uint8_t status = Device->SPIx_WriteRead(W_REGISTER | (RX_ADDR_P0 + Pipe));
-		Device->SPIx_Write(AddressLSByte);
+		uint8_t status = SPI_WRITE_READ(Device, W_REGISTER | (RX_ADDR_P0 + Pipe));
+		SPI_WRITE(Device, AddressLSByte);
 		uint8_t i;
 		for (i = 0; i < 4; i++)
 		{
-			Device->SPIx_Write((AddressMSBytes >> 8*i) & 0xFF);
+			SPI_WRITE(Device, (AddressMSBytes >> 8*i) & 0xFF);
 		}
 		deselectNrf24l01(Device);
 		
@@ -295,8 +440,8 @@ uint8_t NRF24L01_SetRxPipeAddressSeparated(NRF24L01_Device* Device, uint8_t Pipe
 	else if (IsValidPipe(Pipe))
 	{
 		selectNrf24l01(Device);
-		uint8_t status = Device->SPIx_WriteRead(W_REGISTER | (RX_ADDR_P0 + Pipe));
-		Device->SPIx_Write(AddressLSByte);	// MSByte of address in pipe 2 to 5 is equal to RX_ADDR_P1[39:8]
+		uint8_t status = SPI_WRITE_READ(Device, W_REGISTER | (RX_ADDR_P0 + Pipe));
+		SPI_WRITE(Device, AddressLSByte);	// MSByte of address in pipe 2 to 5 is equal to RX_ADDR_P1[39:8]
 		deselectNrf24l01(Device);
 		
 		return status;
@@ -314,12 +459,12 @@ uint8_t NRF24L01_SetRxPipeAddressSeparated(NRF24L01_Device* Device, uint8_t Pipe
 uint8_t NRF24L01_SetTxAddressSeparated(NRF24L01_Device* Device, uint32_t AddressMSBytes, uint8_t AddressLSByte)
 {
 	selectNrf24l01(Device);
-	uint8_t status = Device->SPIx_WriteRead(W_REGISTER | TX_ADDR);
-	Device->SPIx_WriteRead(AddressLSByte);
+	uint8_t status = SPI_WRITE_READ(Device, W_REGISTER | TX_ADDR);
+	SPI_WRITE_READ(Device, AddressLSByte);
 	uint8_t i;
 	for (i = 0; i < 4; i++)
 	{
-		Device->SPIx_WriteRead((AddressMSBytes >> 8*i) & 0xFF);
+		SPI_WRITE_READ(Device, (AddressMSBytes >> 8*i) & 0xFF);
 	}
 	deselectNrf24l01(Device);
 	
@@ -338,8 +483,8 @@ uint8_t NRF24L01_SetRFChannel(NRF24L01_Device* Device, uint8_t Channel)
 	if (Channel <= 125)
 	{
 		selectNrf24l01(Device);
-		Device->SPIx_WriteRead(W_REGISTER | RF_CH);
-		Device->SPIx_WriteRead(Channel);
+		SPI_WRITE_READ(Device, W_REGISTER | RF_CH);
+		SPI_WRITE_READ(Device, Channel);
 		deselectNrf24l01(Device);
 
 		return 1;
@@ -356,7 +501,7 @@ uint8_t NRF24L01_SetRFChannel(NRF24L01_Device* Device, uint8_t Channel)
 uint8_t NRF24L01_GetStatus(NRF24L01_Device* Device)
 {
 	selectNrf24l01(Device);
-	uint8_t status = Device->SPIx_WriteRead(0);
+	uint8_t status = SPI_WRITE_READ(Device, 0);
 	deselectNrf24l01(Device);
 	
 	return status;
@@ -445,7 +590,7 @@ uint8_t NRF24L01_GetAvailableDataForPipe(NRF24L01_Device* Device, uint8_t Pipe)
 {
 	if (IsValidPipe(Pipe))
 	{
-		return circularBuffer_GetCount(&Device->RxPipeBuffer[Pipe]);
+		return NRF24L01_PipeBuffer_GetCount(&Device->RxPipeBuffer[Pipe]);
 	}
 	return 0;
 }
@@ -467,7 +612,7 @@ void NRF24L01_GetDataFromPipe(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* St
 		uint8_t i;
 		for (i = 0; i < DataCount; i++)
 		{
-			Storage[i] = circularBuffer_Remove(&Device->RxPipeBuffer[Pipe]);
+			Storage[i] = NRF24L01_PipeBuffer_Remove(&Device->RxPipeBuffer[Pipe]);
 		}
 	}
 }
@@ -690,6 +835,58 @@ void NRF24L01_WriteDebugToUart(NRF24L01_Device* Device)
 
 
 /* Private Functions ---------------------------------------------------------*/
+/**
+ * @brief	Selects the nRF24L01, waits first if a DMA transfer is using the bus
+ * @param	Device: The device to use
+ * @retval	None
+ * @note	All blocking functions select through here so they can't corrupt a DMA
+ *			transfer. The DMA functions claim the bus with claimDMA and then select
+ *			the device directly. They must not be called from an interrupt with a
+ *			higher priority than the DMA interrupt
+ */
+static void selectNrf24l01(NRF24L01_Device* Device)
+{
+	while (Device->DMABusy);
+	GPIO_ResetBits(Device->CSN_GPIO, Device->CSN_Pin);
+}
+
+/**
+ * @brief	Claims the bus for a DMA transfer
+ * @param	Device: The device to use
+ * @retval	True if the bus was claimed, False if a DMA transfer is using it
+ * @note	DMABusy is checked and set with interrupts masked, so a transfer started
+ *			from an interrupt can't claim the bus in between. Nothing is changed
+ *			when it fails. The caller selects the device after claiming it
+ */
+static Boolean claimDMA(NRF24L01_Device* Device)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Boolean claimed = !Device->DMABusy;
+	if (claimed)
+		Device->DMABusy = True;
+	__set_PRIMASK(primask);
+	return claimed;
+}
+
+/**
+ * @brief	Leaves the interrupt to the running DMA transfer if there is one
+ * @param	Device: The device to use
+ * @retval	True if a DMA transfer is using the bus, it calls NRF24L01_Interrupt when it's done
+ * @note	The done functions clear DMABusy before they check PendingInterrupt, so
+ *			both are looked at with interrupts masked for the interrupt not to be lost
+ */
+static Boolean deferInterrupt(NRF24L01_Device* Device)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Boolean busy = Device->DMABusy;
+	if (busy)
+		Device->PendingInterrupt = True;
+	__set_PRIMASK(primask);
+	return busy;
+}
+
 /**
  * @brief	Write one byte to a register in the nRF24L01
  * @param	Device: The device to use
@@ -702,8 +899,8 @@ static void writeRegisterOneByte(NRF24L01_Device* Device, uint8_t Register, uint
 	if (IS_VALID_REGISTER(Register))
 	{
 		selectNrf24l01(Device);
-		Device->SPIx_WriteRead(W_REGISTER | (REGISTER_MASK & Register));
-		Device->SPIx_WriteRead(Data);
+		SPI_WRITE_READ(Device, W_REGISTER | (REGISTER_MASK & Register));
+		SPI_WRITE_READ(Device, Data);
 		deselectNrf24l01(Device);
 	}		
 }
@@ -723,11 +920,11 @@ static void prvReadRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t*
 	{
 		uint8_t status = 0;
 		selectNrf24l01(Device);
-		status = Device->SPIx_WriteRead(R_REGISTER | Register);
+		status = SPI_WRITE_READ(Device, R_REGISTER | Register);
 		uint8_t i;
 		for (i = 0; i < ByteCount; i++)
 		{
-			Storage[i] = Device->SPIx_WriteRead(0);
+			Storage[i] = SPI_WRITE_READ(Device, 0);
 		}
 		deselectNrf24l01(Device);
 	}	
@@ -746,11 +943,11 @@ static void writeRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Da
 	if (IS_VALID_REGISTER(Register))
 	{
 		selectNrf24l01(Device);
-		Device->SPIx_Write(W_REGISTER | Register);
+		SPI_WRITE(Device, W_REGISTER | Register);
 		uint8_t i;
 		for (i = 0; i < PAYLOAD_SIZE; i++)
 		{
-			Device->SPIx_WriteRead(Data[i]);
+			SPI_WRITE_READ(Device, Data[i]);
 		}
 		deselectNrf24l01(Device);
 	}	
@@ -764,7 +961,7 @@ static void writeRegister(NRF24L01_Device* Device, uint8_t Register, uint8_t* Da
 static void flushTX(NRF24L01_Device* Device)
 {
 	selectNrf24l01(Device);
-	Device->SPIx_WriteRead(FLUSH_TX);
+	SPI_WRITE_READ(Device, FLUSH_TX);
 	deselectNrf24l01(Device);
 }
 
@@ -776,7 +973,7 @@ static void flushTX(NRF24L01_Device* Device)
 static void flushRX(NRF24L01_Device* Device)
 {
 	selectNrf24l01(Device);
-	Device->SPIx_WriteRead(FLUSH_RX);
+	SPI_WRITE_READ(Device, FLUSH_RX);
 	deselectNrf24l01(Device);
 }
 
@@ -796,28 +993,223 @@ static void resetToRx(NRF24L01_Device* Device)
 }
 
 /**
- * @brief	Gets data from the RX buffer
+ * @brief	Enables dynamic payload length on all pipes
  * @param	Device: The device to use
- * @param	Storage: Pointer to where the data should be stored
- * @retval	The amount of data received
- * @note	The checksum is checked here and if it doesn't match it will return 0 as
- *			the amount of data
+ * @retval	None
+ * @note	The nRF24L01 (non plus) ignores writes to FEATURE and DYNPD until
+ *			ACTIVATE has been sent, the nRF24L01+ doesn't need it
+ */
+static void enableDynamicPayloadLength(NRF24L01_Device* Device)
+{
+	uint8_t feature = 0;
+	writeRegisterOneByte(Device, FEATURE, (1 << EN_DPL));
+	prvReadRegister(Device, FEATURE, &feature, 1);
+	if (feature != (1 << EN_DPL))
+	{
+		selectNrf24l01(Device);
+		SPI_WRITE_READ(Device, ACTIVATE);
+		SPI_WRITE_READ(Device, ACTIVATE_FEATURES);
+		deselectNrf24l01(Device);
+		writeRegisterOneByte(Device, FEATURE, (1 << EN_DPL));
+	}
+	writeRegisterOneByte(Device, DYNPD, ALL_PIPES);
+}
+
+/**
+ * @brief	Gets the width of the payload at the top of the RX FIFO
+ * @param	Device: The device to use
+ * @retval	The width of the payload, 0 or more than PAYLOAD_SIZE if it is corrupt
  */
-static uint8_t getData(NRF24L01_Device* Device, uint8_t* Storage)
-{	
+static uint8_t getPayloadWidth(NRF24L01_Device* Device)
+{
 	selectNrf24l01(Device);
-	Device->SPIx_WriteRead(R_RX_PAYLOAD);
-	uint8_t dataCount = Device->SPIx_WriteRead(PAYLOAD_FILLER_DATA);
+	SPI_WRITE_READ(Device, R_RX_PL_WID);
+	uint8_t width = SPI_WRITE_READ(Device, PAYLOAD_FILLER_DATA);
+	deselectNrf24l01(Device);
+	return width;
+}
+
+/**
+ * @brief	Reads the payloads in the RX FIFO until RX_P_NO says it's empty
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe of the payload at the top of the RX FIFO
+ * @retval	None
+ * @note	Only a corrupt width flushes the RX FIFO, it's the only way to get rid of
+ *			that payload. With DMA this returns when the first payload is being read,
+ *			readPayloadDone stores it and calls this again for the next one
+ */
+static void readPayloads(NRF24L01_Device* Device, uint8_t Pipe)
+{
+	while (IsValidPipe(Pipe))
+	{
+		uint8_t width = PAYLOAD_SIZE;
+		if (Device->DynamicPayloadLength)
+		{
+			width = getPayloadWidth(Device);
+			if (!IsValidPayloadWidth(width))
+			{
+				Device->ChecksumErrors++;
+				flushRX(Device);
+				return;
+			}
+		}
+
+		if (Device->SPIx_TransferDMA != 0 && startReadPayload(Device, Pipe, width))
+			return;
+
+		uint8_t payload[PAYLOAD_SIZE];
+		readPayload(Device, payload, width);
+		storePayload(Device, Pipe, payload, width);
+		Pipe = GetPipeNumber(Device);
+	}
+}
+
+/**
+ * @brief	Starts reading the payload at the top of the RX FIFO with DMA
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe the payload was received on
+ * @param	Width: The width of the payload
+ * @retval	True if the payload is being read or a running transfer calls
+ *			NRF24L01_Interrupt when it's done, False to read it without DMA
+ */
+static Boolean startReadPayload(NRF24L01_Device* Device, uint8_t Pipe, uint8_t Width)
+{
+	while (!claimDMA(Device))
+	{
+		if (deferInterrupt(Device))
+			return True;
+	}
+
+	/* DMABuffer[0] is the command, the status is received there */
+	uint8_t* buffer = Device->DMABuffer;
+	buffer[0] = R_RX_PAYLOAD;
+	uint8_t i;
+	for (i = 1; i <= Width; i++) buffer[i] = PAYLOAD_FILLER_DATA;
+
+	Device->DMAPipe = Pipe;
+	Device->DMAPayloadWidth = Width;
+	GPIO_ResetBits(Device->CSN_GPIO, Device->CSN_Pin);
+	if (Device->SPIx_TransferDMA(buffer, buffer, Width + 1, readPayloadDone, Device) == SUCCESS)
+		return True;
+	deselectNrf24l01(Device);
+	Device->DMABusy = False;
+	return False;
+}
+
+/**
+ * @brief	Reads the payload at the top of the RX FIFO, which removes it from the FIFO
+ * @param	Device: The device to use
+ * @param	Payload: Where to store the payload
+ * @param	Width: The width of the payload, at most PAYLOAD_SIZE
+ * @retval	None
+ */
+static void readPayload(NRF24L01_Device* Device, uint8_t* Payload, uint8_t Width)
+{
+	selectNrf24l01(Device);
+	SPI_WRITE_READ(Device, R_RX_PAYLOAD);
 	uint8_t i;
-	for (i = 0; i < dataCount + 1; i++)
+	for (i = 0; i < Width; i++)
 	{
-		Storage[i] = Device->SPIx_WriteRead(PAYLOAD_FILLER_DATA);
-	}	
+		Payload[i] = SPI_WRITE_READ(Device, PAYLOAD_FILLER_DATA);
+	}
 	deselectNrf24l01(Device);
-	flushRX(Device);
-	writeRegisterOneByte(Device, STATUS, (1 << RX_DR));
-	
-	return dataCount;
+}
+
+/**
+ * @brief	Checks a received payload and stores the data in the buffer for the pipe
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe the payload was received on
+ * @param	Payload: The payload
+ * @param	Width: The width of the payload
+ * @retval	None
+ * @note	With dynamic payload length the payload is the data followed by the
+ *			checksum, otherwise the data count comes first
+ */
+static void storePayload(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* Payload, uint8_t Width)
+{
+	if (Device->DynamicPayloadLength)
+		storeData(Device, Pipe, Payload, Width - 1);
+	else
+		storeData(Device, Pipe, &Payload[1], Payload[0]);
+}
+
+/**
+ * @brief	Checks the checksum of received data and stores it in the buffer for the pipe
+ * @param	Device: The device to use
+ * @param	Pipe: The pipe the data was received on
+ * @param	Data: The received data followed by the checksum
+ * @param	DataCount: The number of data bytes
+ * @retval	None
+ */
+static void storeData(NRF24L01_Device* Device, uint8_t Pipe, uint8_t* Data, uint8_t DataCount)
+{
+	if (DataCount > MAX_DATA_COUNT)
+	{
+		Device->ChecksumErrors++;
+		return;
+	}
+
+	uint8_t receivedChecksum = Data[DataCount];
+	uint8_t calculatedChecksum = NRF24L01_GetChecksum(Device, Data, DataCount);
+
+	if (receivedChecksum == calculatedChecksum)
+	{
+		uint8_t i;
+		for (i = 0; i < DataCount; i++)
+		{
+			if (!NRF24L01_PipeBuffer_IsFull(&Device->RxPipeBuffer[Pipe]))
+				NRF24L01_PipeBuffer_Insert(&Device->RxPipeBuffer[Pipe], Data[i]);
+		}
+	}
+	else
+	{
+		// Checksum error
+		Device->ChecksumErrors++;
+	}
+}
+
+/**
+ * @brief	Called from the DMA interrupt when a payload has been written
+ * @param	Context: The device
+ * @retval	None
+ */
+static void writePayloadDone(void* Context)
+{
+	NRF24L01_Device* Device = (NRF24L01_Device*)Context;
+	deselectNrf24l01(Device);
+	enableRf(Device);
+
+	Device->DMABusy = False;
+	if (Device->PendingInterrupt)
+	{
+		Device->PendingInterrupt = False;
+		NRF24L01_Interrupt(Device);
+	}
+}
+
+/**
+ * @brief	Called from the DMA interrupt when a payload has been read
+ * @param	Context: The device
+ * @retval	None
+ */
+static void readPayloadDone(void* Context)
+{
+	NRF24L01_Device* Device = (NRF24L01_Device*)Context;
+	deselectNrf24l01(Device);
+
+	/* DMABuffer[0] is the status and the payload starts at [1] */
+	storePayload(Device, Device->DMAPipe, &Device->DMABuffer[1], Device->DMAPayloadWidth);
+
+	/* DMABuffer is done with, go on with the next payload if there is one */
+	Device->DMABusy = False;
+	readPayloads(Device, GetPipeNumber(Device));
+
+	/* The interrupt waits until the last payload has been read */
+	if (Device->PendingInterrupt && !Device->DMABusy)
+	{
+		Device->PendingInterrupt = False;
+		NRF24L01_Interrupt(Device);
+	}
 }
 
 /**
@@ -867,6 +1259,10 @@ static void powerUpTx(NRF24L01_Device* Device)
 /* Interrupt Service Routines ------------------------------------------------*/
 void NRF24L01_Interrupt(NRF24L01_Device* Device)
 {
+	/* The bus is busy with DMA, the transfer will call this again when it's done */
+	if (deferInterrupt(Device))
+		return;
+
 	uint8_t status = NRF24L01_GetStatus(Device);
 	// Data Sent TX FIFO interrupt, asserted when packet transmitted on TX.
 	if (status & (1 << TX_DS))
@@ -878,32 +1274,15 @@ void NRF24L01_Interrupt(NRF24L01_Device* Device)
 	{
 		powerUpRx(Device);
 	}
-	else if (status & (1 << RX_DR))
+	/* Also when RX_DR was cleared but the payloads are still to be read after a DMA transfer */
+	else if ((status & (1 << RX_DR)) || IsValidPipe(GetPipeFromStatus(status)))
 	{
-		uint8_t pipe = GetPipeFromStatus(status);
-		if (IsValidPipe(pipe))
-		{
-			uint8_t buffer[MAX_DATA_COUNT];
-			uint8_t availableData = getData(Device, buffer);
-
-			uint8_t receivedChecksum = buffer[availableData];
-			uint8_t calculatedChecksum = NRF24L01_GetChecksum(Device, buffer, availableData);
-
-			if (receivedChecksum == calculatedChecksum)
-			{
-				uint8_t i;
-				for (i = 0; i < availableData; i++)
-				{
-					if (!circularBuffer_IsFull(&Device->RxPipeBuffer[pipe]))
-						circularBuffer_Insert(&Device->RxPipeBuffer[pipe], buffer[i]);
-				}
-			}
-			else
-			{
-				// Checksum error
-				Device->ChecksumErrors++;
-			}
-		}
-		ResetStatusRxDr(Device);
+		/*
+		 * RX_DR is cleared first so a payload received while the FIFO is read sets it
+		 * again. The FIFO can hold more than one payload, read until RX_P_NO says it's empty
+		 */
+		if (status & (1 << RX_DR))
+			ResetStatusRxDr(Device);
+		readPayloads(Device, GetPipeFromStatus(status));
 	}
 }
@@ -26,12 +26,24 @@
 
 #define PAYLOAD_SIZE		32
 #define DATA_COUNT_INDEX	0
-#define MAX_DATA_COUNT		PAYLOAD_SIZE-2	// 1 byte datacount + 1 byte checksum
+#define MAX_DATA_COUNT		(PAYLOAD_SIZE-2)	// 1 byte datacount + 1 byte checksum
 #define PAYLOAD_FILLER_DATA	0x00
 
-#define NRF24L01_MAX_AVAILABLE_DATA	CIRCULARBUFFER_SIZE
+/*
+ * Size of the buffer for each RX pipe, has to be a power of two. The pipe
+ * buffers have their own type so they don't follow CIRCULARBUFFER_SIZE and
+ * CIRCULARBUFFER_DATATYPE, which a board may set for other buffers. The
+ * default fits two full payloads, define it in the board to change it
+ */
+#ifndef NRF24L01_PIPE_BUFFER_SIZE
+#define NRF24L01_PIPE_BUFFER_SIZE	64
+#endif
+
+#define NRF24L01_MAX_AVAILABLE_DATA	NRF24L01_PIPE_BUFFER_SIZE
 
 /* Typedefs ------------------------------------------------------------------*/
+CIRC_BUFFER_DECLARE(NRF24L01_PipeBuffer, uint8_t, NRF24L01_PIPE_BUFFER_SIZE)
+
 typedef struct
 {
 	char* NRF24L01_DeviceName;
@@ -50,10 +62,19 @@ typedef struct
 
 	SPI_TypeDef* SPIx;			/* SPI peripheral to use */
 	void (*SPIx_Init)();		/* SPI Initialization function to use */
-	uint8_t (*SPIx_WriteRead)(uint8_t);	/* SPI WriteRead function to use */
-	void (*SPIx_Write)(uint8_t);		/* SPI Write function to use */
+	uint8_t (*SPIx_WriteRead)(uint8_t);	/* SPI WriteRead function to use, not used with NRF24L01_SPI_INLINE */
+	void (*SPIx_Write)(uint8_t);		/* SPI Write function to use, not used with NRF24L01_SPI_INLINE */
+	ErrorStatus (*SPIx_TransferDMA)(const uint8_t*, uint8_t*, uint16_t, void (*)(void*), void*);	/* Optional non-blocking DMA transfer, NULL to only use the blocking functions */
+
+	uint8_t DMABuffer[PAYLOAD_SIZE + 1];	/* Command and payload for the DMA transfer in progress */
+	volatile Boolean DMABusy;			/* True while a DMA transfer is in progress, the SPI bus must not be used then */
+	volatile Boolean PendingInterrupt;	/* True if NRF24L01_Interrupt was called during a DMA transfer */
+	uint8_t DMAPipe;					/* Pipe of the payload being read with DMA */
+	uint8_t DMAPayloadWidth;			/* Width of the payload being read with DMA */
+
+	Boolean DynamicPayloadLength;	/* Set before NRF24L01_Init to send payloads with only data and checksum, all devices have to use the same setting */
 
-	CircularBuffer_TypeDef RxPipeBuffer[6];	/* Buffer for the six RX Pipes */
+	NRF24L01_PipeBuffer_TypeDef RxPipeBuffer[6];	/* Buffer for the six RX Pipes */
 	uint32_t ChecksumErrors;	/* Variable to hold the amount of checksum errors */
 	Boolean InTxMode;			/* True if nRF24l01 Device is in TX mode, False otherwise */
 	Boolean Initialized;		/* True if initialized, False otherwise */
@@ -65,6 +86,8 @@ typedef struct
 void NRF24L01_Init(NRF24L01_Device* Device);
 void NRF24L01_WritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t ByteCount);
 void NRF24L01_Write(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount);
+ErrorStatus NRF24L01_StartWritePayload(NRF24L01_Device* Device, uint8_t* Data, uint8_t DataCount);
+Boolean NRF24L01_IsBusy(NRF24L01_Device* Device);
 
 uint8_t NRF24L01_SetRxPipeAddressSeparated(NRF24L01_Device* Device, uint8_t Pipe, uint32_t AddressMSBytes, uint8_t AddressLSByte);
 uint8_t NRF24L01_SetTxAddressSeparated(NRF24L01_Device* Device, uint32_t AddressMSBytes, uint8_t AddressLSByte);
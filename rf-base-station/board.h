@@ -21,8 +21,7 @@
 #include "rf_usart2_usb.h"
 #include "rf_usart1.h"
 #include "rf_i2c2.h"
-#include "rf_spi1.h"
-#include "rf_spi2.h"
+#include "rf_spi.h"
 
 #include "nrf24l01/nrf24l01.h"
 #include "nrf24l01/nrf24l01_register_map.h"
@@ -72,6 +71,7 @@ void BOARD_Init()
 	NRF24L01_1.SPIx_Init 			= RF_SPI1_Init;
 	NRF24L01_1.SPIx_WriteRead 		= RF_SPI1_WriteRead;
 	NRF24L01_1.SPIx_Write 			= RF_SPI1_Write;
+	NRF24L01_1.SPIx_TransferDMA 	= RF_SPI1_TransferDMA;
 	NRF24L01_Init(&NRF24L01_1);
 
 	NRF24L01_SetRxPipeAddress(&NRF24L01_1, 0, DEVICE_0_1_ADDRESS);	// The device should have it's own address on pipe 0
@@ -102,6 +102,7 @@ void BOARD_Init()
 	NRF24L01_2.SPIx_Init 			= RF_SPI2_Init;
 	NRF24L01_2.SPIx_WriteRead 		= RF_SPI2_WriteRead;
 	NRF24L01_2.SPIx_Write 			= RF_SPI2_Write;
+	NRF24L01_2.SPIx_TransferDMA 	= RF_SPI2_TransferDMA;
 	NRF24L01_Init(&NRF24L01_2);
 
 	NRF24L01_SetTxAddress(&NRF24L01_2, DEVICE_1_4_ADDRESS);
@@ -0,0 +1,340 @@
+/**
+ ******************************************************************************
+ * @file	rf_spi.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	SPI1 and SPI2 with blocking byte transfers and DMA transfers, both
+ *			buses share this code and have their own RF_SPI_Device
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rf_spi.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define SCK_Pin_1		GPIO_Pin_5
+#define MISO_Pin_1		GPIO_Pin_6
+#define MOSI_Pin_1		GPIO_Pin_7
+
+#define SCK_Pin_2		GPIO_Pin_13
+#define MISO_Pin_2		GPIO_Pin_14
+#define MOSI_Pin_2		GPIO_Pin_15
+
+/* Private variables ---------------------------------------------------------*/
+static RF_SPI_Device rfSpi1 = { .SPI_Channel = 1 };
+static RF_SPI_Device rfSpi2 = { .SPI_Channel = 2 };
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Initializes one of the DMA channels used by the SPI
+ * @param	SPIDevice: the device the channel belongs to
+ * @param	Channel: the DMA channel
+ * @param	Direction: DMA_DIR_PeripheralSRC for RX, DMA_DIR_PeripheralDST for TX
+ * @retval	None
+ */
+static void initDMAChannel(RF_SPI_Device* SPIDevice, DMA_Channel_TypeDef* Channel, uint32_t Direction)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	DMA_DeInit(Channel);
+	DMA_InitStructure.DMA_PeripheralBaseAddr 	= (uint32_t)&SPIDevice->SPIx->DR;
+	DMA_InitStructure.DMA_MemoryBaseAddr 		= (uint32_t)&SPIDevice->dummyByte;
+	DMA_InitStructure.DMA_DIR 					= Direction;
+	DMA_InitStructure.DMA_BufferSize 			= 1;
+	DMA_InitStructure.DMA_PeripheralInc 		= DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc 			= DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize 	= DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize 		= DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode 					= DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority 				= DMA_Priority_High;
+	DMA_InitStructure.DMA_M2M 					= DMA_M2M_Disable;
+	DMA_Init(Channel, &DMA_InitStructure);
+}
+
+/**
+ * @brief	Prepares a DMA channel for a new transfer
+ * @param	SPIDevice: the device the channel belongs to
+ * @param	Channel: the DMA channel
+ * @param	Address: memory address to transfer to/from, NULL to use dummyByte
+ * @param	Length: number of bytes to transfer
+ * @retval	None
+ */
+static void prepareDMAChannel(RF_SPI_Device* SPIDevice, DMA_Channel_TypeDef* Channel, uint32_t Address, uint16_t Length)
+{
+	uint32_t ccr = Channel->CCR & ~(DMA_CCR1_EN | DMA_CCR1_MINC);
+	if (Address != 0)
+		ccr |= DMA_CCR1_MINC;
+	else
+		Address = (uint32_t)&SPIDevice->dummyByte;
+
+	Channel->CCR = ccr;
+	Channel->CMAR = Address;
+	Channel->CNDTR = Length;
+}
+
+/**
+ * @brief	Claims the DMA channels for a transfer
+ * @param	SPIDevice: the device to use
+ * @retval	1 if they were claimed, 0 if a transfer is running
+ * @note	dmaBusy is checked and set with interrupts masked, so a transfer started
+ *			from an interrupt can't claim them in between
+ */
+static uint8_t claimDMA(RF_SPI_Device* SPIDevice)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t claimed = !SPIDevice->dmaBusy;
+	if (claimed)
+		SPIDevice->dmaBusy = 1;
+	__set_PRIMASK(primask);
+	return claimed;
+}
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Initializes the SPI and its DMA channels
+ * @param	SPIDevice: the device to use, SPI_Channel has to be set
+ * @retval	None
+ */
+void RF_SPI_Init(RF_SPI_Device* SPIDevice)
+{
+	GPIO_TypeDef* gpio;
+	uint16_t sckMosiPins, misoPin;
+	uint8_t dmaIRQChannel;
+	if (SPIDevice->SPI_Channel == 1)
+	{
+		SPIDevice->SPIx 			= SPI1;
+		SPIDevice->DMA_RxChannel 	= DMA1_Channel2;
+		SPIDevice->DMA_TxChannel 	= DMA1_Channel3;
+		SPIDevice->DMA_RxCompleteIT = DMA1_IT_TC2;
+		SPIDevice->DMA_RxGlobalIT 	= DMA1_IT_GL2;
+		SPIDevice->DMA_TxGlobalIT 	= DMA1_IT_GL3;
+		dmaIRQChannel 				= DMA1_Channel2_IRQn;
+		gpio 						= GPIOA;
+		sckMosiPins 				= SCK_Pin_1 | MOSI_Pin_1;
+		misoPin 					= MISO_Pin_1;
+
+		/* Enable GPIOx and SPIx clocks */
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_SPI1, ENABLE);
+	}
+	else if (SPIDevice->SPI_Channel == 2)
+	{
+		SPIDevice->SPIx 			= SPI2;
+		SPIDevice->DMA_RxChannel 	= DMA1_Channel4;
+		SPIDevice->DMA_TxChannel 	= DMA1_Channel5;
+		SPIDevice->DMA_RxCompleteIT = DMA1_IT_TC4;
+		SPIDevice->DMA_RxGlobalIT 	= DMA1_IT_GL4;
+		SPIDevice->DMA_TxGlobalIT 	= DMA1_IT_GL5;
+		dmaIRQChannel 				= DMA1_Channel4_IRQn;
+		gpio 						= GPIOB;
+		sckMosiPins 				= SCK_Pin_2 | MOSI_Pin_2;
+		misoPin 					= MISO_Pin_2;
+
+		/* Enable GPIOx and SPIx clocks */
+		RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+		RCC_APB1PeriphClockCmd(RCC_APB1Periph_SPI2, ENABLE);
+	}
+	else
+		return;
+
+	/* Configure SPIx-SCK, SPIx-MOSI alternate function push-pull */
+	GPIO_InitTypeDef GPIO_InitStructure;
+	GPIO_InitStructure.GPIO_Pin   = sckMosiPins;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_AF_PP;
+	GPIO_Init(gpio, &GPIO_InitStructure);
+
+	/* Configure SPIx-MISO */
+	GPIO_InitStructure.GPIO_Pin   = misoPin;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_IN_FLOATING;
+	GPIO_Init(gpio, &GPIO_InitStructure);
+
+	/* Initialize SPIx */
+	SPI_InitTypeDef SPI_InitStructure;
+	SPI_InitStructure.SPI_Direction 		= SPI_Direction_2Lines_FullDuplex;
+	SPI_InitStructure.SPI_Mode 				= SPI_Mode_Master;
+	SPI_InitStructure.SPI_DataSize 			= SPI_DataSize_8b;
+	SPI_InitStructure.SPI_CPOL 				= SPI_CPOL_Low;
+	SPI_InitStructure.SPI_CPHA 				= SPI_CPHA_1Edge;
+	SPI_InitStructure.SPI_NSS 				= SPI_NSS_Soft;
+	SPI_InitStructure.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_64;
+	SPI_InitStructure.SPI_FirstBit 			= SPI_FirstBit_MSB;
+	SPI_InitStructure.SPI_CRCPolynomial 	= 7;
+	SPI_Init(SPIDevice->SPIx, &SPI_InitStructure);
+
+	/* Initialize the DMA channels, RX has higher priority so it's never overrun */
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	initDMAChannel(SPIDevice, SPIDevice->DMA_RxChannel, DMA_DIR_PeripheralSRC);
+	initDMAChannel(SPIDevice, SPIDevice->DMA_TxChannel, DMA_DIR_PeripheralDST);
+	DMA_ITConfig(SPIDevice->DMA_RxChannel, DMA_IT_TC, ENABLE);
+
+	/* Enable and set the DMA interrupt to the lowest priority */
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel 						= dmaIRQChannel;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority 	= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority 			= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelCmd 					= ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	SPIDevice->dmaBusy = 0;
+
+	/* Enable SPIx */
+	SPI_Cmd(SPIDevice->SPIx, ENABLE);
+}
+
+/**
+ * @brief	Writes and receives data from the SPI
+ * @param	SPIDevice: the device to use
+ * @param	Data: data to be written to the SPI
+ * @retval	The received data
+ */
+uint8_t RF_SPI_WriteRead(RF_SPI_Device* SPIDevice, uint8_t Data)
+{
+	/* Loop while DR register is not empty */
+	while (SPI_I2S_GetFlagStatus(SPIDevice->SPIx, SPI_I2S_FLAG_TXE) == RESET);
+
+	/* Send byte through the SPIx peripheral */
+	SPI_I2S_SendData(SPIDevice->SPIx, (uint16_t)Data);
+
+	/* Wait to receive a byte */
+	while (SPI_I2S_GetFlagStatus(SPIDevice->SPIx, SPI_I2S_FLAG_RXNE) == RESET);
+
+	/* Return the byte read from the SPI bus */
+	return SPI_I2S_ReceiveData(SPIDevice->SPIx);
+}
+
+/**
+ * @brief	Writes data to the SPI
+ * @param	SPIDevice: the device to use
+ * @param	Data: data to be written to the SPI
+ * @retval	None
+ */
+void RF_SPI_Write(RF_SPI_Device* SPIDevice, uint8_t Data)
+{
+	/* Loop while DR register is not empty */
+	while (SPI_I2S_GetFlagStatus(SPIDevice->SPIx, SPI_I2S_FLAG_TXE) == RESET);
+
+	/* Send byte through the SPIx peripheral */
+	SPI_I2S_SendData(SPIDevice->SPIx, (uint16_t)Data);
+}
+
+/**
+ * @brief	Starts a transfer with DMA and returns without waiting for it
+ * @param	SPIDevice: the device to use
+ * @param	TxData: data to write, NULL to write 0x00 Length times
+ * @param	RxData: where to store the received data, NULL to throw it away
+ * @param	Length: number of bytes to transfer
+ * @param	Callback: called from the DMA interrupt when the transfer is done, can be NULL
+ * @param	Context: passed to Callback
+ * @retval	SUCCESS if the transfer was started, ERROR if a transfer is already running
+ * @note	TxData and RxData have to stay valid until the transfer is done. SPI1
+ *			and SPI2 have their own DMA channels so they can transfer at the same time.
+ *			Polled transfers must not run on the bus from another context at the same
+ *			time, the nRF24L01 driver keeps them apart with its DMABusy
+ */
+ErrorStatus RF_SPI_TransferDMA(RF_SPI_Device* SPIDevice, const uint8_t* TxData, uint8_t* RxData, uint16_t Length,
+							   void (*Callback)(void* Context), void* Context)
+{
+	if (Length == 0 || !claimDMA(SPIDevice))
+		return ERROR;
+	SPIDevice->doneCallback = Callback;
+	SPIDevice->doneContext = Context;
+
+	/*
+	 * With polled transfers kept apart, the only byte that can still be on the bus
+	 * is the last one from RF_SPI_Write, which returns without waiting for it. Wait
+	 * at most that byte time for it to be shifted out and throw away what it received.
+	 * Reading DR and then SR also clears OVR, which is set when several writes didn't
+	 * read DR, so RX DMA starts with nothing pending
+	 */
+	while (SPI_I2S_GetFlagStatus(SPIDevice->SPIx, SPI_I2S_FLAG_TXE) == RESET);
+	while (SPI_I2S_GetFlagStatus(SPIDevice->SPIx, SPI_I2S_FLAG_BSY) != RESET);
+	(void)SPIDevice->SPIx->DR;
+	(void)SPIDevice->SPIx->SR;
+
+	SPIDevice->dummyByte = 0x00;
+	prepareDMAChannel(SPIDevice, SPIDevice->DMA_RxChannel, (uint32_t)RxData, Length);
+	prepareDMAChannel(SPIDevice, SPIDevice->DMA_TxChannel, (uint32_t)TxData, Length);
+
+	/* Start RX before TX so the first received byte can't be missed */
+	SPIDevice->DMA_RxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->DMA_TxChannel->CCR |= DMA_CCR1_EN;
+	SPIDevice->SPIx->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief	Handles the interrupt for the DMA RX channel of the SPI
+ * @param	SPIDevice: the device the interrupt is for
+ * @retval	None
+ */
+void RF_SPI_DMAInterrupt(RF_SPI_Device* SPIDevice)
+{
+	if (DMA_GetITStatus(SPIDevice->DMA_RxCompleteIT) != RESET)
+	{
+		SPIDevice->DMA_TxChannel->CCR &= ~DMA_CCR1_EN;
+		SPIDevice->DMA_RxChannel->CCR &= ~DMA_CCR1_EN;
+		SPIDevice->SPIx->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+		DMA_ClearITPendingBit(SPIDevice->DMA_TxGlobalIT);
+		DMA_ClearITPendingBit(SPIDevice->DMA_RxGlobalIT);
+
+		SPIDevice->dmaBusy = 0;
+		if (SPIDevice->doneCallback != 0)
+			SPIDevice->doneCallback(SPIDevice->doneContext);
+	}
+}
+
+/* SPI1 ----------------------------------------------------------------------*/
+void RF_SPI1_Init()
+{
+	RF_SPI_Init(&rfSpi1);
+}
+
+uint8_t RF_SPI1_WriteRead(uint8_t Data)
+{
+	return RF_SPI_WriteRead(&rfSpi1, Data);
+}
+
+void RF_SPI1_Write(uint8_t Data)
+{
+	RF_SPI_Write(&rfSpi1, Data);
+}
+
+ErrorStatus RF_SPI1_TransferDMA(const uint8_t* TxData, uint8_t* RxData, uint16_t Length, void (*Callback)(void* Context), void* Context)
+{
+	return RF_SPI_TransferDMA(&rfSpi1, TxData, RxData, Length, Callback, Context);
+}
+
+/* SPI2 ----------------------------------------------------------------------*/
+void RF_SPI2_Init()
+{
+	RF_SPI_Init(&rfSpi2);
+}
+
+uint8_t RF_SPI2_WriteRead(uint8_t Data)
+{
+	return RF_SPI_WriteRead(&rfSpi2, Data);
+}
+
+void RF_SPI2_Write(uint8_t Data)
+{
+	RF_SPI_Write(&rfSpi2, Data);
+}
+
+ErrorStatus RF_SPI2_TransferDMA(const uint8_t* TxData, uint8_t* RxData, uint16_t Length, void (*Callback)(void* Context), void* Context)
+{
+	return RF_SPI_TransferDMA(&rfSpi2, TxData, RxData, Length, Callback, Context);
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void DMA1_Channel2_IRQHandler(void)
+{
+	RF_SPI_DMAInterrupt(&rfSpi1);
+}
+
+void DMA1_Channel4_IRQHandler(void)
+{
+	RF_SPI_DMAInterrupt(&rfSpi2);
+}
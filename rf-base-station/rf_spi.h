@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @file	rf_spi.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Manage SPI1 and SPI2 for the nRF24L01s
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef RF_SPI_H_
+#define RF_SPI_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* Defines -------------------------------------------------------------------*/
+/* Typedefs ------------------------------------------------------------------*/
+typedef struct
+{
+	uint8_t SPI_Channel;					/* 1 or 2, everything else is set by RF_SPI_Init */
+
+	SPI_TypeDef* SPIx;
+	DMA_Channel_TypeDef* DMA_RxChannel;
+	DMA_Channel_TypeDef* DMA_TxChannel;
+	uint32_t DMA_RxCompleteIT;
+	uint32_t DMA_RxGlobalIT;
+	uint32_t DMA_TxGlobalIT;
+
+	uint8_t dummyByte;						/* Written when there is no TX data and where RX data is thrown away */
+	void (*doneCallback)(void* Context);	/* Called from the DMA interrupt when the transfer is done */
+	void* doneContext;
+	volatile uint8_t dmaBusy;
+} RF_SPI_Device;
+
+/* Function prototypes -------------------------------------------------------*/
+void RF_SPI_Init(RF_SPI_Device* SPIDevice);
+uint8_t RF_SPI_WriteRead(RF_SPI_Device* SPIDevice, uint8_t Data);
+void RF_SPI_Write(RF_SPI_Device* SPIDevice, uint8_t Data);
+ErrorStatus RF_SPI_TransferDMA(RF_SPI_Device* SPIDevice, const uint8_t* TxData, uint8_t* RxData, uint16_t Length,
+							   void (*Callback)(void* Context), void* Context);
+void RF_SPI_DMAInterrupt(RF_SPI_Device* SPIDevice);
+
+/* The nRF24L01 driver takes functions without a device, these use the bus in their name */
+void RF_SPI1_Init();
+uint8_t RF_SPI1_WriteRead(uint8_t Data);
+void RF_SPI1_Write(uint8_t Data);
+ErrorStatus RF_SPI1_TransferDMA(const uint8_t* TxData, uint8_t* RxData, uint16_t Length, void (*Callback)(void* Context), void* Context);
+
+void RF_SPI2_Init();
+uint8_t RF_SPI2_WriteRead(uint8_t Data);
+void RF_SPI2_Write(uint8_t Data);
+ErrorStatus RF_SPI2_TransferDMA(const uint8_t* TxData, uint8_t* RxData, uint16_t Length, void (*Callback)(void* Context), void* Context);
+
+#endif /* RF_SPI_H_ */
@@ -102,5 +102,33 @@ void SPI2_Write(uint8_t Data)
 	SPI_I2S_SendData(SPIx, (uint16_t)Data);
 }
 
+/**
+ * @brief	Writes a block of data to the SPI as fast as possible
+ * @param	Data: data to be written to the SPI
+ * @param	Length: number of bytes to write
+ * @retval	None
+ * @note	The next byte is written as soon as DR is empty so there are no gaps
+ *			between the bytes. The received bytes are thrown away and the overrun
+ *			this causes is cleared before returning, when the last byte has been
+ *			clocked out
+ */
+void SPI2_WriteBurst(const uint8_t* Data, uint32_t Length)
+{
+	for (uint32_t i = 0; i < Length; i++)
+	{
+		/* Loop while DR register is not empty */
+		while ((SPIx->SR & SPI_I2S_FLAG_TXE) == RESET);
+		SPIx->DR = Data[i];
+	}
+
+	/* Wait for the last byte to be clocked out */
+	while ((SPIx->SR & SPI_I2S_FLAG_TXE) == RESET);
+	while ((SPIx->SR & SPI_I2S_FLAG_BSY) != RESET);
+
+	/* Reading DR and then SR clears RXNE and OVR */
+	(void)SPIx->DR;
+	(void)SPIx->SR;
+}
+
 
 /* Interrupt Handlers --------------------------------------------------------*/
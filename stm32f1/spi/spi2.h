@@ -21,5 +21,6 @@
 void SPI2_Init();
 uint8_t SPI2_WriteRead(uint8_t Data);
 void SPI2_Write(uint8_t Data);
+void SPI2_WriteBurst(const uint8_t* Data, uint32_t Length);
 
 #endif /* SPI2_H_ */
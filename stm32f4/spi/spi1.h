@@ -21,5 +21,6 @@
 void SPI1_Init();
 uint8_t SPI1_WriteRead(uint8_t Data);
 void SPI1_Write(uint8_t Data);
+void SPI1_WriteBurst(const uint8_t* Data, uint32_t Length);
 
 #endif /* SPI1_H_ */
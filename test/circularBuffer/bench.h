@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @file	bench.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Timing helpers for the host benchmarks. Times are taken with the
+ *			time stamp counter where there is one, and the best of several
+ *			runs is reported to filter out other load on the host
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Defines -------------------------------------------------------------------*/
+#define BENCH_RUNS		15
+
+/* Keeps the compiler from optimizing away a result */
+#define BENCH_KEEP(VALUE)	__asm__ volatile("" : : "g"(VALUE) : "memory")
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Get the current time in ticks, TSC cycles or nanoseconds
+ */
+static inline uint64_t BENCH_Ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief	The unit BENCH_Ticks() counts in
+ */
+static inline const char* BENCH_Unit(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return "cycles";
+#else
+	return "ns";
+#endif
+}
+
+/**
+ * @brief	Run a function several times and get the best time per iteration
+ * @param	Function: the function to time, called with Iterations
+ * @param	Context: passed on to Function
+ * @param	Iterations: how many operations one call of Function does
+ * @retval	The best number of ticks per operation
+ */
+static inline double BENCH_Run(void (*Function)(void*, uint32_t), void* Context, uint32_t Iterations)
+{
+	double best = 0;
+
+	/* The first run warms up the caches and is not counted */
+	Function(Context, Iterations);
+	for (uint32_t run = 0; run < BENCH_RUNS; run++)
+	{
+		uint64_t start = BENCH_Ticks();
+		Function(Context, Iterations);
+		double ticks = (double)(BENCH_Ticks() - start) / Iterations;
+		if (run == 0 || ticks < best)
+			best = ticks;
+	}
+
+	return best;
+}
+
+#endif /* BENCH_H_ */
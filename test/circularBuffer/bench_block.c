@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file	bench_block.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Compares moving data through the circular buffer one byte at a
+ *			time with CIRC_BUFFER_Insert/Remove against the block functions,
+ *			for 32 byte nRF24L01 payloads and 4 KB bursts
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define CIRCULARBUFFER_SIZE		8192
+#include "circularBuffer/circularBuffer.h"
+#include "bench.h"
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef struct
+{
+	CircularBuffer_TypeDef buffer;
+	uint32_t size;					/* Number of bytes moved per operation */
+	uint8_t source[4096];
+	uint8_t destination[4096];
+} BenchBlock;
+
+/* Private variables ---------------------------------------------------------*/
+static BenchBlock bench;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	The way the drivers moved payloads before, one call per byte
+ */
+static void prvPerByte(void* Context, uint32_t Iterations)
+{
+	BenchBlock* b = (BenchBlock*)Context;
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		for (uint32_t i = 0; i < b->size; i++)
+			CIRC_BUFFER_Insert(&b->buffer, b->source[i]);
+		for (uint32_t i = 0; i < b->size; i++)
+			b->destination[i] = CIRC_BUFFER_Remove(&b->buffer);
+		BENCH_KEEP(b->destination[0]);
+	}
+}
+
+static void prvBlock(void* Context, uint32_t Iterations)
+{
+	BenchBlock* b = (BenchBlock*)Context;
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		CIRC_BUFFER_InsertBlock(&b->buffer, b->source, b->size);
+		CIRC_BUFFER_RemoveBlock(&b->buffer, b->destination, b->size);
+		BENCH_KEEP(b->destination[0]);
+	}
+}
+
+/**
+ * @brief	Time both ways of moving Size bytes. The buffer is not reset between
+ *			operations, so the copies wrap around the end of the storage too
+ */
+static void prvCompare(const char* Name, uint32_t Size, uint32_t Iterations)
+{
+	CIRC_BUFFER_Init(&bench.buffer);
+	bench.size = Size;
+	for (uint32_t i = 0; i < Size; i++)
+		bench.source[i] = (uint8_t)(i * 7 + 1);
+
+	double perByte = BENCH_Run(prvPerByte, &bench, Iterations);
+	double block = BENCH_Run(prvBlock, &bench, Iterations);
+	if (memcmp(bench.source, bench.destination, Size) != 0)
+		printf("  data was corrupted\n");
+
+	printf("%-16s per byte %9.1f %s (%5.2f/byte)   block %9.1f %s (%5.2f/byte)   %5.1fx\n",
+			Name, perByte, BENCH_Unit(), perByte / Size, block, BENCH_Unit(), block / Size, perByte / block);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	printf("Insert + remove through a %u byte circular buffer, best of %u runs\n", CIRCULARBUFFER_SIZE, BENCH_RUNS);
+	prvCompare("32 byte payload", 32, 100000);
+	prvCompare("4 KB burst", 4096, 1000);
+	return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * @file	bench_inline.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Compares the header-only circular buffer, inlined into the caller,
+ *			against the same functions called in another translation unit.
+ *			Every operation moves one byte like a receive ISR does. Built once
+ *			with a full fence for __DMB() and once with only a compiler
+ *			barrier, which is closer to the cost of a DMB on a Cortex-M3
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bench_inline.h"
+#include "bench.h"
+
+/* Private variables ---------------------------------------------------------*/
+static CircularBuffer_TypeDef buffer;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvInline(void* Context, uint32_t Iterations)
+{
+	CircularBuffer_TypeDef* b = (CircularBuffer_TypeDef*)Context;
+	uint32_t sum = 0;
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		CIRC_BUFFER_Insert(b, (uint8_t)n);
+		if (CIRC_BUFFER_GetCount(b) != 0)
+			sum += CIRC_BUFFER_Remove(b);
+	}
+	BENCH_KEEP(sum);
+}
+
+static void prvCalls(void* Context, uint32_t Iterations)
+{
+	CircularBuffer_TypeDef* b = (CircularBuffer_TypeDef*)Context;
+	uint32_t sum = 0;
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		BENCH_Insert(b, (uint8_t)n);
+		if (BENCH_GetCount(b) != 0)
+			sum += BENCH_Remove(b);
+	}
+	BENCH_KEEP(sum);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	CIRC_BUFFER_Init(&buffer);
+	double inlined = BENCH_Run(prvInline, &buffer, 1000000);
+	double calls = BENCH_Run(prvCalls, &buffer, 1000000);
+
+#if defined(STM32F10X_HOST_SINGLE_THREAD)
+	printf("Compiler barrier: ");
+#else
+	printf("Full fence:       ");
+#endif
+	printf("insert + count + remove, inline %6.1f %s, function calls %6.1f %s, %.2fx\n",
+			inlined, BENCH_Unit(), calls, BENCH_Unit(), calls / inlined);
+	return 0;
+}
@@ -1,25 +1,23 @@
 /**
  ******************************************************************************
- * @file	rf_spi2.h
+ * @file	bench_inline.h
  * @author	Hampus Sandberg
  * @version	0.1
- * @date	2013-07-15
- * @brief	Manage SPI1
+ * @date	2014-11-23
+ * @brief	Out-of-line wrappers of the circular buffer functions
  ******************************************************************************
  */
 
 /* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef RF_SPI2_H_
-#define RF_SPI2_H_
+#ifndef BENCH_INLINE_H_
+#define BENCH_INLINE_H_
 
 /* Includes ------------------------------------------------------------------*/
-#include "stm32f10x.h"
+#include "circularBuffer/circularBuffer.h"
 
-/* Defines -------------------------------------------------------------------*/
-/* Typedefs ------------------------------------------------------------------*/
 /* Function prototypes -------------------------------------------------------*/
-void RF_SPI2_Init();
-uint8_t RF_SPI2_WriteRead(uint8_t Data);
-void RF_SPI2_Write(uint8_t Data);
+uint8_t BENCH_Insert(CircularBuffer_TypeDef* CircularBuffer, uint8_t Data);
+uint8_t BENCH_Remove(CircularBuffer_TypeDef* CircularBuffer);
+uint32_t BENCH_GetCount(CircularBuffer_TypeDef* CircularBuffer);
 
-#endif /* RF_SPI2_H_ */
+#endif /* BENCH_INLINE_H_ */
@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * @file	bench_inline_calls.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Out-of-line versions of the circular buffer functions for
+ *			bench_inline.c. They are in their own translation unit so every
+ *			call costs a real function call, like the circularBuffer.c files
+ *			did before the implementation was moved into the header
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bench_inline.h"
+
+/* Functions -----------------------------------------------------------------*/
+uint8_t BENCH_Insert(CircularBuffer_TypeDef* CircularBuffer, uint8_t Data)
+{
+	return CIRC_BUFFER_Insert(CircularBuffer, Data);
+}
+
+uint8_t BENCH_Remove(CircularBuffer_TypeDef* CircularBuffer)
+{
+	return CIRC_BUFFER_Remove(CircularBuffer);
+}
+
+uint32_t BENCH_GetCount(CircularBuffer_TypeDef* CircularBuffer)
+{
+	return CIRC_BUFFER_GetCount(CircularBuffer);
+}
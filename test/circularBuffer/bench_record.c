@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file	bench_record.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Compares the record buffer against a byte circular buffer for
+ *			mixed 4-32 byte packets. The byte buffer gets a length byte in
+ *			front of every packet too, otherwise the consumer can't find the
+ *			packet boundaries. Built with CIRCULARBUFFER_SIZE=256
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "recordBuffer.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define PACKET_COUNT		1024
+#define PACKETS_PER_BATCH	6
+#define MIN_LENGTH			4
+#define MAX_LENGTH			32
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef struct
+{
+	uint8_t length;
+	uint8_t data[MAX_LENGTH];
+} Packet;
+
+typedef struct
+{
+	CircularBuffer_TypeDef byteBuffer;
+	RecordBuffer_TypeDef recordBuffer;
+	Packet packets[PACKET_COUNT];
+	uint32_t bytes;					/* Number of payload bytes in all packets */
+	uint32_t checksum;				/* Sum of all received bytes */
+} BenchRecord;
+
+/* Private variables ---------------------------------------------------------*/
+static BenchRecord bench;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Byte buffer with one call per byte, the way the nRF24L01 pipes were filled
+ */
+static void prvBytePerByte(void* Context, uint32_t Iterations)
+{
+	BenchRecord* b = (BenchRecord*)Context;
+	uint8_t data[MAX_LENGTH];
+	b->checksum = 0;
+
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		for (uint32_t p = 0; p < PACKET_COUNT; p += PACKETS_PER_BATCH)
+		{
+			for (uint32_t i = p; i < p + PACKETS_PER_BATCH && i < PACKET_COUNT; i++)
+			{
+				CIRC_BUFFER_Insert(&b->byteBuffer, b->packets[i].length);
+				for (uint32_t j = 0; j < b->packets[i].length; j++)
+					CIRC_BUFFER_Insert(&b->byteBuffer, b->packets[i].data[j]);
+			}
+			while (!CIRC_BUFFER_IsEmpty(&b->byteBuffer))
+			{
+				uint8_t length = CIRC_BUFFER_Remove(&b->byteBuffer);
+				for (uint32_t j = 0; j < length; j++)
+					data[j] = CIRC_BUFFER_Remove(&b->byteBuffer);
+				b->checksum += data[0] + data[length - 1];
+			}
+		}
+	}
+	BENCH_KEEP(b->checksum);
+}
+
+/**
+ * @brief	Byte buffer with the block functions for the length and the data
+ */
+static void prvByteBlock(void* Context, uint32_t Iterations)
+{
+	BenchRecord* b = (BenchRecord*)Context;
+	uint8_t data[MAX_LENGTH];
+	b->checksum = 0;
+
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		for (uint32_t p = 0; p < PACKET_COUNT; p += PACKETS_PER_BATCH)
+		{
+			for (uint32_t i = p; i < p + PACKETS_PER_BATCH && i < PACKET_COUNT; i++)
+				CIRC_BUFFER_InsertBlock(&b->byteBuffer, &b->packets[i].length, b->packets[i].length + 1);
+			while (!CIRC_BUFFER_IsEmpty(&b->byteBuffer))
+			{
+				uint8_t length = CIRC_BUFFER_Remove(&b->byteBuffer);
+				CIRC_BUFFER_RemoveBlock(&b->byteBuffer, data, length);
+				b->checksum += data[0] + data[length - 1];
+			}
+		}
+	}
+	BENCH_KEEP(b->checksum);
+}
+
+static void prvRecordPop(void* Context, uint32_t Iterations)
+{
+	BenchRecord* b = (BenchRecord*)Context;
+	uint8_t data[MAX_LENGTH];
+	uint32_t length;
+	b->checksum = 0;
+
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		for (uint32_t p = 0; p < PACKET_COUNT; p += PACKETS_PER_BATCH)
+		{
+			for (uint32_t i = p; i < p + PACKETS_PER_BATCH && i < PACKET_COUNT; i++)
+				RECORD_BUFFER_PushRecord(&b->recordBuffer, b->packets[i].data, b->packets[i].length);
+			while ((length = RECORD_BUFFER_PopRecord(&b->recordBuffer, data, sizeof(data))) != 0)
+				b->checksum += data[0] + data[length - 1];
+		}
+	}
+	BENCH_KEEP(b->checksum);
+}
+
+static void prvRecordFront(void* Context, uint32_t Iterations)
+{
+	BenchRecord* b = (BenchRecord*)Context;
+	uint8_t* data;
+	uint32_t length;
+	b->checksum = 0;
+
+	for (uint32_t n = 0; n < Iterations; n++)
+	{
+		for (uint32_t p = 0; p < PACKET_COUNT; p += PACKETS_PER_BATCH)
+		{
+			for (uint32_t i = p; i < p + PACKETS_PER_BATCH && i < PACKET_COUNT; i++)
+				RECORD_BUFFER_PushRecord(&b->recordBuffer, b->packets[i].data, b->packets[i].length);
+			while ((length = RECORD_BUFFER_FrontRecord(&b->recordBuffer, &data)) != 0)
+			{
+				b->checksum += data[0] + data[length - 1];
+				RECORD_BUFFER_ReleaseRecord(&b->recordBuffer);
+			}
+		}
+	}
+	BENCH_KEEP(b->checksum);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	static const struct
+	{
+		const char* name;
+		void (*function)(void*, uint32_t);
+	} cases[] = {
+		{"byte ring, per byte", prvBytePerByte},
+		{"byte ring, block", prvByteBlock},
+		{"record ring, pop", prvRecordPop},
+		{"record ring, front", prvRecordFront},
+	};
+	uint32_t expected = 0;
+
+	/* Same packets for every run, the batch always fits in the buffers */
+	srand(1);
+	for (uint32_t i = 0; i < PACKET_COUNT; i++)
+	{
+		bench.packets[i].length = MIN_LENGTH + rand() % (MAX_LENGTH - MIN_LENGTH + 1);
+		for (uint32_t j = 0; j < bench.packets[i].length; j++)
+			bench.packets[i].data[j] = (uint8_t)rand();
+		bench.bytes += bench.packets[i].length;
+		expected += bench.packets[i].data[0] + bench.packets[i].data[bench.packets[i].length - 1];
+	}
+
+	printf("%u packets of %u-%u bytes through a %u byte buffer, %u per batch, best of %u runs\n",
+			PACKET_COUNT, MIN_LENGTH, MAX_LENGTH, CIRCULARBUFFER_SIZE, PACKETS_PER_BATCH, BENCH_RUNS);
+	for (uint32_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+	{
+		CIRC_BUFFER_Init(&bench.byteBuffer);
+		RECORD_BUFFER_Init(&bench.recordBuffer);
+		double ticks = BENCH_Run(cases[c].function, &bench, 100);
+		printf("%-20s %7.1f %s/packet %6.2f %s/byte%s\n", cases[c].name, ticks / PACKET_COUNT, BENCH_Unit(),
+				ticks / bench.bytes, BENCH_Unit(), (bench.checksum == expected * 100) ? "" : "   data was corrupted");
+	}
+
+	return 0;
+}
@@ -0,0 +1,287 @@
+/**
+ ******************************************************************************
+ * @file	stress.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Stress test for the lock-free circular buffer. A producer and a
+ *			consumer thread move a sequence of numbers through a small buffer
+ *			with all of the insert and remove functions and the consumer checks
+ *			that nothing is lost, duplicated or reordered.
+ *
+ *			Usage: stress [number of items, default 100000000]
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define CIRCULARBUFFER_SIZE		64
+#define CIRCULARBUFFER_DATATYPE	uint32_t
+#include "circularBuffer/circularBuffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define DEFAULT_ITEM_COUNT		100000000UL
+#define MAX_BLOCK_SIZE			(CIRCULARBUFFER_SIZE + 8)
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef struct
+{
+	CircularBuffer_TypeDef buffer;
+	uint64_t count;					/* Number of items the producer inserts */
+	uint64_t received;				/* Number of items the consumer got */
+	uint64_t errors;				/* Number of items out of sequence */
+	uint64_t expected;				/* The item the consumer expected next when it was done */
+	volatile uint32_t producerDone;
+} StressTest;
+
+/* Private variables ---------------------------------------------------------*/
+static StressTest test;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Small xorshift generator so every thread gets its own cheap random sequence
+ */
+static uint32_t prvRandom(uint32_t* State)
+{
+	uint32_t x = *State;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*State = x;
+	return x;
+}
+
+static double prvSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief	Inserts the numbers 1..count, mixing single inserts, block inserts
+ *			and zero-copy writes. Waits when the buffer is full unless the
+ *			buffer overwrites the oldest items
+ */
+static void* prvProducer(void* Argument)
+{
+	(void)Argument;
+	CircularBuffer_TypeDef* buffer = &test.buffer;
+	uint8_t overwrite = (buffer->policy == CircularBufferPolicy_OverwriteOldest);
+	uint32_t random = 0x12345678;
+	uint32_t block[MAX_BLOCK_SIZE];
+	uint64_t next = 1;
+
+	while (next <= test.count)
+	{
+		uint32_t r = prvRandom(&random);
+		uint32_t count = 1 + (r >> 8) % (overwrite ? MAX_BLOCK_SIZE : 16);
+		if (count > test.count - next + 1)
+			count = test.count - next + 1;
+
+		uint32_t done = 0;
+		switch (r & 3)
+		{
+			case 0:
+				done = CIRC_BUFFER_Insert(buffer, (uint32_t)next);
+				break;
+
+			case 1:
+			case 2:
+				for (uint32_t i = 0; i < count; i++)
+					block[i] = (uint32_t)(next + i);
+				done = CIRC_BUFFER_InsertBlock(buffer, block, count);
+				break;
+
+			default:
+			{
+				uint32_t* region;
+				done = CIRC_BUFFER_AcquireWrite(buffer, &region, count);
+				for (uint32_t i = 0; i < done; i++)
+					region[i] = (uint32_t)(next + i);
+				CIRC_BUFFER_CommitWrite(buffer, done);
+				break;
+			}
+		}
+
+		next += done;
+		if (done == 0)
+			sched_yield();
+	}
+
+	test.producerDone = 1;
+	return 0;
+}
+
+/**
+ * @brief	Checks one received item against the expected sequence. With overwrite
+ *			there can be gaps but the sequence has to increase
+ */
+static void prvCheck(uint32_t Value, uint64_t* Expected, uint8_t Overwrite)
+{
+	if (Value == (uint32_t)*Expected || (Overwrite && (int32_t)(Value - (uint32_t)*Expected) > 0))
+	{
+		*Expected += (uint32_t)(Value - (uint32_t)*Expected) + 1;
+	}
+	else if (test.errors++ < 10)
+	{
+		printf("  item %lu is out of sequence, expected %lu\n", (unsigned long)Value, (unsigned long)(uint32_t)*Expected);
+	}
+	test.received++;
+}
+
+/**
+ * @brief	Removes items until the producer is done and the buffer is empty,
+ *			mixing single removes, block removes, peeks and zero-copy reads
+ */
+static void* prvConsumer(void* Argument)
+{
+	(void)Argument;
+	CircularBuffer_TypeDef* buffer = &test.buffer;
+	uint8_t overwrite = (buffer->policy == CircularBufferPolicy_OverwriteOldest);
+	uint32_t random = 0x87654321;
+	uint32_t block[MAX_BLOCK_SIZE];
+	uint64_t expected = 1;
+
+	while (1)
+	{
+		uint32_t producerDone = test.producerDone;
+		uint32_t r = prvRandom(&random);
+		uint32_t count = 1 + (r >> 8) % 24;
+		uint32_t done = 0;
+
+		switch (r & 7)
+		{
+			case 0:
+				if (!CIRC_BUFFER_IsEmpty(buffer))
+				{
+					uint32_t value = CIRC_BUFFER_Remove(buffer);
+					/* Remove returns 0 if the producer emptied the buffer by overwriting */
+					if (value != 0)
+					{
+						prvCheck(value, &expected, overwrite);
+						done = 1;
+					}
+				}
+				break;
+
+			case 1:
+			{
+				/* A peeked copy has to match what is removed right after if nothing was overwritten */
+				uint32_t overruns = CIRC_BUFFER_GetOverruns(buffer);
+				uint32_t peeked[MAX_BLOCK_SIZE];
+				uint32_t peekCount = CIRC_BUFFER_PeekBlock(buffer, peeked, count);
+				done = CIRC_BUFFER_RemoveBlock(buffer, block, peekCount);
+				if (done == peekCount && CIRC_BUFFER_GetOverruns(buffer) == overruns &&
+					memcmp(peeked, block, done * sizeof(uint32_t)) != 0)
+				{
+					if (test.errors++ < 10)
+						printf("  peeked data differs from removed data\n");
+				}
+				for (uint32_t i = 0; i < done; i++)
+					prvCheck(block[i], &expected, overwrite);
+				break;
+			}
+
+			case 2:
+			{
+				uint32_t value;
+				if (CIRC_BUFFER_PeekAt(buffer, 0, &value) && CIRC_BUFFER_Skip(buffer, 1) == 1)
+				{
+					/* The item can have been overwritten between the peek and the skip */
+					if (!overwrite)
+						prvCheck(value, &expected, overwrite);
+					else
+						expected = value + 1, test.received++;
+					done = 1;
+				}
+				break;
+			}
+
+			case 3:
+			{
+				uint32_t* region;
+				uint32_t overruns = CIRC_BUFFER_GetOverruns(buffer);
+				done = CIRC_BUFFER_AcquireRead(buffer, &region, count);
+				memcpy(block, region, done * sizeof(uint32_t));
+				CIRC_BUFFER_ReleaseRead(buffer, done);
+				/* The region can be overwritten while it's read, which overruns shows */
+				if (overwrite && CIRC_BUFFER_GetOverruns(buffer) != overruns)
+				{
+					done = 0;
+					break;
+				}
+				for (uint32_t i = 0; i < done; i++)
+					prvCheck(block[i], &expected, overwrite);
+				break;
+			}
+
+			default:
+				done = CIRC_BUFFER_RemoveBlock(buffer, block, count);
+				for (uint32_t i = 0; i < done; i++)
+					prvCheck(block[i], &expected, overwrite);
+				break;
+		}
+
+		if (done == 0)
+		{
+			if (producerDone && CIRC_BUFFER_IsEmpty(buffer))
+				break;
+			sched_yield();
+		}
+	}
+
+	test.expected = expected;
+	return 0;
+}
+
+/**
+ * @brief	Run the producer and consumer threads once with a policy
+ * @retval	(1) if the test passed, (0) otherwise
+ */
+static int prvRun(CircularBufferPolicy Policy, uint64_t Count)
+{
+	pthread_t producer, consumer;
+
+	memset(&test, 0, sizeof(test));
+	CIRC_BUFFER_InitWithPolicy(&test.buffer, Policy);
+	test.count = Count;
+
+	double start = prvSeconds();
+	pthread_create(&consumer, 0, prvConsumer, 0);
+	pthread_create(&producer, 0, prvProducer, 0);
+	pthread_join(producer, 0);
+	pthread_join(consumer, 0);
+	double seconds = prvSeconds() - start;
+
+	uint32_t overruns = CIRC_BUFFER_GetOverruns(&test.buffer);
+	/* The newest item is never dropped, so the sequence has to end with it */
+	int passed = (test.errors == 0) && (test.expected == Count + 1);
+	if (Policy == CircularBufferPolicy_DropNewest)
+		passed = passed && (test.received == Count) && (overruns == 0);
+	else
+		passed = passed && (test.received <= Count) && (test.received > 0);
+
+	printf("%s: %lu items, %lu received, %lu overruns, %lu errors, %.1f Mitems/s: %s\n",
+			(Policy == CircularBufferPolicy_DropNewest) ? "drop newest" : "overwrite oldest",
+			(unsigned long)Count, (unsigned long)test.received, (unsigned long)overruns,
+			(unsigned long)test.errors, Count / seconds * 1e-6, passed ? "PASS" : "FAIL");
+	return passed;
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(int argc, char** argv)
+{
+	uint64_t count = DEFAULT_ITEM_COUNT;
+	if (argc > 1)
+		count = strtoull(argv[1], 0, 0);
+
+	int passed = prvRun(CircularBufferPolicy_DropNewest, count);
+	passed &= prvRun(CircularBufferPolicy_OverwriteOldest, count / 10);
+
+	return passed ? 0 : 1;
+}
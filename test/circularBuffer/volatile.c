@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ * @file	volatile.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests the circular buffer with the hexapod settings, 128 volatile
+ *			bytes, where the copies and searches can't use memcpy/memchr.
+ *			Every offset in the storage is tried so the wrap is covered.
+ *			The record buffer is built with the same settings and checked
+ *			for the records padded past the wrap
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Built with CIRCULARBUFFER_SIZE=128 and CIRCULARBUFFER_DATATYPE=volatile uint8_t, see the Makefile */
+#include "circularBuffer/circularBuffer.h"
+#include "recordBuffer.h"
+
+#include <stdio.h>
+
+/* Private variables ---------------------------------------------------------*/
+static CircularBuffer_TypeDef buffer;
+static RecordBuffer_TypeDef records;
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What, uint32_t Start, uint32_t Count)
+{
+	if (!Condition && errors++ < 10)
+		printf("  %s failed at start %lu with %lu items\n", What, (unsigned long)Start, (unsigned long)Count);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	uint8_t data[CIRCULARBUFFER_SIZE], copy[CIRCULARBUFFER_SIZE];
+	uint32_t index;
+
+	prvExpect(CIRCULARBUFFER_IS_VOLATILE(CIRCULARBUFFER_DATATYPE) && !CIRCULARBUFFER_IS_VOLATILE(uint8_t), "volatile detection", 0, 0);
+
+	for (uint32_t start = 0; start < CIRCULARBUFFER_SIZE; start++)
+	{
+		for (uint32_t count = 0; count <= CIRCULARBUFFER_SIZE; count++)
+		{
+			CIRC_BUFFER_Init(&buffer);
+			CIRC_BUFFER_Skip(&buffer, CIRC_BUFFER_InsertBlock(&buffer, data, start));
+
+			for (uint32_t i = 0; i < count; i++)
+				data[i] = (uint8_t)(i % 251);
+			prvExpect(CIRC_BUFFER_InsertBlock(&buffer, data, count) == count, "InsertBlock", start, count);
+
+			/* The last item is searched for so the search has to cross the wrap */
+			if (count > 0)
+			{
+				uint8_t found = CIRC_BUFFER_FindByte(&buffer, data[count - 1], &index);
+				prvExpect(found && data[index] == data[count - 1] && (count < 251 ? index == count - 1 : 1), "FindByte", start, count);
+			}
+			prvExpect(!CIRC_BUFFER_FindByte(&buffer, 251, &index), "FindByte missing value", start, count);
+
+			prvExpect(CIRC_BUFFER_PeekBlock(&buffer, copy, count) == count && memcmp(data, copy, count) == 0, "PeekBlock", start, count);
+			prvExpect(CIRC_BUFFER_RemoveBlock(&buffer, copy, count) == count && memcmp(data, copy, count) == 0, "RemoveBlock", start, count);
+			prvExpect(CIRC_BUFFER_IsEmpty(&buffer), "IsEmpty", start, count);
+		}
+	}
+
+	/* A record that doesn't fit before the end pads it and goes to the start */
+	for (uint32_t start = 0; start < CIRCULARBUFFER_SIZE; start++)
+	{
+		for (uint32_t length = 1; length <= RECORD_BUFFER_MAX_LENGTH; length += 7)
+		{
+			RECORD_BUFFER_Init(&records);
+			CIRC_BUFFER_Skip(&records.buffer, CIRC_BUFFER_InsertBlock(&records.buffer, data, start));
+
+			for (uint32_t i = 0; i < length; i++)
+				data[i] = (uint8_t)(start + i);
+			prvExpect(RECORD_BUFFER_PushRecord(&records, data, length), "PushRecord", start, length);
+
+			uint32_t out = records.buffer.out;
+			prvExpect(!RECORD_BUFFER_IsEmpty(&records) && records.buffer.out == out, "IsEmpty with a record", start, length);
+			prvExpect(RECORD_BUFFER_PopRecord(&records, copy, sizeof(copy)) == length && memcmp(data, copy, length) == 0,
+					  "PopRecord", start, length);
+			prvExpect(RECORD_BUFFER_IsEmpty(&records), "IsEmpty after the record", start, length);
+		}
+	}
+
+	printf("volatile byte buffer: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
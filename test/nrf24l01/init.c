@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ * @file	init.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests NRF24L01_Init against the nRF24L01 model in the simulator
+ *			and compares it with the register by register configuration it
+ *			replaced, which is rebuilt here from the public functions:
+ *			- An RF channel above 125 is refused before anything is set up
+ *			- Both leave the same values in the registers
+ *			- For both the report shows the time from the first chip select
+ *			  until the configuration is done, the bus sessions, the chip
+ *			  selects and the CE edges. SPI1 runs at 9 MHz like on the board
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "nrf24l01/nrf24l01.h"
+#include "nrf24l01/nrf24l01_register_map.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef struct
+{
+	uint64_t cycles;
+	uint32_t sessions;
+	uint32_t selects;
+	uint32_t ceEdges;
+	uint32_t bytes;
+	uint32_t registerWrites;
+} InitReport;
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+
+static uint8_t txAddress[5] = {0xE7, 0xD3, 0xF0, 0x35, 0x77};
+static uint8_t rxAddress0[5] = {0xE7, 0xD3, 0xF0, 0x35, 0x77};
+static uint8_t rxAddress1[5] = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2};
+static uint8_t rxAddress2[1] = {0xC3};
+static uint8_t rxAddress3[1] = {0xC4};
+static uint8_t rxAddress4[1] = {0xC5};
+static uint8_t rxAddress5[1] = {0xC6};
+
+static NRF24L01_Device nrf = {
+	.NRF24L01_DeviceName = "nRF24L01",
+	.CSN_Pin = GPIO_Pin_4, .CSN_GPIO = GPIOA,
+	.CE_Pin = GPIO_Pin_3, .CE_GPIO = GPIOA,
+	.IRQ_Pin = GPIO_Pin_0, .IRQ_GPIO = GPIOB,
+	.IRQ_GPIO_PortSource = GPIO_PortSourceGPIOB, .IRQ_GPIO_PinSource = GPIO_PinSource0,
+	.IRQ_EXTI_Line = EXTI_Line0, .IRQ_NVIC_IRQChannel = EXTI0_IRQn,
+	.SPIDevice = &spi1,
+	.addressWidth = NRF24L01AddressWidth_5bytes,
+	.RfChannel = 40,
+	.TxAddress = txAddress,
+	.RxAddress0 = rxAddress0, .RxAddress1 = rxAddress1, .RxAddress2 = rxAddress2,
+	.RxAddress3 = rxAddress3, .RxAddress4 = rxAddress4, .RxAddress5 = rxAddress5,
+};
+
+static SIM_Nrf24l01Slave model = { .CE_GPIO = GPIOA, .CE_Pin = GPIO_Pin_3, .IRQ_GPIO = GPIOB, .IRQ_Pin = GPIO_Pin_0 };
+static SIM_PinWatch csnWatch;
+static uint64_t lastSelect;
+static uint64_t firstSelect;
+
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What)
+{
+	if (!Condition && errors++ < 20)
+		printf("  %s failed\n", What);
+}
+
+/**
+ * @brief	Finds the first chip select with a command, CSN also goes low for a
+ *			moment when the pin is set up
+ */
+static void prvChipSelect(SIM_PinWatch* Watch, uint8_t Level)
+{
+	(void)Watch;
+	if (!Level)
+		lastSelect = SIM_GetCycles();
+	else if (model.Slave.bytesThisSelect != 0 && firstSelect == 0)
+		firstSelect = lastSelect;
+}
+
+/**
+ * @brief	The configuration part of NRF24L01_Init before the registers were
+ *			written in one bus session, one call for every register
+ */
+static ErrorStatus prvInitPerRegister(NRF24L01_Device* Device)
+{
+	NRF24L01_SetRFChannel(Device, Device->RfChannel);
+	if (NRF24L01_GetRFChannel(Device) != Device->RfChannel)
+		return ERROR;
+
+	for (uint32_t pipe = 0; pipe < 6; pipe++)
+	{
+		NRF24L01_SetPayloadSizeForPipe(Device, 32, pipe);
+		NRF24L01_EnablePipe(Device, pipe);
+	}
+
+	NRF24L01_SetTxAddress(Device, Device->TxAddress);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress0, 0);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress1, 1);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress2, 2);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress3, 3);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress4, 4);
+	NRF24L01_SetRxAddressForPipe(Device, Device->RxAddress5, 5);
+
+	NRF24L01_FlushTxBuffer(Device);
+	NRF24L01_FlushRxBuffer(Device);
+	NRF24L01_ResetAllFlags(Device);
+
+	NRF24L01_SetAddressWidth(Device);
+	NRF24L01_PowerUpInRxMode(Device);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Resets the counters before an initialization
+ */
+static void prvStartReport(void)
+{
+	SIM_ResetStatistics();
+	SPI_ResetStatistics(&spi1);
+	model.Slave.selects = 0;
+	model.Slave.emptySelects = 0;
+	model.ceEdges = 0;
+	model.registerWrites = 0;
+	firstSelect = 0;
+}
+
+/**
+ * @brief	Collects the counters after an initialization
+ */
+static void prvEndReport(InitReport* Report)
+{
+	SIM_Statistics sim;
+	SPI_Statistics driver;
+	SIM_GetStatistics(&sim);
+	SPI_GetStatistics(&spi1, &driver);
+
+	Report->cycles = SIM_GetCycles() - firstSelect;
+	Report->sessions = driver.busWaitTime.count;	/* One for every SPI_Select */
+	Report->selects = model.Slave.selects - model.Slave.emptySelects;
+	Report->ceEdges = model.ceEdges;
+	Report->bytes = sim.spiBytes[0];
+	Report->registerWrites = model.registerWrites;
+}
+
+static void prvPrintReport(const char* Name, const InitReport* Report)
+{
+	printf("  %-13s %8lu %8.1f %9lu %8lu %8lu %6lu %7lu\n", Name,
+		   (unsigned long)Report->cycles, (double)Report->cycles * 1000000.0 / SIM_CPU_CLOCK_HZ,
+		   (unsigned long)Report->sessions, (unsigned long)Report->selects, (unsigned long)Report->ceEdges,
+		   (unsigned long)Report->bytes, (unsigned long)Report->registerWrites);
+}
+
+static void prvTestTask(void* pvParameters)
+{
+	(void)pvParameters;
+	SIM_Nrf24l01Slave_Init(&model, SPI1, GPIOA, GPIO_Pin_4);
+	csnWatch.GPIOx = GPIOA;
+	csnWatch.Pin = GPIO_Pin_4;
+	csnWatch.Callback = prvChipSelect;
+	SIM_WatchPin(&csnWatch);
+
+	/* A channel the nRF24L01 doesn't have is refused before the bus or the task is touched */
+	nrf.RfChannel = 126;
+	prvExpect(NRF24L01_Init(&nrf) == ERROR, "channel 126 refused");
+	prvExpect(model.commands == 0, "nothing sent for channel 126");
+	prvExpect(nrf.xInterruptTask == 0, "no task created for channel 126");
+	nrf.RfChannel = 40;
+
+	InitReport batched;
+	prvStartReport();
+	prvExpect(NRF24L01_Init(&nrf) == SUCCESS, "NRF24L01_Init");
+	prvEndReport(&batched);
+	prvExpect(model.registers[RF_CH][0] == 40, "RF_CH written");
+	prvExpect(model.registers[EN_RXADDR][0] == ALL_PIPES, "all pipes enabled");
+	prvExpect(model.registers[RX_ADDR_P0][0] == 0x77 && model.registers[RX_ADDR_P0][4] == 0xE7, "RX_ADDR_P0 LSByte first");
+	prvExpect(model.registers[CONFIG][0] == ((1 << EN_CRC) | (1 << PWR_UP) | (1 << PRIM_RX)), "powered up in RX mode");
+	prvExpect(SIM_GetOutput(GPIOA, GPIO_Pin_3) == 1, "CE high after init");
+	prvExpect(model.shortCsHigh == 0, "CSN high for Tcwh between the commands");
+	uint8_t registers[sizeof(model.registers)];
+	memcpy(registers, model.registers, sizeof(registers));
+
+	/* The same configuration from the power on values, one register at a time */
+	InitReport perRegister;
+	SIM_Nrf24l01Slave_Reset(&model);
+	prvStartReport();
+	prvExpect(prvInitPerRegister(&nrf) == SUCCESS, "per register init");
+	prvEndReport(&perRegister);
+	prvExpect(memcmp(registers, model.registers, sizeof(registers)) == 0, "same registers as per register init");
+
+	printf("  configuration from the first chip select, SPI1 at %lu Hz\n", (unsigned long)(SIM_CPU_CLOCK_HZ / 8));
+	printf("  %-13s %8s %8s %9s %8s %8s %6s %7s\n",
+		   "", "cycles", "us", "sessions", "selects", "ce edges", "bytes", "writes");
+	prvPrintReport("per register", &perRegister);
+	prvPrintReport("batched", &batched);
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+void EXTI0_IRQHandler(void)
+{
+	if (EXTI_GetITStatus(nrf.IRQ_EXTI_Line) != RESET)
+	{
+		NRF24L01_Interrupt(&nrf);
+		EXTI_ClearITPendingBit(nrf.IRQ_EXTI_Line);
+	}
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	xTaskCreate(prvTestTask, "test", configMINIMAL_STACK_SIZE, 0, 2, 0);
+	vTaskStartScheduler();
+
+	printf("nrf24l01 init: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
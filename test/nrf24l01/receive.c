@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ * @file	receive.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests receiving with dynamic payload length against the nRF24L01
+ *			model in the simulator:
+ *			- Payloads of every width from 1 to 32 bytes end up whole in the
+ *			  buffer of the pipe they were received on
+ *			- Three payloads waiting in the RX FIFO for one RX_DR are all read
+ *			- A payload with a width above 32 is flushed, the next one is read
+ *			- 32 bytes can be sent, 33 are refused
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "nrf24l01/nrf24l01.h"
+#include "nrf24l01/nrf24l01_register_map.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+
+static uint8_t txAddress[5] = {0xE7, 0xD3, 0xF0, 0x35, 0x77};
+static uint8_t rxAddress1[5] = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2};
+static uint8_t rxAddress2[1] = {0xC3};
+static uint8_t rxAddress3[1] = {0xC4};
+static uint8_t rxAddress4[1] = {0xC5};
+static uint8_t rxAddress5[1] = {0xC6};
+
+static NRF24L01_Device nrf = {
+	.NRF24L01_DeviceName = "nRF24L01",
+	.CSN_Pin = GPIO_Pin_4, .CSN_GPIO = GPIOA,
+	.CE_Pin = GPIO_Pin_3, .CE_GPIO = GPIOA,
+	.IRQ_Pin = GPIO_Pin_0, .IRQ_GPIO = GPIOB,
+	.IRQ_GPIO_PortSource = GPIO_PortSourceGPIOB, .IRQ_GPIO_PinSource = GPIO_PinSource0,
+	.IRQ_EXTI_Line = EXTI_Line0, .IRQ_NVIC_IRQChannel = EXTI0_IRQn,
+	.SPIDevice = &spi1,
+	.addressWidth = NRF24L01AddressWidth_5bytes,
+	.RfChannel = 40,
+	.TxAddress = txAddress,
+	.RxAddress0 = txAddress, .RxAddress1 = rxAddress1, .RxAddress2 = rxAddress2,
+	.RxAddress3 = rxAddress3, .RxAddress4 = rxAddress4, .RxAddress5 = rxAddress5,
+	.DynamicPayloadLength = 1,
+};
+
+static void prvSent(SIM_Nrf24l01Slave* Model, const uint8_t* Payload, uint8_t Width);
+
+static SIM_Nrf24l01Slave model = { .CE_GPIO = GPIOA, .CE_Pin = GPIO_Pin_3, .IRQ_GPIO = GPIOB, .IRQ_Pin = GPIO_Pin_0,
+								   .Sent = prvSent };
+
+static uint8_t sentWidth;
+static uint8_t sentPayload[PAYLOAD_SIZE];
+
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What)
+{
+	if (!Condition && errors++ < 20)
+		printf("  %s failed\n", What);
+}
+
+static void prvSent(SIM_Nrf24l01Slave* Model, const uint8_t* Payload, uint8_t Width)
+{
+	(void)Model;
+	memcpy(sentPayload, Payload, PAYLOAD_SIZE);
+	sentWidth = Width;
+}
+
+/**
+ * @brief	Fills a payload with bytes that tell the width and the position apart
+ */
+static void prvFill(uint8_t* Payload, uint8_t Width)
+{
+	for (uint32_t i = 0; i < Width; i++)
+		Payload[i] = (uint8_t)(Width * 8 + i);
+}
+
+/**
+ * @brief	Checks that a pipe holds exactly a payload made by prvFill
+ */
+static uint8_t prvCheckPipe(uint8_t Pipe, uint8_t Width)
+{
+	uint8_t expected[PAYLOAD_SIZE];
+	uint8_t data[PAYLOAD_SIZE] = {};
+	prvFill(expected, Width);
+
+	if (NRF24L01_WaitForDataInPipe(&nrf, Pipe, Width, 10) != SUCCESS ||
+		NRF24L01_GetAvailableDataForPipe(&nrf, Pipe) != Width)
+		return 0;
+	NRF24L01_GetDataFromPipe(&nrf, Pipe, data, Width);
+	return memcmp(data, expected, Width) == 0;
+}
+
+static void prvTestTask(void* pvParameters)
+{
+	(void)pvParameters;
+	uint8_t payload[PAYLOAD_SIZE + 1];
+	SIM_Nrf24l01Slave_Init(&model, SPI1, GPIOA, GPIO_Pin_4);
+	prvExpect(NRF24L01_Init(&nrf) == SUCCESS, "NRF24L01_Init");
+	prvExpect(model.registers[FEATURE][0] == (1 << EN_DPL) && model.registers[DYNPD][0] == 0x3F, "dynamic payload length on");
+
+	/* Every width on the pipes in turn */
+	uint32_t wrongWidths = 0;
+	for (uint8_t width = 1; width <= PAYLOAD_SIZE; width++)
+	{
+		uint8_t pipe = width % 6;
+		prvFill(payload, width);
+		SIM_Nrf24l01Slave_Receive(&model, pipe, payload, width);
+		if (!prvCheckPipe(pipe, width))
+		{
+			wrongWidths++;
+			vTaskDelay(2);
+			NRF24L01_GetDataFromPipe(&nrf, pipe, payload, NRF24L01_GetAvailableDataForPipe(&nrf, pipe));
+		}
+	}
+	prvExpect(wrongWidths == 0, "widths 1 to 32 received whole");
+
+	/* The RX FIFO is full before the interrupt task gets to it */
+	taskENTER_CRITICAL();
+	prvFill(payload, 32);
+	SIM_Nrf24l01Slave_Receive(&model, 1, payload, 32);
+	prvFill(payload, 20);
+	SIM_Nrf24l01Slave_Receive(&model, 2, payload, 20);
+	prvFill(payload, 7);
+	SIM_Nrf24l01Slave_Receive(&model, 3, payload, 7);
+	taskEXIT_CRITICAL();
+	prvExpect(prvCheckPipe(1, 32), "first of three payloads");
+	prvExpect(prvCheckPipe(2, 20), "second of three payloads");
+	prvExpect(prvCheckPipe(3, 7), "third of three payloads");
+	prvExpect(model.rxCount == 0, "RX FIFO read empty");
+
+	/* A corrupt width is flushed and doesn't get in the way of the next payload */
+	prvFill(payload, 32);
+	SIM_Nrf24l01Slave_Receive(&model, 4, payload, 33);
+	vTaskDelay(2);
+	prvExpect(model.rxCount == 0, "corrupt payload flushed");
+	prvExpect(NRF24L01_GetAvailableDataForAllPipes(&nrf) == 0, "nothing from the corrupt payload");
+	prvFill(payload, 5);
+	SIM_Nrf24l01Slave_Receive(&model, 4, payload, 5);
+	prvExpect(prvCheckPipe(4, 5), "payload after the corrupt one");
+
+	/* Sending uses the same limits */
+	prvFill(payload, 33);
+	prvExpect(NRF24L01_WritePayload(&nrf, payload, 33) == ERROR, "33 bytes refused");
+	prvExpect(NRF24L01_WritePayload(&nrf, payload, 32) == SUCCESS, "32 bytes written");
+	vTaskDelay(5);
+	prvExpect(sentWidth == 32 && memcmp(sentPayload, payload, 32) == 0, "32 bytes sent");
+
+	printf("  widths 1 to 32: %lu wrong, three queued payloads and a corrupt one handled, 32 bytes sent\n",
+		   (unsigned long)wrongWidths);
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+void EXTI0_IRQHandler(void)
+{
+	if (EXTI_GetITStatus(nrf.IRQ_EXTI_Line) != RESET)
+	{
+		NRF24L01_Interrupt(&nrf);
+		EXTI_ClearITPendingBit(nrf.IRQ_EXTI_Line);
+	}
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	xTaskCreate(prvTestTask, "test", configMINIMAL_STACK_SIZE, 0, 2, 0);
+	vTaskStartScheduler();
+
+	printf("nrf24l01 receive: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/**
+ ******************************************************************************
+ * @file	stream.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests NRF24L01_StreamPayload against the nRF24L01 model in the
+ *			simulator. The model sends one payload every 300 us while CE is
+ *			high and the test task writes them as fast as it's let:
+ *			- Every payload is sent once and in order, the TX FIFO never
+ *			  overflows and CE stays high while there is something to send
+ *			- After MAX_RT the payloads in the FIFO are dropped and counted,
+ *			  the stream goes on and the TX FIFO counts all come back
+ *			- With send times from 1.4 us to 83 us the second payload of a
+ *			  two payload stream sometimes finishes while the interrupt task
+ *			  handles the first, the stream still stops with all counts back
+ *			- A stop that times out flushes the rest and gives all counts back
+ *			Built a second time as nrf24l01_stream_preempted with the interrupt
+ *			task below the test task and two byte payloads with dynamic payload
+ *			length, which SPI_TransferSegments polls. The test task then writes
+ *			the next payload as soon as the interrupt task gives a count back
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "nrf24l01/nrf24l01.h"
+#include "nrf24l01/nrf24l01_register_map.h"
+
+#include <stdio.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define PAYLOADS		(200)
+#define FAIL_AT			(50)		/* The payload written when the ACKs stop */
+#define TX_CYCLES		(SIM_CPU_CLOCK_HZ / 1000000 * 300)
+#define SWEEP_PAYLOADS	(2)
+#define SWEEP_FIRST		(100)		/* Send times in the sweep, in cycles */
+#define SWEEP_LAST		(6000)
+#define SWEEP_STEP		(7)
+
+#if defined(STREAM_PREEMPTED)
+#define DATA_COUNT		(2)
+#define DATA_START		(0)			/* With dynamic payload length the payload is just the data */
+#else
+#define DATA_COUNT		(MAX_DATA_COUNT)
+#define DATA_START		(1)			/* The data count comes first */
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+
+static uint8_t txAddress[5] = {0xE7, 0xD3, 0xF0, 0x35, 0x77};
+static uint8_t rxAddress1[5] = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2};
+static uint8_t rxAddress2[1] = {0xC3};
+static uint8_t rxAddress3[1] = {0xC4};
+static uint8_t rxAddress4[1] = {0xC5};
+static uint8_t rxAddress5[1] = {0xC6};
+
+static NRF24L01_Device nrf = {
+	.NRF24L01_DeviceName = "nRF24L01",
+	.CSN_Pin = GPIO_Pin_4, .CSN_GPIO = GPIOA,
+	.CE_Pin = GPIO_Pin_3, .CE_GPIO = GPIOA,
+	.IRQ_Pin = GPIO_Pin_0, .IRQ_GPIO = GPIOB,
+	.IRQ_GPIO_PortSource = GPIO_PortSourceGPIOB, .IRQ_GPIO_PinSource = GPIO_PinSource0,
+	.IRQ_EXTI_Line = EXTI_Line0, .IRQ_NVIC_IRQChannel = EXTI0_IRQn,
+	.SPIDevice = &spi1,
+	.addressWidth = NRF24L01AddressWidth_5bytes,
+	.RfChannel = 40,
+	.TxAddress = txAddress,
+	.RxAddress0 = txAddress, .RxAddress1 = rxAddress1, .RxAddress2 = rxAddress2,
+	.RxAddress3 = rxAddress3, .RxAddress4 = rxAddress4, .RxAddress5 = rxAddress5,
+	.DynamicPayloadLength = (DATA_START == 0),
+};
+
+static void prvSent(SIM_Nrf24l01Slave* Model, const uint8_t* Payload, uint8_t Width);
+
+static SIM_Nrf24l01Slave model = { .CE_GPIO = GPIOA, .CE_Pin = GPIO_Pin_3, .IRQ_GPIO = GPIOB, .IRQ_Pin = GPIO_Pin_0,
+								   .TxCycles = TX_CYCLES, .Sent = prvSent };
+
+static uint32_t sentPayloads;
+static int32_t lastSent;
+static uint32_t outOfOrder;
+
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What)
+{
+	if (!Condition && errors++ < 20)
+		printf("  %s failed\n", What);
+}
+
+/**
+ * @brief	Checks that the payloads go out whole and in order
+ */
+static void prvSent(SIM_Nrf24l01Slave* Model, const uint8_t* Payload, uint8_t Width)
+{
+	(void)Model;
+	int32_t number = Payload[DATA_START] | (Payload[DATA_START + 1] << 8);
+	uint8_t width = DATA_START ? PAYLOAD_SIZE : DATA_COUNT;
+	if (Width != width || (DATA_START && Payload[0] != DATA_COUNT) || number <= lastSent)
+		outOfOrder++;
+	lastSent = number;
+	sentPayloads++;
+}
+
+/**
+ * @brief	Streams Count payloads, the ACKs stop at FailAt if it's not -1
+ * @retval	The number of errors
+ */
+static uint32_t prvStream(int32_t Count, int32_t FailAt, uint64_t* Cycles, uint32_t* CeEdges)
+{
+	uint32_t errorsBefore = errors;
+	uint8_t data[DATA_COUNT] = {};
+	sentPayloads = 0;
+	lastSent = -1;
+	outOfOrder = 0;
+	nrf.TxStreamDropped = 0;
+
+	prvExpect(NRF24L01_StartTxStream(&nrf, 10) == SUCCESS, "NRF24L01_StartTxStream");
+	uint32_t ceEdges = model.ceEdges;
+	uint64_t start = SIM_GetCycles();
+	for (int32_t i = 0; i < Count; i++)
+	{
+		if (i == FailAt)
+			model.FailPayloads = 1;
+		data[0] = (uint8_t)i;
+		data[1] = (uint8_t)(i >> 8);
+		if (NRF24L01_StreamPayload(&nrf, data, DATA_COUNT, 10) != SUCCESS)
+		{
+			prvExpect(0, "NRF24L01_StreamPayload");
+			break;
+		}
+	}
+	/* The last payloads are still being sent */
+	*CeEdges = model.ceEdges - ceEdges;
+	prvExpect(NRF24L01_StopTxStream(&nrf, 10) == SUCCESS, "NRF24L01_StopTxStream");
+	*Cycles = SIM_GetCycles() - start;
+
+	prvExpect(outOfOrder == 0, "payloads sent in order");
+	prvExpect(model.txOverflows == 0, "no TX FIFO overflow");
+	prvExpect(uxQueueMessagesWaiting(nrf.xTxFifoSemaphore) == NRF24L01_TX_FIFO_SIZE, "TX FIFO counts back");
+	return errors - errorsBefore;
+}
+
+static void prvTestTask(void* pvParameters)
+{
+	(void)pvParameters;
+	SIM_Nrf24l01Slave_Init(&model, SPI1, GPIOA, GPIO_Pin_4);
+	prvExpect(NRF24L01_Init(&nrf) == SUCCESS, "NRF24L01_Init");
+
+	uint64_t cycles;
+	uint32_t ceEdges;
+	prvStream(PAYLOADS, -1, &cycles, &ceEdges);
+	prvExpect(sentPayloads == PAYLOADS, "every payload sent");
+	prvExpect(nrf.TxStreamDropped == 0, "nothing dropped");
+	/* CE goes high with the first payload and stays high */
+	prvExpect(ceEdges == 1, "CE left alone while streaming");
+	/* Sending all payloads takes PAYLOADS * TX_CYCLES, a little more for the first write */
+	prvExpect(cycles < (uint64_t)PAYLOADS * TX_CYCLES * 101 / 100, "no pauses between the payloads");
+	printf("  %u payloads in %.1f ms, %.1f us per payload, %lu CE edges while streaming\n",
+		   PAYLOADS, (double)cycles * 1000.0 / SIM_CPU_CLOCK_HZ,
+		   (double)cycles * 1000000.0 / SIM_CPU_CLOCK_HZ / PAYLOADS, (unsigned long)ceEdges);
+
+	prvStream(PAYLOADS, FAIL_AT, &cycles, &ceEdges);
+	prvExpect(nrf.TxStreamDropped > 0, "payloads dropped after MAX_RT");
+	prvExpect(sentPayloads + nrf.TxStreamDropped == PAYLOADS, "every payload sent or dropped");
+	printf("  MAX_RT at payload %u: %lu sent, %lu dropped\n",
+		   FAIL_AT, (unsigned long)sentPayloads, (unsigned long)nrf.TxStreamDropped);
+
+	/* Nothing is sent before the stop times out */
+	uint8_t data[DATA_COUNT] = {};
+	model.TxCycles = TX_CYCLES * 100;
+	prvExpect(NRF24L01_StartTxStream(&nrf, 10) == SUCCESS, "NRF24L01_StartTxStream");
+	for (uint32_t i = 0; i < NRF24L01_TX_FIFO_SIZE; i++)
+		prvExpect(NRF24L01_StreamPayload(&nrf, data, DATA_COUNT, 10) == SUCCESS, "NRF24L01_StreamPayload");
+	prvExpect(NRF24L01_StopTxStream(&nrf, 1) == ERROR, "NRF24L01_StopTxStream times out");
+	prvExpect(model.txCount == 0, "TX FIFO flushed");
+	prvExpect(uxQueueMessagesWaiting(nrf.xTxFifoSemaphore) == NRF24L01_TX_FIFO_SIZE, "TX FIFO counts back after the timeout");
+	prvExpect(xSemaphoreTake(nrf.xTxSemaphore, 0) == pdTRUE, "TX free after the timeout");
+	xSemaphoreGive(nrf.xTxSemaphore);
+
+	uint32_t streams = 0;
+	uint32_t failed = 0;
+	for (uint32_t txCycles = SWEEP_FIRST; txCycles <= SWEEP_LAST; txCycles += SWEEP_STEP)
+	{
+		model.TxCycles = txCycles;
+		if (prvStream(SWEEP_PAYLOADS, -1, &cycles, &ceEdges) != 0 || sentPayloads != SWEEP_PAYLOADS)
+			failed++;
+		streams++;
+	}
+	prvExpect(failed == 0, "every stream in the sweep stopped");
+	printf("  %lu streams of %u payloads sent in %u to %u cycles: %lu failed\n",
+		   (unsigned long)streams, SWEEP_PAYLOADS, SWEEP_FIRST, SWEEP_LAST, (unsigned long)failed);
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+void EXTI0_IRQHandler(void)
+{
+	if (EXTI_GetITStatus(nrf.IRQ_EXTI_Line) != RESET)
+	{
+		NRF24L01_Interrupt(&nrf);
+		EXTI_ClearITPendingBit(nrf.IRQ_EXTI_Line);
+	}
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	xTaskCreate(prvTestTask, "test", configMINIMAL_STACK_SIZE, 0, 2, 0);
+	vTaskStartScheduler();
+
+	printf("nrf24l01 stream: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
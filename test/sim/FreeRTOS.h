@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file	FreeRTOS.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	The parts of the FreeRTOS API that the drivers use, implemented
+ *			by the host simulator in rtos.c. Tasks are scheduled by priority
+ *			and preempted as soon as a higher priority task is ready, there
+ *			is no time slicing between tasks with the same priority
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define configCPU_CLOCK_HZ							(72000000UL)
+#define configTICK_RATE_HZ							(1000UL)
+#define configMAX_PRIORITIES						(5)
+#define configMINIMAL_STACK_SIZE					(128)
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY		(15)
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY	(5)
+
+#define pdFALSE				((BaseType_t)0)
+#define pdTRUE				((BaseType_t)1)
+#define pdPASS				(pdTRUE)
+#define pdFAIL				(pdFALSE)
+
+#define portMAX_DELAY		((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS	((TickType_t)1000 / configTICK_RATE_HZ)
+
+#define tskIDLE_PRIORITY	((UBaseType_t)0U)
+
+/* Typedefs ------------------------------------------------------------------*/
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+typedef struct SIM_Task* TaskHandle_t;
+typedef struct SIM_Semaphore* SemaphoreHandle_t;
+typedef struct SIM_Semaphore* QueueHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct
+{
+	TickType_t xTimeOnEntering;
+} TimeOut_t;
+
+/* Function prototypes -------------------------------------------------------*/
+void SIM_YieldFromISR(BaseType_t xHigherPriorityTaskWoken);
+void SIM_EnterCritical(void);
+void SIM_ExitCritical(void);
+UBaseType_t SIM_EnterCriticalFromISR(void);
+void SIM_ExitCriticalFromISR(UBaseType_t uxSavedInterruptStatus);
+
+#define portYIELD_FROM_ISR(x)				SIM_YieldFromISR(x)
+#define taskENTER_CRITICAL()				SIM_EnterCritical()
+#define taskEXIT_CRITICAL()					SIM_ExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR()		SIM_EnterCriticalFromISR()
+#define taskEXIT_CRITICAL_FROM_ISR(x)		SIM_ExitCriticalFromISR(x)
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,329 @@
+/**
+ ******************************************************************************
+ * @file	nrf24l01.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Model of the SPI command interface of an nRF24L01+, see the
+ *			command and register tables in the datasheet. The status is
+ *			shifted out with the command byte, the registers are read and
+ *			written LSByte first and a payload is removed from the RX FIFO
+ *			when chip select goes high after R_RX_PAYLOAD.
+ *			In TX mode the payloads are sent while CE is high. A payload
+ *			that is being sent when CE goes low is finished. MAX_RT stops
+ *			sending until it's cleared and leaves the payload in the FIFO
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_private.h"
+#include "nrf24l01/nrf24l01_register_map.h"
+
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define REGISTER_COUNT		(0x20)
+#define FIFO_SIZE			(3)
+#define PAYLOAD_MAX			(32)
+#define STATUS_FLAGS		((1 << RX_DR) | (1 << TX_DS) | (1 << MAX_RT))
+#define TX_CYCLES			(SIM_CPU_CLOCK_HZ / 1000000 * 300)
+#define TCWH_CYCLES			((SIM_CPU_CLOCK_HZ / 1000000 * 50 + 999) / 1000)	/* CSN inactive time, 50 ns */
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Gets the number of bytes in a register
+ */
+static uint8_t prvRegisterSize(uint8_t Register)
+{
+	if (Register == RX_ADDR_P0 || Register == RX_ADDR_P1 || Register == TX_ADDR)
+		return 5;
+	return 1;
+}
+
+/**
+ * @brief	Gets the STATUS register, RX_P_NO and TX_FULL follow the FIFOs
+ */
+static uint8_t prvStatus(SIM_Nrf24l01Slave* Model)
+{
+	uint8_t status = Model->registers[STATUS][0] & STATUS_FLAGS;
+	status |= (uint8_t)((Model->rxCount ? Model->rxPipes[0] : NO_DATA_IN_PIPE) << RX_P_NO);
+	if (Model->txCount == FIFO_SIZE)
+		status |= (1 << TX_FULL);
+	return status;
+}
+
+/**
+ * @brief	Gets the FIFO_STATUS register
+ */
+static uint8_t prvFifoStatus(SIM_Nrf24l01Slave* Model)
+{
+	uint8_t status = 0;
+	if (Model->txCount == FIFO_SIZE)
+		status |= (1 << FIFO_FULL);
+	if (Model->txCount == 0)
+		status |= (1 << TX_EMPTY);
+	if (Model->rxCount == FIFO_SIZE)
+		status |= (1 << RX_FULL);
+	if (Model->rxCount == 0)
+		status |= (1 << RX_EMPTY);
+	return status;
+}
+
+/**
+ * @brief	Drives the IRQ pin from the flags and the masks in CONFIG
+ */
+static void prvUpdateIrq(SIM_Nrf24l01Slave* Model)
+{
+	if (Model->IRQ_GPIO == 0)
+		return;
+	/* The MASK_ bits in CONFIG are at the same positions as the flags in STATUS */
+	uint8_t pending = Model->registers[STATUS][0] & STATUS_FLAGS & ~Model->registers[CONFIG][0];
+	SIM_SetInput(Model->IRQ_GPIO, Model->IRQ_Pin, pending ? 0 : 1);
+}
+
+/**
+ * @brief	Starts sending the first payload in the TX FIFO if the model is in TX mode
+ */
+static void prvStartTx(SIM_Nrf24l01Slave* Model)
+{
+	uint8_t config = Model->registers[CONFIG][0];
+	if (Model->txDone.scheduled || Model->txCount == 0 || (Model->registers[STATUS][0] & (1 << MAX_RT)) ||
+		!(config & (1 << PWR_UP)) || (config & (1 << PRIM_RX)))
+		return;
+	if (Model->CE_GPIO != 0 && !SIM_GetOutput(Model->CE_GPIO, Model->CE_Pin))
+		return;
+	SIM_Schedule(&Model->txDone, SIM_GetCycles() + (Model->TxCycles ? Model->TxCycles : TX_CYCLES));
+}
+
+/**
+ * @brief	A payload has been sent, it's acknowledged unless FailPayloads is set
+ */
+static void prvTxDone(SIM_Event* Event)
+{
+	SIM_Nrf24l01Slave* model = (SIM_Nrf24l01Slave*)Event->Context;
+	if (model->txCount == 0)
+		return;
+
+	if (model->FailPayloads != 0)
+	{
+		model->FailPayloads--;
+		model->registers[STATUS][0] |= (1 << MAX_RT);
+	}
+	else
+	{
+		if (model->Sent != 0)
+			model->Sent(model, model->txFifo[0], model->txWidths[0]);
+		model->sent++;
+		model->txCount--;
+		for (uint32_t i = 0; i < model->txCount; i++)
+		{
+			memcpy(model->txFifo[i], model->txFifo[i + 1], PAYLOAD_MAX);
+			model->txWidths[i] = model->txWidths[i + 1];
+		}
+		model->registers[STATUS][0] |= (1 << TX_DS);
+	}
+	prvUpdateIrq(model);
+	prvStartTx(model);
+}
+
+static void prvSelect(SIM_Slave* Slave)
+{
+	SIM_Nrf24l01Slave* model = (SIM_Nrf24l01Slave*)Slave->Context;
+	model->index = 0;
+	if (model->lastDeselect != 0 && SIM_GetCycles() - model->lastDeselect < TCWH_CYCLES)
+		model->shortCsHigh++;
+}
+
+static uint8_t prvExchange(SIM_Slave* Slave, uint8_t Mosi)
+{
+	SIM_Nrf24l01Slave* model = (SIM_Nrf24l01Slave*)Slave->Context;
+	if (model->index++ == 0)
+	{
+		model->command = Mosi;
+		model->commands++;
+		if ((Mosi & ~REGISTER_MASK) == W_REGISTER)
+			model->registerWrites++;
+		else if (Mosi == FLUSH_TX)
+		{
+			model->txCount = 0;
+			SIM_Cancel(&model->txDone);
+		}
+		else if (Mosi == FLUSH_RX)
+			model->rxCount = 0;
+		return prvStatus(model);
+	}
+
+	uint8_t data = model->index - 2;
+	uint8_t reg = model->command & REGISTER_MASK;
+	switch (model->command & ~REGISTER_MASK)
+	{
+		case R_REGISTER:
+			if (reg == STATUS)
+				return prvStatus(model);
+			if (reg == FIFO_STATUS)
+				return prvFifoStatus(model);
+			return (data < prvRegisterSize(reg)) ? model->registers[reg][data] : 0;
+
+		case W_REGISTER:
+			if (reg == STATUS)
+				model->registers[STATUS][0] &= ~(Mosi & STATUS_FLAGS);	/* Write 1 to clear */
+			else if (reg != FIFO_STATUS && data < prvRegisterSize(reg))
+				model->registers[reg][data] = Mosi;
+			if (reg == STATUS || reg == CONFIG)
+			{
+				prvUpdateIrq(model);
+				prvStartTx(model);
+			}
+			return 0;
+	}
+
+	switch (model->command)
+	{
+		case R_RX_PL_WID:
+			return model->rxCount ? model->rxWidths[0] : 0;
+
+		case R_RX_PAYLOAD:
+			return (model->rxCount && data < PAYLOAD_MAX) ? model->rxFifo[0][data] : 0;
+
+		case W_TX_PAYLOAD:
+			if (model->txCount == FIFO_SIZE)
+			{
+				if (data == 0)
+					model->txOverflows++;
+			}
+			else if (data < PAYLOAD_MAX)
+			{
+				model->txWrite[data] = Mosi;
+				model->txWriteWidth = data + 1;
+			}
+			return 0;
+
+		default:
+			return 0;
+	}
+}
+
+static void prvDeselect(SIM_Slave* Slave)
+{
+	SIM_Nrf24l01Slave* model = (SIM_Nrf24l01Slave*)Slave->Context;
+	model->lastDeselect = SIM_GetCycles();
+	if (model->index < 2)
+		return;
+
+	if (model->command == R_RX_PAYLOAD && model->rxCount != 0)
+	{
+		model->rxCount--;
+		for (uint32_t i = 0; i < model->rxCount; i++)
+		{
+			memcpy(model->rxFifo[i], model->rxFifo[i + 1], PAYLOAD_MAX);
+			model->rxWidths[i] = model->rxWidths[i + 1];
+			model->rxPipes[i] = model->rxPipes[i + 1];
+		}
+	}
+	else if (model->command == W_TX_PAYLOAD && model->txCount < FIFO_SIZE)
+	{
+		/* A payload can be sent while the next one is written, the slot isn't known until now */
+		memcpy(model->txFifo[model->txCount], model->txWrite, PAYLOAD_MAX);
+		model->txWidths[model->txCount] = model->txWriteWidth;
+		model->txCount++;
+		prvStartTx(model);
+	}
+}
+
+static void prvChipEnable(SIM_PinWatch* Watch, uint8_t Level)
+{
+	SIM_Nrf24l01Slave* model = (SIM_Nrf24l01Slave*)Watch->Context;
+	model->ceEdges++;
+	if (Level)
+		prvStartTx(model);
+}
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Initializes an nRF24L01 model in its power on state and attaches it to the bus
+ * @param	Model: the model, CE_GPIO/CE_Pin and IRQ_GPIO/IRQ_Pin have to be set before
+ * @param	SPIx: the bus
+ * @param	CS_GPIO: chip select port, CSN on the nRF24L01
+ * @param	CS_Pin: chip select pin
+ * @retval	None
+ */
+void SIM_Nrf24l01Slave_Init(SIM_Nrf24l01Slave* Model, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin)
+{
+	if (Model->Slave.Name == 0)
+		Model->Slave.Name = "nRF24L01";
+	Model->Slave.SPIx = SPIx;
+	Model->Slave.CS_GPIO = CS_GPIO;
+	Model->Slave.CS_Pin = CS_Pin;
+	Model->Slave.Select = prvSelect;
+	Model->Slave.Exchange = prvExchange;
+	Model->Slave.Deselect = prvDeselect;
+	Model->Slave.Context = Model;
+	SIM_AttachSlave(&Model->Slave);
+	Model->txDone.Callback = prvTxDone;
+	Model->txDone.Context = Model;
+
+	if (Model->CE_GPIO != 0)
+	{
+		Model->ceWatch.GPIOx = Model->CE_GPIO;
+		Model->ceWatch.Pin = Model->CE_Pin;
+		Model->ceWatch.Callback = prvChipEnable;
+		Model->ceWatch.Context = Model;
+		SIM_WatchPin(&Model->ceWatch);
+	}
+
+	SIM_Nrf24l01Slave_Reset(Model);
+}
+
+/**
+ * @brief	Sets the registers to their reset values and empties the FIFOs
+ * @param	Model: the model
+ * @retval	None
+ * @note	The counters are kept
+ */
+void SIM_Nrf24l01Slave_Reset(SIM_Nrf24l01Slave* Model)
+{
+	static const uint8_t resetValues[REGISTER_COUNT][5] = {
+		[CONFIG]		= {0x08},
+		[EN_AA]			= {0x3F},
+		[EN_RXADDR]		= {0x03},
+		[SETUP_AW]		= {0x03},
+		[SETUP_RETR]	= {0x03},
+		[RF_CH]			= {0x02},
+		[RF_SETUP]		= {0x0F},
+		[STATUS]		= {0x0E},
+		[RX_ADDR_P0]	= {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+		[RX_ADDR_P1]	= {0xC2, 0xC2, 0xC2, 0xC2, 0xC2},
+		[RX_ADDR_P2]	= {0xC3},
+		[RX_ADDR_P3]	= {0xC4},
+		[RX_ADDR_P4]	= {0xC5},
+		[RX_ADDR_P5]	= {0xC6},
+		[TX_ADDR]		= {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+	};
+	memcpy(Model->registers, resetValues, sizeof(resetValues));
+	Model->rxCount = 0;
+	Model->txCount = 0;
+	SIM_Cancel(&Model->txDone);
+	prvUpdateIrq(Model);
+}
+
+/**
+ * @brief	Puts a payload in the RX FIFO as if it was received and sets RX_DR
+ * @param	Model: the model
+ * @param	Pipe: the pipe it was received on
+ * @param	Payload: the payload, Width bytes but at most 32 are used
+ * @param	Width: the width R_RX_PL_WID returns, above 32 gives a corrupt payload
+ * @retval	1 if it was put in the FIFO, 0 if the RX FIFO was full and it was lost
+ */
+uint8_t SIM_Nrf24l01Slave_Receive(SIM_Nrf24l01Slave* Model, uint8_t Pipe, const uint8_t* Payload, uint8_t Width)
+{
+	if (Model->rxCount == FIFO_SIZE)
+		return 0;
+
+	memset(Model->rxFifo[Model->rxCount], 0, PAYLOAD_MAX);
+	memcpy(Model->rxFifo[Model->rxCount], Payload, (Width < PAYLOAD_MAX) ? Width : PAYLOAD_MAX);
+	Model->rxWidths[Model->rxCount] = Width;
+	Model->rxPipes[Model->rxCount] = Pipe;
+	Model->rxCount++;
+	Model->registers[STATUS][0] |= (1 << RX_DR);
+	prvUpdateIrq(Model);
+	return 1;
+}
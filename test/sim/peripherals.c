@@ -0,0 +1,846 @@
+/**
+ ******************************************************************************
+ * @file	peripherals.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Register level models of SPI1, SPI2, DMA1, GPIOA-C, EXTI, AFIO,
+ *			DWT and the NVIC.
+ *			- SPI: 8 bit full duplex master only. A byte written to DR goes to
+ *			  the TX buffer and from there to the shift register, a byte takes
+ *			  8 SPI clocks. A received byte that finds RXNE set is lost and
+ *			  sets OVR, like on the real device
+ *			- DMA: byte transfers between SPI DR and memory on the channels the
+ *			  SPI requests are mapped to, priority as in CCR and channel number.
+ *			  HT, TC, circular mode and the interrupts are modeled
+ *			- GPIO: pins are outputs when MODE in CRL/CRH is not 0, inputs are
+ *			  driven with SIM_SetInput() and can trigger EXTI lines
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_private.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define SPI_COUNT		(2)
+#define DMA_CHANNELS	(7)
+#define GPIO_COUNT		(3)
+
+#define DMA_CHANNEL_OFFSET(CHANNEL)	(0x08 + 0x14 * ((CHANNEL) - 1))
+#define DMA_FLAGS(CHANNEL, FLAGS)	((uint32_t)(FLAGS) << (4 * ((CHANNEL) - 1)))
+#define DMA_GIF					(0x1)
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef struct
+{
+	uint32_t base;
+	uint8_t index;
+	uint32_t apbDivider;		/* SYSCLK / PCLK */
+	IRQn_Type irq;
+	uint8_t rxChannel;			/* DMA1 channels of the requests */
+	uint8_t txChannel;
+
+	uint16_t cr1;
+	uint16_t cr2;
+	uint16_t crcpr;
+	uint8_t txBuffer;
+	uint8_t txFull;
+	uint8_t shifting;
+	uint8_t shiftByte;
+	uint8_t rxBuffer;
+	uint8_t rxne;
+	uint8_t ovr;
+	uint8_t srReadAfterOvr;		/* OVR is cleared by reading SR then DR */
+	SIM_Event byteDone;
+} SPI_State;
+
+typedef struct
+{
+	uint32_t ccr;
+	uint32_t cndtr;
+	uint32_t cpar;
+	uint32_t cmar;
+	uint32_t reload;			/* CNDTR when the channel was enabled */
+	uint32_t memory;			/* Address of the next memory access */
+	SPI_State* spi;
+	uint8_t rx;					/* The channel serves the RX request of spi */
+} DMA_ChannelState;
+
+typedef struct
+{
+	uint32_t base;
+	uint32_t crl;
+	uint32_t crh;
+	uint16_t odr;
+	uint16_t inputs;			/* Levels set with SIM_SetInput() */
+	uint16_t driven;			/* Pins SIM_SetInput() has been used on */
+	uint16_t levels;			/* Pin levels as the watchers last saw them */
+	uint8_t portSource;
+} GPIO_State;
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_State spiStates[SPI_COUNT] = {
+	{ .base = SPI1_BASE, .index = 0, .apbDivider = 1, .irq = SPI1_IRQn, .rxChannel = 2, .txChannel = 3 },
+	{ .base = SPI2_BASE, .index = 1, .apbDivider = 2, .irq = SPI2_IRQn, .rxChannel = 4, .txChannel = 5 },
+};
+
+static DMA_ChannelState dmaChannels[DMA_CHANNELS + 1];
+static uint32_t dmaISR;
+static SIM_Event dmaService;
+
+static GPIO_State gpioStates[GPIO_COUNT] = {
+	{ .base = GPIOA_BASE, .crl = 0x44444444, .crh = 0x44444444, .levels = 0xFFFF, .portSource = GPIO_PortSourceGPIOA },
+	{ .base = GPIOB_BASE, .crl = 0x44444444, .crh = 0x44444444, .levels = 0xFFFF, .portSource = GPIO_PortSourceGPIOB },
+	{ .base = GPIOC_BASE, .crl = 0x44444444, .crh = 0x44444444, .levels = 0xFFFF, .portSource = GPIO_PortSourceGPIOC },
+};
+static SIM_PinWatch* pinWatches;
+static SIM_Slave* slaves;
+
+static uint32_t afioEVCR;
+static uint32_t afioMAPR;
+static uint32_t afioEXTICR[4];
+
+static struct
+{
+	uint32_t imr;
+	uint32_t emr;
+	uint32_t rtsr;
+	uint32_t ftsr;
+	uint32_t pr;
+} exti;
+
+static uint32_t dwtCTRL;
+static uint64_t dwtOffset;		/* Time when CYCCNT was 0 */
+
+static uint8_t nvicEnabled[SIM_IRQ_COUNT];
+static uint8_t nvicPriority[SIM_IRQ_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvSPIByteDone(SIM_Event* Event);
+static void prvDMAService(SIM_Event* Event);
+static void prvDMAKick(void);
+static void prvGPIOUpdate(GPIO_State* GPIO);
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Finds the state of a SPI from its base address
+ */
+static SPI_State* prvFindSPI(uint32_t Base)
+{
+	for (uint32_t i = 0; i < SPI_COUNT; i++)
+	{
+		if (spiStates[i].base == Base)
+			return &spiStates[i];
+	}
+	return 0;
+}
+
+/**
+ * @brief	Finds the state of a GPIO port from its base address
+ */
+static GPIO_State* prvFindGPIO(uint32_t Base)
+{
+	for (uint32_t i = 0; i < GPIO_COUNT; i++)
+	{
+		if (gpioStates[i].base == Base)
+			return &gpioStates[i];
+	}
+	return 0;
+}
+
+/**
+ * @brief	Connects the DMA channels to the SPI requests
+ */
+__attribute__((constructor)) static void prvInitPeripherals(void)
+{
+	for (uint32_t i = 0; i < SPI_COUNT; i++)
+	{
+		SPI_State* spi = &spiStates[i];
+		spi->byteDone.Callback = prvSPIByteDone;
+		spi->byteDone.Context = spi;
+		dmaChannels[spi->rxChannel].spi = spi;
+		dmaChannels[spi->rxChannel].rx = 1;
+		dmaChannels[spi->txChannel].spi = spi;
+	}
+	dmaService.Callback = prvDMAService;
+}
+
+/* SPI -----------------------------------------------------------------------*/
+/**
+ * @brief	Gets SR of a SPI
+ */
+static uint16_t prvSPIStatus(SPI_State* SPI)
+{
+	uint16_t status = 0;
+	if (SPI->rxne)
+		status |= SPI_SR_RXNE;
+	if (!SPI->txFull)
+		status |= SPI_SR_TXE;
+	if (SPI->ovr)
+		status |= SPI_SR_OVR;
+	if (SPI->shifting || SPI->txFull)
+		status |= SPI_SR_BSY;
+	return status;
+}
+
+/**
+ * @brief	Moves the TX buffer to the shift register
+ */
+static void prvSPIStartShift(SPI_State* SPI)
+{
+	uint32_t prescaler = 2U << ((SPI->cr1 & SPI_CR1_BR) >> 3);
+	SPI->shiftByte = SPI->txBuffer;
+	SPI->txFull = 0;
+	SPI->shifting = 1;
+	uint64_t byteCycles = 8ULL * prescaler * SPI->apbDivider;
+	simStatistics.spiBusyCycles[SPI->index] += byteCycles;
+	SIM_Schedule(&SPI->byteDone, SIM_GetCycles() + byteCycles);
+}
+
+/**
+ * @brief	Exchanges a byte with the selected slave, MISO is pulled up if no
+ *			slave is selected
+ */
+static uint8_t prvSPIExchange(SPI_State* SPI, uint8_t Mosi)
+{
+	SIM_Slave* selected = 0;
+	for (SIM_Slave* slave = slaves; slave != 0; slave = slave->next)
+	{
+		if ((uint32_t)(uintptr_t)slave->SPIx != SPI->base || !slave->selected)
+			continue;
+		if (selected != 0)
+			SIM_Fatal("%s and %s are selected at the same time", selected->Name, slave->Name);
+		selected = slave;
+	}
+
+	if (selected == 0)
+		return 0xFF;
+
+	selected->bytes++;
+	selected->bytesThisSelect++;
+	return selected->Exchange(selected, Mosi);
+}
+
+/**
+ * @brief	Called when the shift register is done with a byte
+ */
+static void prvSPIByteDone(SIM_Event* Event)
+{
+	SPI_State* spi = (SPI_State*)Event->Context;
+	uint8_t miso = prvSPIExchange(spi, spi->shiftByte);
+	simStatistics.spiBytes[spi->index]++;
+	spi->shifting = 0;
+
+	if (spi->rxne)
+	{
+		spi->ovr = 1;
+		spi->srReadAfterOvr = 0;
+		simStatistics.spiOverruns[spi->index]++;
+	}
+	else
+	{
+		spi->rxBuffer = miso;
+		spi->rxne = 1;
+	}
+
+	if (spi->txFull && (spi->cr1 & SPI_CR1_SPE))
+		prvSPIStartShift(spi);
+	prvDMAKick();
+}
+
+/**
+ * @brief	Writes DR
+ */
+static void prvSPIWriteData(SPI_State* SPI, uint32_t Value)
+{
+	if (!(SPI->cr1 & SPI_CR1_SPE))
+		return;
+
+	/* A write while TXE is 0 overwrites the TX buffer, as on the real device */
+	SPI->txBuffer = (uint8_t)Value;
+	SPI->txFull = 1;
+	if (!SPI->shifting)
+		prvSPIStartShift(SPI);
+	prvDMAKick();
+}
+
+/**
+ * @brief	Reads DR
+ */
+static uint8_t prvSPIReadData(SPI_State* SPI)
+{
+	SPI->rxne = 0;
+	if (SPI->ovr && SPI->srReadAfterOvr)
+		SPI->ovr = 0;
+	prvDMAKick();
+	return SPI->rxBuffer;
+}
+
+/**
+ * @brief	Writes CR1
+ */
+static void prvSPIWriteControl(SPI_State* SPI, uint32_t Value)
+{
+	if (Value & SPI_CR1_DFF)
+		SIM_Fatal("SPI 0x%08X: 16 bit frames are not modeled", SPI->base);
+	if ((Value & SPI_CR1_SPE) && !(Value & SPI_CR1_MSTR))
+		SIM_Fatal("SPI 0x%08X: slave mode is not modeled", SPI->base);
+
+	SPI->cr1 = (uint16_t)Value;
+	if (SPI->txFull && !SPI->shifting && (SPI->cr1 & SPI_CR1_SPE))
+		prvSPIStartShift(SPI);
+	prvDMAKick();
+}
+
+static uint32_t prvSPIAccess(SPI_State* SPI, uint32_t Offset, uint8_t Read)
+{
+	switch (Offset)
+	{
+		case 0x00: return SPI->cr1;
+		case 0x04: return SPI->cr2;
+		case 0x08:
+			if (Read && SPI->ovr)
+				SPI->srReadAfterOvr = 1;
+			return prvSPIStatus(SPI);
+		case 0x0C: return Read ? prvSPIReadData(SPI) : SPI->rxBuffer;
+		case 0x10: return SPI->crcpr;
+		default: return 0;
+	}
+}
+
+static void prvSPIWrite(SPI_State* SPI, uint32_t Offset, uint32_t Value)
+{
+	switch (Offset)
+	{
+		case 0x00: prvSPIWriteControl(SPI, Value); break;
+		case 0x04: SPI->cr2 = (uint16_t)(Value & 0xE7); prvDMAKick(); break;
+		case 0x0C: prvSPIWriteData(SPI, Value); break;
+		case 0x10: SPI->crcpr = (uint16_t)Value; break;
+		default: break;
+	}
+}
+
+/* DMA -----------------------------------------------------------------------*/
+/**
+ * @brief	Checks if a channel has a request it can serve
+ */
+static uint8_t prvDMARequest(uint32_t Channel)
+{
+	DMA_ChannelState* channel = &dmaChannels[Channel];
+	if (!(channel->ccr & DMA_CCR1_EN) || channel->cndtr == 0 || channel->spi == 0)
+		return 0;
+
+	SPI_State* spi = channel->spi;
+	if (channel->rx)
+		return (spi->cr2 & SPI_CR2_RXDMAEN) && spi->rxne;
+	else
+		return (spi->cr2 & SPI_CR2_TXDMAEN) && (spi->cr1 & SPI_CR1_SPE) && !spi->txFull;
+}
+
+/**
+ * @brief	Schedules the DMA if a channel has a request
+ */
+static void prvDMAKick(void)
+{
+	if (dmaService.scheduled)
+		return;
+
+	for (uint32_t i = 1; i <= DMA_CHANNELS; i++)
+	{
+		if (prvDMARequest(i))
+		{
+			SIM_Schedule(&dmaService, SIM_GetCycles() + SIM_DMA_CYCLES);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief	Moves one byte for the channel with the highest priority
+ */
+static void prvDMAService(SIM_Event* Event)
+{
+	(void)Event;
+	uint32_t selected = 0;
+	for (uint32_t i = 1; i <= DMA_CHANNELS; i++)
+	{
+		if (prvDMARequest(i) && (selected == 0 ||
+			(dmaChannels[i].ccr & DMA_CCR1_PL) > (dmaChannels[selected].ccr & DMA_CCR1_PL)))
+			selected = i;
+	}
+	if (selected == 0)
+		return;
+
+	DMA_ChannelState* channel = &dmaChannels[selected];
+	SPI_State* spi = channel->spi;
+	if (channel->cpar != spi->base + 0x0C)
+		SIM_Fatal("DMA1 channel %u: CPAR is 0x%08X, not DR of the SPI the channel serves", (unsigned)selected, channel->cpar);
+
+	if (channel->ccr & DMA_CCR1_DIR)
+		prvSPIWriteData(spi, *(volatile uint8_t*)(uintptr_t)channel->memory);
+	else
+		*(volatile uint8_t*)(uintptr_t)channel->memory = prvSPIReadData(spi);
+	simStatistics.dmaTransfers++;
+
+	if (channel->ccr & DMA_CCR1_MINC)
+		channel->memory++;
+	channel->cndtr--;
+
+	uint32_t done = channel->reload - channel->cndtr;
+	if (channel->reload >= 2 && done == channel->reload / 2)
+		dmaISR |= DMA_FLAGS(selected, DMA_IT_HT | DMA_GIF);
+	if (channel->cndtr == 0)
+	{
+		dmaISR |= DMA_FLAGS(selected, DMA_IT_TC | DMA_GIF);
+		if (channel->ccr & DMA_CCR1_CIRC)
+		{
+			channel->cndtr = channel->reload;
+			channel->memory = channel->cmar;
+		}
+	}
+	prvDMAKick();
+}
+
+/**
+ * @brief	Writes CCR of a channel
+ */
+static void prvDMAWriteControl(uint32_t Channel, uint32_t Value)
+{
+	DMA_ChannelState* channel = &dmaChannels[Channel];
+	uint32_t old = channel->ccr;
+	channel->ccr = Value & 0x7FFF;
+
+	if (!(old & DMA_CCR1_EN) && (Value & DMA_CCR1_EN))
+	{
+		if (Value & (DMA_CCR1_PSIZE | DMA_CCR1_MSIZE))
+			SIM_Fatal("DMA1 channel %u: only byte transfers are modeled", (unsigned)Channel);
+		if (Value & (DMA_CCR1_MEM2MEM | DMA_CCR1_PINC))
+			SIM_Fatal("DMA1 channel %u: only peripheral transfers to a fixed address are modeled", (unsigned)Channel);
+		if (channel->spi == 0)
+			SIM_Fatal("DMA1 channel %u has no SPI request", (unsigned)Channel);
+		channel->reload = channel->cndtr;
+		channel->memory = channel->cmar;
+	}
+	prvDMAKick();
+}
+
+static uint32_t prvDMARead(uint32_t Offset)
+{
+	if (Offset == 0x00)
+		return dmaISR;
+	if (Offset < 0x08 || Offset >= DMA_CHANNEL_OFFSET(DMA_CHANNELS + 1))
+		return 0;
+
+	uint32_t channelIndex = (Offset - 0x08) / 0x14 + 1;
+	DMA_ChannelState* channel = &dmaChannels[channelIndex];
+	switch ((Offset - 0x08) % 0x14)
+	{
+		case 0x00: return channel->ccr;
+		case 0x04: return channel->cndtr;
+		case 0x08: return channel->cpar;
+		case 0x0C: return channel->cmar;
+		default: return 0;
+	}
+}
+
+static void prvDMAWrite(uint32_t Offset, uint32_t Value)
+{
+	if (Offset == 0x04)
+	{
+		/* IFCR, the global bit clears all flags of the channel */
+		for (uint32_t i = 1; i <= DMA_CHANNELS; i++)
+		{
+			uint32_t flags = (Value >> (4 * (i - 1))) & 0xF;
+			if (flags & DMA_GIF)
+				flags = 0xF;
+			dmaISR &= ~DMA_FLAGS(i, flags);
+		}
+		return;
+	}
+	if (Offset < 0x08 || Offset >= DMA_CHANNEL_OFFSET(DMA_CHANNELS + 1))
+		return;
+
+	uint32_t channelIndex = (Offset - 0x08) / 0x14 + 1;
+	DMA_ChannelState* channel = &dmaChannels[channelIndex];
+	uint8_t enabled = (channel->ccr & DMA_CCR1_EN) != 0;
+	switch ((Offset - 0x08) % 0x14)
+	{
+		case 0x00: prvDMAWriteControl(channelIndex, Value); break;
+		/* The other registers can't be written while the channel is enabled */
+		case 0x04: if (!enabled) channel->cndtr = Value & 0xFFFF; break;
+		case 0x08: if (!enabled) channel->cpar = Value; break;
+		case 0x0C: if (!enabled) channel->cmar = Value; break;
+		default: break;
+	}
+}
+
+/* GPIO, AFIO and EXTI -------------------------------------------------------*/
+/**
+ * @brief	Gets the configuration nibble of a pin from CRL/CRH
+ */
+static uint32_t prvGPIOConfig(GPIO_State* GPIO, uint32_t PinNumber)
+{
+	if (PinNumber < 8)
+		return (GPIO->crl >> (4 * PinNumber)) & 0xF;
+	else
+		return (GPIO->crh >> (4 * (PinNumber - 8))) & 0xF;
+}
+
+/**
+ * @brief	Gets the level of all pins. Outputs follow ODR, inputs follow
+ *			SIM_SetInput() and are pulled as in ODR or read as high when
+ *			floating and not driven
+ */
+static uint16_t prvGPIOLevels(GPIO_State* GPIO)
+{
+	uint16_t levels = 0;
+	for (uint32_t pin = 0; pin < 16; pin++)
+	{
+		uint32_t config = prvGPIOConfig(GPIO, pin);
+		uint16_t mask = (uint16_t)(1U << pin);
+		uint8_t level;
+		if ((config & 0x3) != 0)
+			level = (GPIO->odr & mask) != 0;
+		else if (GPIO->driven & mask)
+			level = (GPIO->inputs & mask) != 0;
+		else if ((config >> 2) == 0x2)
+			level = (GPIO->odr & mask) != 0;
+		else
+			level = 1;
+
+		if (level)
+			levels |= mask;
+	}
+	return levels;
+}
+
+/**
+ * @brief	Finds pin changes, calls the watchers and sets EXTI pending bits
+ */
+static void prvGPIOUpdate(GPIO_State* GPIO)
+{
+	uint16_t levels = prvGPIOLevels(GPIO);
+	uint16_t changed = levels ^ GPIO->levels;
+	GPIO->levels = levels;
+	if (changed == 0)
+		return;
+
+	for (uint32_t pin = 0; pin < 16; pin++)
+	{
+		uint32_t mask = 1U << pin;
+		if (!(changed & mask))
+			continue;
+
+		uint32_t source = (afioEXTICR[pin / 4] >> (4 * (pin % 4))) & 0xF;
+		if (source == GPIO->portSource)
+		{
+			if (((levels & mask) && (exti.rtsr & mask)) || (!(levels & mask) && (exti.ftsr & mask)))
+				exti.pr |= mask;
+		}
+	}
+
+	for (SIM_PinWatch* watch = pinWatches; watch != 0; watch = watch->next)
+	{
+		if ((uint32_t)(uintptr_t)watch->GPIOx == GPIO->base && (changed & watch->Pin))
+			watch->Callback(watch, (levels & watch->Pin) != 0);
+	}
+}
+
+static uint32_t prvGPIORead(GPIO_State* GPIO, uint32_t Offset)
+{
+	switch (Offset)
+	{
+		case 0x00: return GPIO->crl;
+		case 0x04: return GPIO->crh;
+		case 0x08: return prvGPIOLevels(GPIO);
+		case 0x0C: return GPIO->odr;
+		default: return 0;
+	}
+}
+
+static void prvGPIOWrite(GPIO_State* GPIO, uint32_t Offset, uint32_t Value)
+{
+	switch (Offset)
+	{
+		case 0x00: GPIO->crl = Value; break;
+		case 0x04: GPIO->crh = Value; break;
+		case 0x0C: GPIO->odr = (uint16_t)Value; break;
+		/* Set has priority over reset in BSRR */
+		case 0x10: GPIO->odr = (uint16_t)((GPIO->odr & ~(Value >> 16)) | (Value & 0xFFFF)); break;
+		case 0x14: GPIO->odr = (uint16_t)(GPIO->odr & ~Value); break;
+		default: return;
+	}
+	prvGPIOUpdate(GPIO);
+}
+
+static uint32_t prvAFIOAndEXTIRead(uint32_t Offset)
+{
+	switch (Offset)
+	{
+		case 0x000: return afioEVCR;
+		case 0x004: return afioMAPR;
+		case 0x008: case 0x00C: case 0x010: case 0x014: return afioEXTICR[(Offset - 0x008) / 4];
+		case 0x400: return exti.imr;
+		case 0x404: return exti.emr;
+		case 0x408: return exti.rtsr;
+		case 0x40C: return exti.ftsr;
+		case 0x410: return 0;
+		case 0x414: return exti.pr;
+		default: return 0;
+	}
+}
+
+static void prvAFIOAndEXTIWrite(uint32_t Offset, uint32_t Value)
+{
+	switch (Offset)
+	{
+		case 0x000: afioEVCR = Value; break;
+		case 0x004: afioMAPR = Value; break;
+		case 0x008: case 0x00C: case 0x010: case 0x014: afioEXTICR[(Offset - 0x008) / 4] = Value & 0xFFFF; break;
+		case 0x400: exti.imr = Value & 0xFFFFF; break;
+		case 0x404: exti.emr = Value & 0xFFFFF; break;
+		case 0x408: exti.rtsr = Value & 0xFFFFF; break;
+		case 0x40C: exti.ftsr = Value & 0xFFFFF; break;
+		case 0x410: exti.pr |= Value & exti.imr; break;
+		case 0x414: exti.pr &= ~Value; break;
+		default: break;
+	}
+}
+
+/* Address decoding ----------------------------------------------------------*/
+typedef enum
+{
+	ACCESS_PEEK,
+	ACCESS_READ,
+} AccessType;
+
+static uint32_t prvRead(uint32_t Address, AccessType Type)
+{
+	SPI_State* spi = prvFindSPI(Address & ~0x3FFU);
+	if (spi != 0)
+		return prvSPIAccess(spi, Address & 0x3FF, Type == ACCESS_READ);
+
+	GPIO_State* gpio = prvFindGPIO(Address & ~0x3FFU);
+	if (gpio != 0)
+		return prvGPIORead(gpio, Address & 0x3FF);
+
+	if (Address >= AFIO_BASE && Address < EXTI_BASE + 0x400)
+		return prvAFIOAndEXTIRead(Address - AFIO_BASE);
+	if (Address >= DMA1_BASE && Address < DMA1_BASE + 0x400)
+		return prvDMARead(Address - DMA1_BASE);
+	if (Address == (uint32_t)(uintptr_t)&DWT->CTRL)
+		return dwtCTRL;
+	if (Address == (uint32_t)(uintptr_t)&DWT->CYCCNT)
+		return (uint32_t)(SIM_GetCycles() - dwtOffset);
+	return 0;
+}
+
+/**
+ * @brief	Follows the chip select pin of a slave
+ */
+static void prvSlaveChipSelect(SIM_PinWatch* Watch, uint8_t Level)
+{
+	SIM_Slave* slave = (SIM_Slave*)Watch->Context;
+	if (!Level && !slave->selected)
+	{
+		slave->selected = 1;
+		slave->selects++;
+		slave->bytesThisSelect = 0;
+		if (slave->Select != 0)
+			slave->Select(slave);
+	}
+	else if (Level && slave->selected)
+	{
+		slave->selected = 0;
+		slave->deselects++;
+		if (slave->bytesThisSelect == 0)
+			slave->emptySelects++;
+		if (slave->Deselect != 0)
+			slave->Deselect(slave);
+	}
+}
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Reads a register with the side effects of a read
+ * @param	Address: the register address, word aligned
+ * @retval	The value
+ */
+uint32_t SIM_PeripheralRead(uint32_t Address)
+{
+	return prvRead(Address, ACCESS_READ);
+}
+
+/**
+ * @brief	Gets the value of a register without side effects
+ * @param	Address: the register address, word aligned
+ * @retval	The value
+ */
+uint32_t SIM_PeripheralPeek(uint32_t Address)
+{
+	return prvRead(Address, ACCESS_PEEK);
+}
+
+/**
+ * @brief	Writes a register
+ * @param	Address: the register address, word aligned
+ * @param	Value: the value
+ * @retval	None
+ */
+void SIM_PeripheralWrite(uint32_t Address, uint32_t Value)
+{
+	SPI_State* spi = prvFindSPI(Address & ~0x3FFU);
+	if (spi != 0)
+	{
+		prvSPIWrite(spi, Address & 0x3FF, Value & 0xFFFF);
+		return;
+	}
+
+	GPIO_State* gpio = prvFindGPIO(Address & ~0x3FFU);
+	if (gpio != 0)
+	{
+		prvGPIOWrite(gpio, Address & 0x3FF, Value);
+		return;
+	}
+
+	if (Address >= AFIO_BASE && Address < EXTI_BASE + 0x400)
+		prvAFIOAndEXTIWrite(Address - AFIO_BASE, Value);
+	else if (Address >= DMA1_BASE && Address < DMA1_BASE + 0x400)
+		prvDMAWrite(Address - DMA1_BASE, Value);
+	else if (Address == (uint32_t)(uintptr_t)&DWT->CTRL)
+		dwtCTRL = Value;
+	else if (Address == (uint32_t)(uintptr_t)&DWT->CYCCNT)
+		dwtOffset = SIM_GetCycles() - Value;
+}
+
+/**
+ * @brief	Sets the NVIC state of an interrupt
+ * @param	IRQn: the interrupt
+ * @param	Priority: preemption priority, lower is more important
+ * @param	Enable: 1 to enable, 0 to disable
+ * @retval	None
+ */
+void SIM_ConfigureInterrupt(uint8_t IRQn, uint8_t Priority, uint8_t Enable)
+{
+	if (IRQn >= SIM_IRQ_COUNT)
+		SIM_Fatal("IRQn %u is out of range", (unsigned)IRQn);
+	nvicPriority[IRQn] = Priority;
+	nvicEnabled[IRQn] = Enable;
+}
+
+/**
+ * @brief	Checks if a peripheral asserts an interrupt
+ */
+static uint8_t prvInterruptLine(uint32_t IRQn)
+{
+	for (uint32_t i = 0; i < SPI_COUNT; i++)
+	{
+		SPI_State* spi = &spiStates[i];
+		if (spi->irq == (IRQn_Type)IRQn)
+			return ((spi->cr2 & SPI_CR2_RXNEIE) && spi->rxne) ||
+				   ((spi->cr2 & SPI_CR2_TXEIE) && !spi->txFull) ||
+				   ((spi->cr2 & SPI_CR2_ERRIE) && spi->ovr);
+	}
+
+	if (IRQn >= DMA1_Channel1_IRQn && IRQn <= DMA1_Channel7_IRQn)
+	{
+		uint32_t channel = IRQn - DMA1_Channel1_IRQn + 1;
+		uint32_t flags = (dmaISR >> (4 * (channel - 1))) & 0xF;
+		return (dmaChannels[channel].ccr & (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE) & flags) != 0;
+	}
+
+	uint32_t lines = exti.pr & exti.imr;
+	if (IRQn >= EXTI0_IRQn && IRQn <= EXTI4_IRQn)
+		return (lines & (1U << (IRQn - EXTI0_IRQn))) != 0;
+	if (IRQn == EXTI9_5_IRQn)
+		return (lines & 0x03E0) != 0;
+	if (IRQn == EXTI15_10_IRQn)
+		return (lines & 0xFC00) != 0;
+	return 0;
+}
+
+/**
+ * @brief	Gets the interrupt the NVIC would take
+ * @param	None
+ * @retval	The IRQn with the lowest priority value that is enabled and
+ *			asserted, the lowest number wins a tie. -1 if there is none
+ */
+int32_t SIM_GetPendingInterrupt(void)
+{
+	int32_t selected = -1;
+	for (uint32_t irq = 0; irq < SIM_IRQ_COUNT; irq++)
+	{
+		if (!nvicEnabled[irq] || !prvInterruptLine(irq))
+			continue;
+		if (selected < 0 || nvicPriority[irq] < nvicPriority[selected])
+			selected = (int32_t)irq;
+	}
+	return selected;
+}
+
+/**
+ * @brief	Calls a function when the level of a pin changes
+ * @param	Watch: GPIOx, Pin and Callback have to be set
+ * @retval	None
+ */
+void SIM_WatchPin(SIM_PinWatch* Watch)
+{
+	if (prvFindGPIO((uint32_t)(uintptr_t)Watch->GPIOx) == 0)
+		SIM_Fatal("port 0x%08X is not modeled", (unsigned)(uintptr_t)Watch->GPIOx);
+	Watch->next = pinWatches;
+	pinWatches = Watch;
+}
+
+/**
+ * @brief	Connects a slave to a bus
+ * @param	Slave: the slave, the fields above "Kept by the simulator" have to be set
+ * @retval	None
+ */
+void SIM_AttachSlave(SIM_Slave* Slave)
+{
+	if (prvFindSPI((uint32_t)(uintptr_t)Slave->SPIx) == 0)
+		SIM_Fatal("%s: SPI 0x%08X is not modeled", Slave->Name, (unsigned)(uintptr_t)Slave->SPIx);
+
+	Slave->selected = !SIM_GetOutput(Slave->CS_GPIO, Slave->CS_Pin);
+	Slave->csWatch.GPIOx = Slave->CS_GPIO;
+	Slave->csWatch.Pin = Slave->CS_Pin;
+	Slave->csWatch.Callback = prvSlaveChipSelect;
+	Slave->csWatch.Context = Slave;
+	SIM_WatchPin(&Slave->csWatch);
+	Slave->next = slaves;
+	slaves = Slave;
+}
+
+/**
+ * @brief	Drives an input pin from outside
+ * @param	GPIOx: the port
+ * @param	Pin: GPIO_Pin_x
+ * @param	Level: 0 or 1
+ * @retval	None
+ */
+void SIM_SetInput(GPIO_TypeDef* GPIOx, uint16_t Pin, uint8_t Level)
+{
+	GPIO_State* gpio = prvFindGPIO((uint32_t)(uintptr_t)GPIOx);
+	if (gpio == 0)
+		SIM_Fatal("port 0x%08X is not modeled", (unsigned)(uintptr_t)GPIOx);
+
+	gpio->driven |= Pin;
+	if (Level)
+		gpio->inputs |= Pin;
+	else
+		gpio->inputs &= (uint16_t)~Pin;
+	prvGPIOUpdate(gpio);
+}
+
+/**
+ * @brief	Gets the level of a pin
+ * @param	GPIOx: the port
+ * @param	Pin: GPIO_Pin_x
+ * @retval	0 or 1
+ */
+uint8_t SIM_GetOutput(GPIO_TypeDef* GPIOx, uint16_t Pin)
+{
+	GPIO_State* gpio = prvFindGPIO((uint32_t)(uintptr_t)GPIOx);
+	if (gpio == 0)
+		SIM_Fatal("port 0x%08X is not modeled", (unsigned)(uintptr_t)GPIOx);
+	return (prvGPIOLevels(gpio) & Pin) != 0;
+}
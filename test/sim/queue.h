@@ -1,25 +1,23 @@
 /**
  ******************************************************************************
- * @file	rf_spi1.h
+ * @file	queue.h
  * @author	Hampus Sandberg
  * @version	0.1
- * @date	2013-07-15
- * @brief	Manage SPI1
+ * @date	2014-11-23
+ * @brief	Queue functions of the FreeRTOS API for the host simulator, only
+ *			the ones that also work on semaphores
  ******************************************************************************
  */
 
 /* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef RF_SPI1_H_
-#define RF_SPI1_H_
+#ifndef INC_QUEUE_H
+#define INC_QUEUE_H
 
 /* Includes ------------------------------------------------------------------*/
-#include "stm32f10x.h"
+#include "FreeRTOS.h"
 
-/* Defines -------------------------------------------------------------------*/
-/* Typedefs ------------------------------------------------------------------*/
 /* Function prototypes -------------------------------------------------------*/
-void RF_SPI1_Init();
-uint8_t RF_SPI1_WriteRead(uint8_t Data);
-void RF_SPI1_Write(uint8_t Data);
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue);
+UBaseType_t uxQueueMessagesWaitingFromISR(const QueueHandle_t xQueue);
 
-#endif /* RF_SPI1_H_ */
+#endif /* INC_QUEUE_H */
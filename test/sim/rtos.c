@@ -0,0 +1,596 @@
+/**
+ ******************************************************************************
+ * @file	rtos.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	The part of FreeRTOS the drivers use, for the simulator.
+ *			Every task runs on its own stack with ucontext. The highest
+ *			priority task that is ready runs, tasks with the same priority
+ *			run in the order they got ready and there is no time slicing.
+ *			A task that is woken preempts the running task:
+ *			- at once if it was woken by a task
+ *			- at the end of the interrupt if the handler woke it and called
+ *			  portYIELD_FROM_ISR(pdTRUE)
+ *			- at the next tick if the handler woke it without yielding
+ *			vTaskStartScheduler() returns when no task is ready and nothing
+ *			can wake one, which is how the tests end.
+ *			Calls that are wrong on the real system, like blocking in an
+ *			interrupt handler or a critical section, stop the simulation
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "sim_private.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define TASK_STACK_SIZE		(256 * 1024)
+
+/* Private typedefs ----------------------------------------------------------*/
+typedef enum
+{
+	TaskState_Ready,
+	TaskState_Blocked,
+	TaskState_Deleted,
+} TaskState;
+
+struct SIM_Task
+{
+	ucontext_t context;
+	void* stack;
+	TaskFunction_t function;
+	void* parameters;
+	const char* name;
+	UBaseType_t priority;
+
+	TaskState state;
+	uint64_t readyOrder;			/* Orders the ready tasks with the same priority */
+	SIM_Event timeout;
+	uint8_t timedOut;
+	struct SIM_Semaphore* waitingOn;
+	uint8_t waitingForNotify;
+	uint32_t notifyValue;
+
+	struct SIM_Task* next;			/* All tasks */
+	struct SIM_Task* nextWaiter;	/* Tasks waiting for the same semaphore */
+};
+
+struct SIM_Semaphore
+{
+	UBaseType_t count;
+	UBaseType_t maxCount;
+	struct SIM_Task* waiters;		/* Highest priority first */
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct SIM_Task* tasks;
+static struct SIM_Task* currentTask;	/* NULL while the scheduler or idle runs */
+static struct SIM_Task* lastTask;		/* The task that ran last, NULL for idle */
+static ucontext_t schedulerContext;
+static uint8_t schedulerRunning;
+static uint64_t readyCounter;
+static uint64_t preemptionTime = SIM_NEVER;	/* When a woken task may preempt the running one */
+static SIM_Event tickEvent;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Stops the simulation for task level calls in an interrupt handler
+ */
+static void prvTaskLevelCall(const char* Name)
+{
+	if (simInInterrupt)
+		SIM_Fatal("%s called from an interrupt handler", Name);
+	simStatistics.rtosCalls++;
+	SIM_Advance(SIM_RTOS_CALL_CYCLES);
+}
+
+/**
+ * @brief	Counts an interrupt level call
+ */
+static void prvInterruptLevelCall(void)
+{
+	simStatistics.rtosCalls++;
+	SIM_Advance(SIM_RTOS_CALL_CYCLES);
+}
+
+static void prvTickEvent(SIM_Event* Event)
+{
+	(void)Event;
+}
+
+/**
+ * @brief	Lets a woken task preempt the running one at a point in time
+ */
+static void prvRequestPreemption(uint64_t Time)
+{
+	if (Time < preemptionTime)
+	{
+		preemptionTime = Time;
+		/* An event makes sure the scheduler wakes up at that time */
+		if (Time > SIM_GetCycles())
+		{
+			tickEvent.Callback = prvTickEvent;
+			SIM_Schedule(&tickEvent, Time);
+		}
+	}
+}
+
+/**
+ * @brief	Gets the time of the next tick
+ */
+static uint64_t prvNextTick(void)
+{
+	return (SIM_GetCycles() / SIM_CYCLES_PER_TICK + 1) * SIM_CYCLES_PER_TICK;
+}
+
+/**
+ * @brief	Makes a task ready
+ * @param	Task: the task
+ * @param	FromInterrupt: 1 if an interrupt handler woke it
+ * @retval	1 if it has higher priority than the running task
+ */
+static uint8_t prvMakeReady(struct SIM_Task* Task, uint8_t FromInterrupt)
+{
+	SIM_Cancel(&Task->timeout);
+	if (Task->waitingOn != 0)
+	{
+		struct SIM_Task** link = &Task->waitingOn->waiters;
+		while (*link != Task)
+			link = &(*link)->nextWaiter;
+		*link = Task->nextWaiter;
+		Task->waitingOn = 0;
+	}
+	Task->waitingForNotify = 0;
+	Task->state = TaskState_Ready;
+	Task->readyOrder = ++readyCounter;
+
+	uint8_t higher = (currentTask == 0 || Task->priority > currentTask->priority);
+	if (higher)
+		prvRequestPreemption(FromInterrupt ? prvNextTick() : SIM_GetCycles());
+	return higher;
+}
+
+static void prvTimeout(SIM_Event* Event)
+{
+	struct SIM_Task* task = (struct SIM_Task*)Event->Context;
+	task->timedOut = 1;
+	/* Timeouts happen on the tick */
+	prvMakeReady(task, 0);
+}
+
+/**
+ * @brief	Gets the ready task with the highest priority
+ */
+static struct SIM_Task* prvHighestReady(void)
+{
+	struct SIM_Task* selected = 0;
+	for (struct SIM_Task* task = tasks; task != 0; task = task->next)
+	{
+		if (task->state != TaskState_Ready)
+			continue;
+		if (selected == 0 || task->priority > selected->priority ||
+			(task->priority == selected->priority && task->readyOrder < selected->readyOrder))
+			selected = task;
+	}
+	return selected;
+}
+
+/**
+ * @brief	Goes back to the scheduler from the running task
+ */
+static void prvSwitchToScheduler(void)
+{
+	if (simCriticalNesting != 0)
+		SIM_Fatal("task %s blocks in a critical section", currentTask->name);
+	swapcontext(&currentTask->context, &schedulerContext);
+}
+
+/**
+ * @brief	Blocks the running task
+ * @param	Ticks: ticks to wait, portMAX_DELAY to wait forever
+ * @retval	1 if the timeout ran out, 0 if the task was woken
+ */
+static uint8_t prvBlock(TickType_t Ticks)
+{
+	if (currentTask == 0)
+		SIM_Fatal("blocking call outside a task");
+
+	currentTask->timedOut = 0;
+	currentTask->state = TaskState_Blocked;
+	if (Ticks != portMAX_DELAY)
+	{
+		uint64_t tick = SIM_GetCycles() / SIM_CYCLES_PER_TICK;
+		currentTask->timeout.Callback = prvTimeout;
+		currentTask->timeout.Context = currentTask;
+		SIM_Schedule(&currentTask->timeout, (tick + Ticks) * SIM_CYCLES_PER_TICK);
+	}
+	prvSwitchToScheduler();
+	return currentTask->timedOut;
+}
+
+static void prvTaskEntry(void)
+{
+	currentTask->function(currentTask->parameters);
+	/* Returning from a task isn't allowed in FreeRTOS, it's treated as deleting itself here */
+	vTaskDelete(0);
+}
+
+/**
+ * @brief	Adds a task to the waiters of a semaphore, by priority
+ */
+static void prvAddWaiter(struct SIM_Semaphore* Semaphore, struct SIM_Task* Task)
+{
+	struct SIM_Task** link = &Semaphore->waiters;
+	while (*link != 0 && (*link)->priority >= Task->priority)
+		link = &(*link)->nextWaiter;
+	Task->nextWaiter = *link;
+	*link = Task;
+	Task->waitingOn = Semaphore;
+}
+
+/* Scheduler -----------------------------------------------------------------*/
+/**
+ * @brief	Switches to the scheduler if a woken task should preempt the
+ *			running task, called between instructions
+ * @param	None
+ * @retval	None
+ */
+void SIM_CheckPreemption(void)
+{
+	if (currentTask == 0 || simInInterrupt || simCriticalNesting != 0 || SIM_GetCycles() < preemptionTime)
+		return;
+
+	preemptionTime = SIM_NEVER;
+	struct SIM_Task* next = prvHighestReady();
+	if (next != 0 && next->priority > currentTask->priority)
+		swapcontext(&currentTask->context, &schedulerContext);
+}
+
+uint64_t SIM_GetPreemptionTime(void)
+{
+	return preemptionTime;
+}
+
+void vTaskStartScheduler(void)
+{
+	schedulerRunning = 1;
+	uint8_t idle = 0;
+	while (1)
+	{
+		SIM_DispatchInterrupts();
+
+		struct SIM_Task* next = prvHighestReady();
+		if (next != 0 && (!idle || SIM_GetCycles() >= preemptionTime || preemptionTime == SIM_NEVER))
+		{
+			idle = 0;
+			preemptionTime = SIM_NEVER;
+			if (next != lastTask)
+			{
+				simStatistics.contextSwitches++;
+				SIM_Advance(SIM_CONTEXT_SWITCH_CYCLES);
+			}
+			lastTask = next;
+			currentTask = next;
+			swapcontext(&schedulerContext, &next->context);
+			currentTask = 0;
+
+			if (next->state == TaskState_Deleted)
+			{
+				munmap(next->stack, TASK_STACK_SIZE);
+				next->stack = 0;
+			}
+			continue;
+		}
+
+		/* Idle until something happens */
+		uint64_t wake = SIM_GetNextEventTime();
+		if (next != 0 && preemptionTime < wake)
+			wake = preemptionTime;
+		if (wake == SIM_NEVER)
+			break;
+		idle = 1;
+		lastTask = 0;
+		if (wake > SIM_GetCycles())
+			simStatistics.idleCycles += wake - SIM_GetCycles();
+		SIM_AdvanceTo(wake);
+	}
+	schedulerRunning = 0;
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* const pcName, uint16_t usStackDepth,
+					   void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask)
+{
+	(void)usStackDepth;
+	prvTaskLevelCall("xTaskCreate");
+	if (uxPriority >= configMAX_PRIORITIES)
+		SIM_Fatal("task %s: priority %lu is too high", pcName, uxPriority);
+
+	struct SIM_Task* task = calloc(1, sizeof(*task));
+	if (task == 0)
+		return pdFAIL;
+	/* Below 4 GB so the DMA can reach buffers on the stack */
+	task->stack = mmap(0, TASK_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+	if (task->stack == MAP_FAILED)
+	{
+		free(task);
+		return pdFAIL;
+	}
+
+	task->function = pvTaskCode;
+	task->parameters = pvParameters;
+	task->name = pcName;
+	task->priority = uxPriority;
+	getcontext(&task->context);
+	task->context.uc_stack.ss_sp = task->stack;
+	task->context.uc_stack.ss_size = TASK_STACK_SIZE;
+	task->context.uc_link = 0;
+	makecontext(&task->context, prvTaskEntry, 0);
+
+	task->next = tasks;
+	tasks = task;
+	prvMakeReady(task, 0);
+	if (pxCreatedTask != 0)
+		*pxCreatedTask = task;
+
+	SIM_Poll();
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+	prvTaskLevelCall("vTaskDelete");
+	struct SIM_Task* task = (xTaskToDelete != 0) ? xTaskToDelete : currentTask;
+	if (task == 0)
+		SIM_Fatal("vTaskDelete(NULL) outside a task");
+
+	if (task->state == TaskState_Blocked)
+		prvMakeReady(task, 0);
+	task->state = TaskState_Deleted;
+	if (task == currentTask)
+		prvSwitchToScheduler();
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	prvTaskLevelCall("vTaskDelay");
+	if (xTicksToDelay == 0)
+		return;
+	prvBlock(xTicksToDelay);
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return schedulerRunning ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return currentTask;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(SIM_GetCycles() / SIM_CYCLES_PER_TICK);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+	return (TickType_t)(SIM_GetCycles() / SIM_CYCLES_PER_TICK);
+}
+
+void vTaskSetTimeOutState(TimeOut_t* const pxTimeOut)
+{
+	pxTimeOut->xTimeOnEntering = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* const pxTimeOut, TickType_t* const pxTicksToWait)
+{
+	if (*pxTicksToWait == portMAX_DELAY)
+		return pdFALSE;
+
+	TickType_t now = xTaskGetTickCount();
+	TickType_t elapsed = now - pxTimeOut->xTimeOnEntering;
+	if (elapsed >= *pxTicksToWait)
+	{
+		*pxTicksToWait = 0;
+		return pdTRUE;
+	}
+	*pxTicksToWait -= elapsed;
+	pxTimeOut->xTimeOnEntering = now;
+	return pdFALSE;
+}
+
+/* Notifications -------------------------------------------------------------*/
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+	prvTaskLevelCall("ulTaskNotifyTake");
+	if (currentTask == 0)
+		SIM_Fatal("ulTaskNotifyTake outside a task");
+
+	if (currentTask->notifyValue == 0 && xTicksToWait != 0)
+	{
+		currentTask->waitingForNotify = 1;
+		prvBlock(xTicksToWait);
+	}
+
+	uint32_t value = currentTask->notifyValue;
+	if (value != 0)
+		currentTask->notifyValue = xClearCountOnExit ? 0 : value - 1;
+	return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+	prvTaskLevelCall("xTaskNotifyGive");
+	xTaskToNotify->notifyValue++;
+	if (xTaskToNotify->waitingForNotify)
+		prvMakeReady(xTaskToNotify, 0);
+	SIM_Poll();
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	prvInterruptLevelCall();
+	xTaskToNotify->notifyValue++;
+	if (xTaskToNotify->waitingForNotify && prvMakeReady(xTaskToNotify, 1) && pxHigherPriorityTaskWoken != 0)
+		*pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+/* Semaphores ----------------------------------------------------------------*/
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+	struct SIM_Semaphore* semaphore = calloc(1, sizeof(*semaphore));
+	if (semaphore == 0)
+		return 0;
+	semaphore->maxCount = uxMaxCount;
+	semaphore->count = uxInitialCount;
+	return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return xSemaphoreCreateCounting(1, 0);
+}
+
+/* Priority inheritance is not modeled */
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	return xSemaphoreCreateCounting(1, 1);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+	if (xSemaphore->waiters != 0)
+		SIM_Fatal("semaphore deleted while task %s waits for it", xSemaphore->waiters->name);
+	free(xSemaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+	prvTaskLevelCall("xSemaphoreTake");
+	if (xSemaphore->count > 0)
+	{
+		xSemaphore->count--;
+		SIM_Poll();
+		return pdTRUE;
+	}
+	if (xBlockTime == 0)
+		return pdFALSE;
+
+	if (currentTask == 0)
+		SIM_Fatal("xSemaphoreTake blocks outside a task");
+	prvAddWaiter(xSemaphore, currentTask);
+	/* A give hands the count directly to the first waiter */
+	return prvBlock(xBlockTime) ? pdFALSE : pdTRUE;
+}
+
+/**
+ * @brief	Gives a semaphore
+ * @retval	The task that got it, NULL if none was waiting. (void*)-1 if the
+ *			semaphore was full
+ */
+static struct SIM_Task* prvGive(struct SIM_Semaphore* Semaphore, uint8_t FromInterrupt, uint8_t* Higher)
+{
+	struct SIM_Task* waiter = Semaphore->waiters;
+	if (waiter != 0)
+	{
+		*Higher = prvMakeReady(waiter, FromInterrupt);
+		return waiter;
+	}
+	if (Semaphore->count >= Semaphore->maxCount)
+		return (struct SIM_Task*)-1;
+	Semaphore->count++;
+	return 0;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+	prvTaskLevelCall("xSemaphoreGive");
+	uint8_t higher = 0;
+	if (prvGive(xSemaphore, 0, &higher) == (struct SIM_Task*)-1)
+		return pdFALSE;
+	SIM_Poll();
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	(void)pxHigherPriorityTaskWoken;
+	prvInterruptLevelCall();
+	if (xSemaphore->count == 0)
+		return pdFALSE;
+	xSemaphore->count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	prvInterruptLevelCall();
+	uint8_t higher = 0;
+	if (prvGive(xSemaphore, 1, &higher) == (struct SIM_Task*)-1)
+		return pdFALSE;
+	if (higher && pxHigherPriorityTaskWoken != 0)
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+{
+	return xSemaphore->count;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue)
+{
+	prvTaskLevelCall("uxQueueMessagesWaiting");
+	return xQueue->count;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(const QueueHandle_t xQueue)
+{
+	return xQueue->count;
+}
+
+/* Port ----------------------------------------------------------------------*/
+void SIM_YieldFromISR(BaseType_t xHigherPriorityTaskWoken)
+{
+	if (!simInInterrupt)
+		SIM_Fatal("portYIELD_FROM_ISR outside an interrupt handler");
+	if (xHigherPriorityTaskWoken)
+		prvRequestPreemption(SIM_GetCycles());
+}
+
+void SIM_EnterCritical(void)
+{
+	if (simInInterrupt)
+		SIM_Fatal("taskENTER_CRITICAL called from an interrupt handler");
+	simCriticalNesting++;
+}
+
+void SIM_ExitCritical(void)
+{
+	if (simCriticalNesting == 0)
+		SIM_Fatal("taskEXIT_CRITICAL without taskENTER_CRITICAL");
+	simCriticalNesting--;
+	if (simCriticalNesting == 0)
+		SIM_Poll();
+}
+
+/* Interrupts don't nest in the simulator, so there is nothing to mask */
+UBaseType_t SIM_EnterCriticalFromISR(void)
+{
+	return 0;
+}
+
+void SIM_ExitCriticalFromISR(UBaseType_t uxSavedInterruptStatus)
+{
+	(void)uxSavedInterruptStatus;
+}
@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * @file	semphr.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Semaphore functions of the FreeRTOS API for the host simulator.
+ *			Mutexes are binary semaphores that start out given, there is no
+ *			priority inheritance
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "queue.h"
+
+/* Function prototypes -------------------------------------------------------*/
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore);
+
+#endif /* SEMAPHORE_H */
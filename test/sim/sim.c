@@ -0,0 +1,399 @@
+/**
+ ******************************************************************************
+ * @file	sim.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Core of the host simulator: register access traps, simulated time
+ *			and interrupt dispatch.
+ *
+ *			The peripheral pages are mapped at the STM32F10x addresses with
+ *			PROT_NONE. An access to them raises SIGSEGV, the handler lets the
+ *			model prepare the value, opens the page and sets the trap flag so
+ *			the CPU stops after the instruction with SIGTRAP. The SIGTRAP
+ *			handler closes the page again, passes a written value to the model
+ *			and takes pending interrupts, as the instruction is done. Whether
+ *			the access was a write comes from the page fault error code.
+ *			Requires x86-64 Linux
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "sim_private.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define PAGE_SIZE				(0x1000)
+#define PAGE_OF(ADDRESS)		((ADDRESS) & ~(uint32_t)(PAGE_SIZE - 1))
+
+#define X86_PAGE_FAULT_WRITE	(0x2)		/* Page fault error code bit for writes */
+#define X86_EFLAGS_TF			(0x100)		/* Trap flag, single step */
+
+#define INTERRUPT_STORM_LIMIT	(1000000)	/* Interrupts in a row without thread code running */
+
+/* Private variables ---------------------------------------------------------*/
+/* Pages with peripherals that are modeled, every access to them traps */
+static const uint32_t trappedPages[] = {
+	PAGE_OF(SPI2_BASE),
+	PAGE_OF(AFIO_BASE),		/* Also EXTI, GPIOA and GPIOB */
+	PAGE_OF(GPIOC_BASE),
+	PAGE_OF(SPI1_BASE),
+	PAGE_OF(DMA1_BASE),
+	PAGE_OF(DWT_BASE),
+};
+
+/* Pages that are plain memory */
+static const uint32_t memoryPages[] = {
+	PAGE_OF(CoreDebug_BASE),
+};
+
+static struct
+{
+	uint32_t address;
+	uint8_t write;
+	uint8_t active;
+} pendingAccess;
+
+static uint64_t now;
+static SIM_Event* events;
+static int32_t activeInterrupt = -1;
+
+SIM_Statistics simStatistics;
+uint8_t simInInterrupt;
+uint32_t simCriticalNesting;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Checks if an address is in one of the trapped pages
+ * @param	Address: the address to check
+ * @retval	1 if it is, 0 otherwise
+ */
+static uint8_t prvIsTrapped(uintptr_t Address)
+{
+	for (uint32_t i = 0; i < sizeof(trappedPages) / sizeof(trappedPages[0]); i++)
+	{
+		if (Address >= trappedPages[i] && Address < (uintptr_t)trappedPages[i] + PAGE_SIZE)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	SIGSEGV handler, the first half of a register access
+ */
+static void prvAccessFault(int Signal, siginfo_t* Info, void* Context)
+{
+	ucontext_t* context = (ucontext_t*)Context;
+	uintptr_t address = (uintptr_t)Info->si_addr;
+	if (!prvIsTrapped(address) || pendingAccess.active)
+	{
+		/* A real crash, let it happen without the handler */
+		signal(Signal, SIG_DFL);
+		return;
+	}
+
+	pendingAccess.address = (uint32_t)address & ~(uint32_t)3;
+	pendingAccess.write = (context->uc_mcontext.gregs[REG_ERR] & X86_PAGE_FAULT_WRITE) != 0;
+	pendingAccess.active = 1;
+	simStatistics.accesses++;
+	SIM_Advance(SIM_ACCESS_CYCLES);
+
+	/* A write can be a read-modify-write, so the register needs its value either way */
+	uint32_t value = pendingAccess.write ? SIM_PeripheralPeek(pendingAccess.address) : SIM_PeripheralRead(pendingAccess.address);
+	mprotect((void*)(uintptr_t)PAGE_OF(pendingAccess.address), PAGE_SIZE, PROT_READ | PROT_WRITE);
+	*(volatile uint32_t*)(uintptr_t)pendingAccess.address = value;
+	context->uc_mcontext.gregs[REG_EFL] |= X86_EFLAGS_TF;
+}
+
+/**
+ * @brief	SIGTRAP handler, the second half of a register access
+ */
+static void prvAccessDone(int Signal, siginfo_t* Info, void* Context)
+{
+	(void)Signal;
+	(void)Info;
+	ucontext_t* context = (ucontext_t*)Context;
+	if (!pendingAccess.active)
+		SIM_Fatal("SIGTRAP without a register access");
+
+	context->uc_mcontext.gregs[REG_EFL] &= ~X86_EFLAGS_TF;
+	uint32_t address = pendingAccess.address;
+	uint32_t value = *(volatile uint32_t*)(uintptr_t)address;
+	mprotect((void*)(uintptr_t)PAGE_OF(address), PAGE_SIZE, PROT_NONE);
+	pendingAccess.active = 0;
+
+	if (pendingAccess.write)
+		SIM_PeripheralWrite(address, value);
+
+	/* The instruction is done, this is where an interrupt can be taken */
+	SIM_Poll();
+}
+
+/**
+ * @brief	Maps the peripherals and installs the handlers before main
+ */
+__attribute__((constructor)) static void prvInit(void)
+{
+	for (uint32_t i = 0; i < sizeof(trappedPages) / sizeof(trappedPages[0]); i++)
+	{
+		void* page = mmap((void*)(uintptr_t)trappedPages[i], PAGE_SIZE, PROT_NONE,
+						  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (page != (void*)(uintptr_t)trappedPages[i])
+			SIM_Fatal("can't map the peripherals at 0x%08X", trappedPages[i]);
+	}
+	for (uint32_t i = 0; i < sizeof(memoryPages) / sizeof(memoryPages[0]); i++)
+	{
+		void* page = mmap((void*)(uintptr_t)memoryPages[i], PAGE_SIZE, PROT_READ | PROT_WRITE,
+						  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (page != (void*)(uintptr_t)memoryPages[i])
+			SIM_Fatal("can't map the core peripherals at 0x%08X", memoryPages[i]);
+	}
+
+	/* Interrupt handlers do register accesses from inside the SIGTRAP handler */
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;
+	action.sa_sigaction = prvAccessFault;
+	sigaction(SIGSEGV, &action, 0);
+	action.sa_sigaction = prvAccessDone;
+	sigaction(SIGTRAP, &action, 0);
+
+	setvbuf(stdout, 0, _IOLBF, 0);
+}
+
+/**
+ * @brief	Default for interrupt handlers the test doesn't define
+ */
+static void prvUnhandledInterrupt(void)
+{
+	SIM_Fatal("interrupt %d is enabled and pending but has no handler", (int)activeInterrupt);
+}
+
+void EXTI0_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI1_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI2_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI3_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI4_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel1_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel2_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel3_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel4_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel5_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel6_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void DMA1_Channel7_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI9_5_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void SPI1_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void SPI2_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+void EXTI15_10_IRQHandler(void) __attribute__((weak, alias("prvUnhandledInterrupt")));
+
+static void (* const vectors[SIM_IRQ_COUNT])(void) = {
+	[EXTI0_IRQn] = EXTI0_IRQHandler,
+	[EXTI1_IRQn] = EXTI1_IRQHandler,
+	[EXTI2_IRQn] = EXTI2_IRQHandler,
+	[EXTI3_IRQn] = EXTI3_IRQHandler,
+	[EXTI4_IRQn] = EXTI4_IRQHandler,
+	[DMA1_Channel1_IRQn] = DMA1_Channel1_IRQHandler,
+	[DMA1_Channel2_IRQn] = DMA1_Channel2_IRQHandler,
+	[DMA1_Channel3_IRQn] = DMA1_Channel3_IRQHandler,
+	[DMA1_Channel4_IRQn] = DMA1_Channel4_IRQHandler,
+	[DMA1_Channel5_IRQn] = DMA1_Channel5_IRQHandler,
+	[DMA1_Channel6_IRQn] = DMA1_Channel6_IRQHandler,
+	[DMA1_Channel7_IRQn] = DMA1_Channel7_IRQHandler,
+	[EXTI9_5_IRQn] = EXTI9_5_IRQHandler,
+	[SPI1_IRQn] = SPI1_IRQHandler,
+	[SPI2_IRQn] = SPI2_IRQHandler,
+	[EXTI15_10_IRQn] = EXTI15_10_IRQHandler,
+};
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Gets the simulated time
+ * @param	None
+ * @retval	CPU cycles since the start
+ */
+uint64_t SIM_GetCycles(void)
+{
+	return now;
+}
+
+/**
+ * @brief	Lets time pass for code the simulator doesn't see, e.g. processing
+ *			data in a callback
+ * @param	Cycles: number of CPU cycles the code takes
+ * @retval	None
+ */
+void SIM_Spend(uint32_t Cycles)
+{
+	SIM_Advance(Cycles);
+	SIM_Poll();
+}
+
+/**
+ * @brief	Lets time pass and runs the events that are due
+ * @param	Cycles: number of CPU cycles
+ * @retval	None
+ * @note	Doesn't take interrupts, see SIM_Poll()
+ */
+void SIM_Advance(uint64_t Cycles)
+{
+	uint64_t target = now + Cycles;
+	while (events != 0 && events->time <= target)
+	{
+		SIM_Event* event = events;
+		events = event->next;
+		event->scheduled = 0;
+		if (event->time > now)
+			now = event->time;
+		event->Callback(event);
+	}
+	now = target;
+}
+
+/**
+ * @brief	Lets time pass until a point in time
+ * @param	Time: the time to advance to, nothing happens if it has passed
+ * @retval	None
+ */
+void SIM_AdvanceTo(uint64_t Time)
+{
+	if (Time > now)
+		SIM_Advance(Time - now);
+}
+
+/**
+ * @brief	Gets when the next event happens
+ * @param	None
+ * @retval	The time of the next event, SIM_NEVER if there are none
+ */
+uint64_t SIM_GetNextEventTime(void)
+{
+	return (events != 0) ? events->time : SIM_NEVER;
+}
+
+/**
+ * @brief	Queues an event, an event that is already queued is moved
+ * @param	Event: the event, Callback has to be set
+ * @param	Time: when it happens, the past means now
+ * @retval	None
+ * @note	Events at the same time happen in the order they were queued
+ */
+void SIM_Schedule(SIM_Event* Event, uint64_t Time)
+{
+	SIM_Cancel(Event);
+	Event->time = (Time < now) ? now : Time;
+	Event->scheduled = 1;
+
+	SIM_Event** link = &events;
+	while (*link != 0 && (*link)->time <= Event->time)
+		link = &(*link)->next;
+	Event->next = *link;
+	*link = Event;
+}
+
+/**
+ * @brief	Removes an event from the queue
+ * @param	Event: the event, nothing happens if it isn't queued
+ * @retval	None
+ */
+void SIM_Cancel(SIM_Event* Event)
+{
+	if (!Event->scheduled)
+		return;
+
+	for (SIM_Event** link = &events; *link != 0; link = &(*link)->next)
+	{
+		if (*link == Event)
+		{
+			*link = Event->next;
+			break;
+		}
+	}
+	Event->scheduled = 0;
+}
+
+/**
+ * @brief	Runs the interrupt handlers that are pending, highest priority first
+ * @param	None
+ * @retval	None
+ * @note	Nothing happens inside a handler or a critical section
+ */
+void SIM_DispatchInterrupts(void)
+{
+	if (simInInterrupt || simCriticalNesting != 0)
+		return;
+
+	uint32_t count = 0;
+	int32_t irq;
+	while ((irq = SIM_GetPendingInterrupt()) >= 0)
+	{
+		if (++count > INTERRUPT_STORM_LIMIT)
+			SIM_Fatal("interrupt %d is never cleared", (int)irq);
+
+		simInInterrupt = 1;
+		activeInterrupt = irq;
+		SIM_Advance(SIM_ISR_ENTRY_CYCLES);
+		simStatistics.interrupts[irq]++;
+		vectors[irq]();
+		SIM_Advance(SIM_ISR_EXIT_CYCLES);
+		activeInterrupt = -1;
+		simInInterrupt = 0;
+	}
+}
+
+/**
+ * @brief	Takes pending interrupts and switches task if a higher priority
+ *			task should run, called between instructions
+ * @param	None
+ * @retval	None
+ */
+void SIM_Poll(void)
+{
+	if (simInInterrupt || simCriticalNesting != 0)
+		return;
+
+	SIM_DispatchInterrupts();
+	SIM_CheckPreemption();
+}
+
+/**
+ * @brief	Gets a copy of the counters
+ * @param	Statistics: where to store the copy
+ * @retval	None
+ */
+void SIM_GetStatistics(SIM_Statistics* Statistics)
+{
+	*Statistics = simStatistics;
+}
+
+/**
+ * @brief	Resets the counters
+ * @param	None
+ * @retval	None
+ */
+void SIM_ResetStatistics(void)
+{
+	memset(&simStatistics, 0, sizeof(simStatistics));
+}
+
+/**
+ * @brief	Stops the simulation with an error
+ * @param	Format: printf format of the message
+ * @retval	None
+ */
+void SIM_Fatal(const char* Format, ...)
+{
+	va_list arguments;
+	va_start(arguments, Format);
+	fprintf(stderr, "SIM FATAL at cycle %llu: ", (unsigned long long)now);
+	vfprintf(stderr, Format, arguments);
+	fprintf(stderr, "\n");
+	va_end(arguments);
+	abort();
+}
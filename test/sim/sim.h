@@ -0,0 +1,212 @@
+/**
+ ******************************************************************************
+ * @file	sim.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Host simulator for the SPI drivers. The driver sources are built
+ *			unchanged for x86-64 Linux against the headers in this directory:
+ *			- The peripheral registers are mapped at their STM32F10x addresses
+ *			  without access rights, every access traps and is done by the
+ *			  models in peripherals.c (SPI, DMA, GPIO, EXTI, DWT)
+ *			- Time is counted in CPU cycles of a 72 MHz STM32F103. Register
+ *			  accesses, interrupt entry/exit, RTOS calls and context switches
+ *			  cost the cycles below, other code is free unless SIM_Spend()
+ *			  is called. The SPI clock follows CR1 and the APB clocks, so the
+ *			  bus timing is exact while the CPU timing is an estimate
+ *			- Interrupts are taken between instructions when they are enabled
+ *			  in the NVIC and not masked by a critical section. They don't
+ *			  preempt each other
+ *			- FreeRTOS tasks run on their own stacks, see rtos.c
+ *			- Slave models are attached to a bus and a chip select pin and
+ *			  exchange one byte for every byte the master shifts out
+ *
+ *			Everything the DMA reads or writes has to be below 4 GB as the
+ *			drivers store addresses in 32 bit registers. The test binaries are
+ *			built with -no-pie and task stacks are allocated below 4 GB, so
+ *			static buffers and buffers on task stacks work.
+ *			In gdb use "handle SIGSEGV SIGTRAP nostop noprint pass"
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_H_
+#define SIM_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "FreeRTOS.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SIM_CPU_CLOCK_HZ			(72000000UL)	/* SYSCLK and PCLK2 (SPI1), PCLK1 (SPI2) is half of it */
+#define SIM_CYCLES_PER_TICK			(SIM_CPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+#define SIM_ACCESS_CYCLES			(2)		/* A register access with the instructions around it */
+#define SIM_ISR_ENTRY_CYCLES		(12)	/* Exception entry on a Cortex-M3 */
+#define SIM_ISR_EXIT_CYCLES			(12)	/* Exception return on a Cortex-M3 */
+#define SIM_RTOS_CALL_CYCLES		(40)	/* A FreeRTOS API call that doesn't switch task */
+#define SIM_CONTEXT_SWITCH_CYCLES	(120)	/* PendSV switching to another task */
+#define SIM_DMA_CYCLES				(5)		/* From a DMA request until the byte is moved */
+
+#define SIM_IRQ_COUNT				(64)
+
+/* Typedefs ------------------------------------------------------------------*/
+typedef struct SIM_Event SIM_Event;
+typedef struct SIM_Slave SIM_Slave;
+typedef struct SIM_PinWatch SIM_PinWatch;
+typedef struct SIM_Nrf24l01Slave SIM_Nrf24l01Slave;
+
+/**
+ * @brief  Something that happens at a point in time, e.g. a byte shifted out
+ */
+struct SIM_Event
+{
+	void (*Callback)(SIM_Event* Event);	/* Called when the time is reached */
+	void* Context;						/* Free for the owner to use */
+
+	uint64_t time;						/* When the event happens */
+	uint8_t scheduled;					/* Set while the event is queued */
+	SIM_Event* next;
+};
+
+/**
+ * @brief  Called when an output pin changes, Level is 0 or 1
+ */
+struct SIM_PinWatch
+{
+	GPIO_TypeDef* GPIOx;
+	uint16_t Pin;
+	void (*Callback)(SIM_PinWatch* Watch, uint8_t Level);
+	void* Context;
+
+	SIM_PinWatch* next;
+};
+
+/**
+ * @brief  A slave device on a simulated SPI bus
+ */
+struct SIM_Slave
+{
+	const char* Name;
+	SPI_TypeDef* SPIx;							/* The bus the slave is connected to */
+	GPIO_TypeDef* CS_GPIO;						/* Chip select port */
+	uint16_t CS_Pin;							/* Chip select pin, active low */
+
+	void (*Select)(SIM_Slave* Slave);					/* Chip select went low, can be NULL */
+	uint8_t (*Exchange)(SIM_Slave* Slave, uint8_t Mosi);	/* Returns MISO for the byte the master wrote */
+	void (*Deselect)(SIM_Slave* Slave);					/* Chip select went high, can be NULL */
+	void* Context;								/* Free for the model to use */
+
+	/* Kept by the simulator */
+	uint8_t selected;							/* Chip select is low */
+	uint32_t selects;							/* Falling edges on chip select */
+	uint32_t deselects;							/* Rising edges on chip select */
+	uint32_t emptySelects;						/* Times chip select was low without any byte transferred */
+	uint32_t bytes;								/* Bytes exchanged with the slave */
+	uint32_t bytesThisSelect;					/* Bytes exchanged since chip select went low */
+	SIM_PinWatch csWatch;
+	SIM_Slave* next;
+};
+
+/**
+ * @brief  Counters for the whole simulation
+ */
+typedef struct
+{
+	uint64_t accesses;						/* Register accesses */
+	uint32_t interrupts[SIM_IRQ_COUNT];		/* Interrupt handlers run, by IRQn */
+	uint32_t contextSwitches;				/* Switches from one task to another */
+	uint64_t idleCycles;					/* Cycles no task was running */
+	uint32_t rtosCalls;						/* FreeRTOS API calls */
+	uint32_t spiBytes[2];					/* Bytes shifted by SPI1 and SPI2 */
+	uint64_t spiBusyCycles[2];				/* Cycles SPI1 and SPI2 were shifting */
+	uint32_t spiOverruns[2];				/* Received bytes lost as RXNE was still set */
+	uint32_t dmaTransfers;					/* Bytes moved by DMA1 */
+} SIM_Statistics;
+
+/**
+ * @brief  Slave that answers with a script and records what it receives
+ */
+typedef struct
+{
+	SIM_Slave Slave;
+	const uint8_t* Responses;		/* Sent one byte at a time, 0xFF when it runs out */
+	uint32_t ResponseCount;
+	uint8_t RestartOnSelect;		/* Start the script over on every chip select */
+	uint8_t* Log;					/* Where the received bytes are stored, can be NULL */
+	uint32_t LogSize;
+
+	uint32_t responseIndex;
+	uint32_t logCount;				/* Received bytes, also the ones that didn't fit in Log */
+} SIM_ScriptedSlave;
+
+/**
+ * @brief  Slave that answers with a byte counter, e.g. a free running ADC
+ */
+typedef struct
+{
+	SIM_Slave Slave;
+	uint8_t next;					/* The next byte to send */
+} SIM_CounterSlave;
+
+/**
+ * @brief  Model of the command interface of an nRF24L01+: the registers, the
+ *         commands and the IRQ pin. There is no radio, in TX mode with CE
+ *         high the payloads leave the TX FIFO one every TxCycles
+ */
+struct SIM_Nrf24l01Slave
+{
+	SIM_Slave Slave;
+	GPIO_TypeDef* CE_GPIO;			/* Chip enable, the edges are counted, NULL for always high */
+	uint16_t CE_Pin;
+	GPIO_TypeDef* IRQ_GPIO;			/* Low while a flag that isn't masked in CONFIG is set, can be NULL */
+	uint16_t IRQ_Pin;
+	uint32_t TxCycles;				/* Time to send a payload and get the ACK, 0 for 300 us */
+	uint32_t FailPayloads;			/* Number of payloads from now on that get no ACK, each sets MAX_RT */
+	void (*Sent)(SIM_Nrf24l01Slave* Model, const uint8_t* Payload, uint8_t Width);	/* Called for every acknowledged payload, can be NULL */
+
+	uint8_t registers[0x20][5];		/* The register file, LSByte first */
+	uint8_t rxFifo[3][32];			/* Received payloads, oldest first */
+	uint8_t rxWidths[3];			/* What R_RX_PL_WID returns, above 32 for a corrupt payload */
+	uint8_t rxPipes[3];
+	uint8_t rxCount;
+	uint8_t txFifo[3][32];			/* Written payloads, oldest first */
+	uint8_t txWidths[3];
+	uint8_t txCount;
+	uint8_t txWrite[32];			/* The payload being written, it goes into the FIFO on deselect */
+	uint8_t txWriteWidth;
+
+	uint8_t command;				/* The command of the current chip select */
+	uint8_t index;					/* Bytes since chip select went low */
+	uint32_t commands;				/* Commands received */
+	uint32_t registerWrites;		/* W_REGISTER commands received */
+	uint32_t ceEdges;				/* Edges on CE */
+	uint32_t shortCsHigh;			/* Chip selects sooner than Tcwh (50 ns) after the last deselect */
+	uint64_t lastDeselect;			/* When chip select last went high */
+	uint32_t sent;					/* Payloads acknowledged */
+	uint32_t txOverflows;			/* Payloads written to a full TX FIFO, they are lost */
+	SIM_PinWatch ceWatch;
+	SIM_Event txDone;
+};
+
+/* Function prototypes -------------------------------------------------------*/
+uint64_t SIM_GetCycles(void);
+void SIM_Spend(uint32_t Cycles);
+void SIM_Schedule(SIM_Event* Event, uint64_t Time);
+void SIM_Cancel(SIM_Event* Event);
+
+void SIM_GetStatistics(SIM_Statistics* Statistics);
+void SIM_ResetStatistics(void);
+void SIM_Fatal(const char* Format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+void SIM_AttachSlave(SIM_Slave* Slave);
+void SIM_WatchPin(SIM_PinWatch* Watch);
+void SIM_SetInput(GPIO_TypeDef* GPIOx, uint16_t Pin, uint8_t Level);
+uint8_t SIM_GetOutput(GPIO_TypeDef* GPIOx, uint16_t Pin);
+
+void SIM_ScriptedSlave_Init(SIM_ScriptedSlave* Scripted, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin);
+void SIM_CounterSlave_Init(SIM_CounterSlave* Counter, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin);
+void SIM_Nrf24l01Slave_Init(SIM_Nrf24l01Slave* Model, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin);
+void SIM_Nrf24l01Slave_Reset(SIM_Nrf24l01Slave* Model);
+uint8_t SIM_Nrf24l01Slave_Receive(SIM_Nrf24l01Slave* Model, uint8_t Pipe, const uint8_t* Payload, uint8_t Width);
+
+#endif /* SIM_H_ */
@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @file	sim_private.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Used between the files of the simulator, not by the tests
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SIM_PRIVATE_H_
+#define SIM_PRIVATE_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SIM_NEVER	(UINT64_MAX)
+
+/* Variables -----------------------------------------------------------------*/
+extern SIM_Statistics simStatistics;
+extern uint8_t simInInterrupt;			/* Set while an interrupt handler runs */
+extern uint32_t simCriticalNesting;		/* taskENTER_CRITICAL depth, interrupts are masked while it's not 0 */
+
+/* Function prototypes -------------------------------------------------------*/
+/* sim.c */
+void SIM_Advance(uint64_t Cycles);
+void SIM_AdvanceTo(uint64_t Time);
+uint64_t SIM_GetNextEventTime(void);
+void SIM_Poll(void);
+void SIM_DispatchInterrupts(void);
+
+/* peripherals.c */
+uint32_t SIM_PeripheralRead(uint32_t Address);
+uint32_t SIM_PeripheralPeek(uint32_t Address);
+void SIM_PeripheralWrite(uint32_t Address, uint32_t Value);
+int32_t SIM_GetPendingInterrupt(void);
+void SIM_ConfigureInterrupt(uint8_t IRQn, uint8_t Priority, uint8_t Enable);
+
+/* rtos.c */
+void SIM_CheckPreemption(void);
+uint64_t SIM_GetPreemptionTime(void);
+
+#endif /* SIM_PRIVATE_H_ */
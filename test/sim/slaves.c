@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ * @file	slaves.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Simple slave models for the tests
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_private.h"
+
+/* Private functions ---------------------------------------------------------*/
+static void prvScriptedSelect(SIM_Slave* Slave)
+{
+	SIM_ScriptedSlave* scripted = (SIM_ScriptedSlave*)Slave->Context;
+	if (scripted->RestartOnSelect)
+		scripted->responseIndex = 0;
+}
+
+static uint8_t prvScriptedExchange(SIM_Slave* Slave, uint8_t Mosi)
+{
+	SIM_ScriptedSlave* scripted = (SIM_ScriptedSlave*)Slave->Context;
+	if (scripted->Log != 0 && scripted->logCount < scripted->LogSize)
+		scripted->Log[scripted->logCount] = Mosi;
+	scripted->logCount++;
+
+	if (scripted->Responses == 0 || scripted->responseIndex >= scripted->ResponseCount)
+		return 0xFF;
+	return scripted->Responses[scripted->responseIndex++];
+}
+
+static uint8_t prvCounterExchange(SIM_Slave* Slave, uint8_t Mosi)
+{
+	(void)Mosi;
+	SIM_CounterSlave* counter = (SIM_CounterSlave*)Slave->Context;
+	return counter->next++;
+}
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ * @brief	Initializes a scripted slave and attaches it to the bus
+ * @param	Scripted: the slave, the script and log can be set before or after
+ * @param	SPIx: the bus
+ * @param	CS_GPIO: chip select port
+ * @param	CS_Pin: chip select pin
+ * @retval	None
+ */
+void SIM_ScriptedSlave_Init(SIM_ScriptedSlave* Scripted, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin)
+{
+	if (Scripted->Slave.Name == 0)
+		Scripted->Slave.Name = "scripted";
+	Scripted->Slave.SPIx = SPIx;
+	Scripted->Slave.CS_GPIO = CS_GPIO;
+	Scripted->Slave.CS_Pin = CS_Pin;
+	Scripted->Slave.Select = prvScriptedSelect;
+	Scripted->Slave.Exchange = prvScriptedExchange;
+	Scripted->Slave.Context = Scripted;
+	SIM_AttachSlave(&Scripted->Slave);
+}
+
+/**
+ * @brief	Initializes a counter slave and attaches it to the bus
+ * @param	Counter: the slave
+ * @param	SPIx: the bus
+ * @param	CS_GPIO: chip select port
+ * @param	CS_Pin: chip select pin
+ * @retval	None
+ */
+void SIM_CounterSlave_Init(SIM_CounterSlave* Counter, SPI_TypeDef* SPIx, GPIO_TypeDef* CS_GPIO, uint16_t CS_Pin)
+{
+	if (Counter->Slave.Name == 0)
+		Counter->Slave.Name = "counter";
+	Counter->Slave.SPIx = SPIx;
+	Counter->Slave.CS_GPIO = CS_GPIO;
+	Counter->Slave.CS_Pin = CS_Pin;
+	Counter->Slave.Exchange = prvCounterExchange;
+	Counter->Slave.Context = Counter;
+	SIM_AttachSlave(&Counter->Slave);
+}
@@ -0,0 +1,213 @@
+/**
+ ******************************************************************************
+ * @file	stdperiph.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	The StdPeriph functions the drivers use. They access the registers
+ *			like the library does, so they cost simulated time and go through
+ *			the models. The RCC clocks are always on and the NVIC is set
+ *			directly in the model
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_private.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define CR1_CLEAR_MASK		((uint16_t)0x3040)		/* Keeps CRCEN, CRCNEXT, BIDI and SPE */
+#define CCR_CLEAR_MASK		((uint32_t)0xFFFF800F)	/* Keeps EN and the interrupt enables */
+
+/* Functions -----------------------------------------------------------------*/
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState)
+{
+	(void)RCC_AHBPeriph;
+	(void)NewState;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState)
+{
+	(void)RCC_APB1Periph;
+	(void)NewState;
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState)
+{
+	(void)RCC_APB2Periph;
+	(void)NewState;
+}
+
+/* GPIO ----------------------------------------------------------------------*/
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct)
+{
+	uint32_t mode = (uint32_t)GPIO_InitStruct->GPIO_Mode & 0x0F;
+	if ((uint32_t)GPIO_InitStruct->GPIO_Mode & 0x10)
+		mode |= (uint32_t)GPIO_InitStruct->GPIO_Speed;
+
+	for (uint32_t pin = 0; pin < 16; pin++)
+	{
+		uint32_t mask = 1U << pin;
+		if (!(GPIO_InitStruct->GPIO_Pin & mask))
+			continue;
+
+		/* The pull direction is set in ODR */
+		if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPD)
+			GPIOx->BRR = mask;
+		else if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPU)
+			GPIOx->BSRR = mask;
+
+		if (pin < 8)
+			GPIOx->CRL = (GPIOx->CRL & ~(0xFU << (4 * pin))) | (mode << (4 * pin));
+		else
+			GPIOx->CRH = (GPIOx->CRH & ~(0xFU << (4 * (pin - 8)))) | (mode << (4 * (pin - 8)));
+	}
+}
+
+void GPIO_EXTILineConfig(uint8_t GPIO_PortSource, uint8_t GPIO_PinSource)
+{
+	uint32_t shift = 4 * (GPIO_PinSource & 0x03);
+	AFIO->EXTICR[GPIO_PinSource >> 2] &= ~(0xFU << shift);
+	AFIO->EXTICR[GPIO_PinSource >> 2] |= (uint32_t)GPIO_PortSource << shift;
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+	return (GPIOx->IDR & GPIO_Pin) ? 1 : 0;
+}
+
+/* EXTI ----------------------------------------------------------------------*/
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct)
+{
+	uint32_t line = EXTI_InitStruct->EXTI_Line;
+	volatile uint32_t* mode = (EXTI_InitStruct->EXTI_Mode == EXTI_Mode_Interrupt) ? &EXTI->IMR : &EXTI->EMR;
+
+	if (EXTI_InitStruct->EXTI_LineCmd == DISABLE)
+	{
+		*mode &= ~line;
+		return;
+	}
+
+	EXTI->IMR &= ~line;
+	EXTI->EMR &= ~line;
+	*mode |= line;
+
+	EXTI->RTSR &= ~line;
+	EXTI->FTSR &= ~line;
+	if (EXTI_InitStruct->EXTI_Trigger == EXTI_Trigger_Rising_Falling)
+	{
+		EXTI->RTSR |= line;
+		EXTI->FTSR |= line;
+	}
+	else if (EXTI_InitStruct->EXTI_Trigger == EXTI_Trigger_Rising)
+		EXTI->RTSR |= line;
+	else
+		EXTI->FTSR |= line;
+}
+
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line)
+{
+	return ((EXTI->PR & EXTI_Line) && (EXTI->IMR & EXTI_Line)) ? SET : RESET;
+}
+
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line)
+{
+	EXTI->PR = EXTI_Line;
+}
+
+/* NVIC ----------------------------------------------------------------------*/
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct)
+{
+	SIM_ConfigureInterrupt(NVIC_InitStruct->NVIC_IRQChannel,
+						   NVIC_InitStruct->NVIC_IRQChannelPreemptionPriority,
+						   NVIC_InitStruct->NVIC_IRQChannelCmd != DISABLE);
+}
+
+/* SPI -----------------------------------------------------------------------*/
+void SPI_Init(SPI_TypeDef* SPIx, SPI_InitTypeDef* SPI_InitStruct)
+{
+	uint16_t cr1 = SPIx->CR1;
+	cr1 &= CR1_CLEAR_MASK;
+	cr1 |= (uint16_t)(SPI_InitStruct->SPI_Direction | SPI_InitStruct->SPI_Mode |
+					  SPI_InitStruct->SPI_DataSize | SPI_InitStruct->SPI_CPOL |
+					  SPI_InitStruct->SPI_CPHA | SPI_InitStruct->SPI_NSS |
+					  SPI_InitStruct->SPI_BaudRatePrescaler | SPI_InitStruct->SPI_FirstBit);
+	SPIx->CR1 = cr1;
+	SPIx->CRCPR = SPI_InitStruct->SPI_CRCPolynomial;
+}
+
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState)
+{
+	if (NewState != DISABLE)
+		SPIx->CR1 |= SPI_CR1_SPE;
+	else
+		SPIx->CR1 &= (uint16_t)~SPI_CR1_SPE;
+}
+
+void SPI_I2S_ITConfig(SPI_TypeDef* SPIx, uint8_t SPI_I2S_IT, FunctionalState NewState)
+{
+	uint16_t mask = (uint16_t)(1U << (SPI_I2S_IT >> 4));
+	if (NewState != DISABLE)
+		SPIx->CR2 |= mask;
+	else
+		SPIx->CR2 &= (uint16_t)~mask;
+}
+
+ITStatus SPI_I2S_GetITStatus(SPI_TypeDef* SPIx, uint8_t SPI_I2S_IT)
+{
+	uint16_t flag = (uint16_t)(1U << (SPI_I2S_IT & 0x0F));
+	uint16_t enable = (uint16_t)(1U << (SPI_I2S_IT >> 4));
+	return ((SPIx->SR & flag) && (SPIx->CR2 & enable)) ? SET : RESET;
+}
+
+void SPI_I2S_SendData(SPI_TypeDef* SPIx, uint16_t Data)
+{
+	SPIx->DR = Data;
+}
+
+uint16_t SPI_I2S_ReceiveData(SPI_TypeDef* SPIx)
+{
+	return SPIx->DR;
+}
+
+/* DMA -----------------------------------------------------------------------*/
+void DMA_DeInit(DMA_Channel_TypeDef* DMAy_Channelx)
+{
+	uint32_t channel = ((uint32_t)(uintptr_t)DMAy_Channelx - DMA1_Channel1_BASE) / 0x14;
+	DMAy_Channelx->CCR &= ~(uint32_t)DMA_CCR1_EN;
+	DMAy_Channelx->CCR = 0;
+	DMAy_Channelx->CNDTR = 0;
+	DMAy_Channelx->CPAR = 0;
+	DMAy_Channelx->CMAR = 0;
+	DMA1->IFCR = 0xFU << (4 * channel);
+}
+
+void DMA_Init(DMA_Channel_TypeDef* DMAy_Channelx, DMA_InitTypeDef* DMA_InitStruct)
+{
+	uint32_t ccr = DMAy_Channelx->CCR;
+	ccr &= CCR_CLEAR_MASK;
+	ccr |= DMA_InitStruct->DMA_DIR | DMA_InitStruct->DMA_Mode |
+		   DMA_InitStruct->DMA_PeripheralInc | DMA_InitStruct->DMA_MemoryInc |
+		   DMA_InitStruct->DMA_PeripheralDataSize | DMA_InitStruct->DMA_MemoryDataSize |
+		   DMA_InitStruct->DMA_Priority | DMA_InitStruct->DMA_M2M;
+	DMAy_Channelx->CCR = ccr;
+	DMAy_Channelx->CNDTR = DMA_InitStruct->DMA_BufferSize;
+	DMAy_Channelx->CPAR = DMA_InitStruct->DMA_PeripheralBaseAddr;
+	DMAy_Channelx->CMAR = DMA_InitStruct->DMA_MemoryBaseAddr;
+}
+
+void DMA_ITConfig(DMA_Channel_TypeDef* DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState)
+{
+	if (NewState != DISABLE)
+		DMAy_Channelx->CCR |= DMA_IT;
+	else
+		DMAy_Channelx->CCR &= ~DMA_IT;
+}
+
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT)
+{
+	return (DMA1->ISR & DMAy_IT) ? SET : RESET;
+}
+
+void DMA_ClearITPendingBit(uint32_t DMAy_IT)
+{
+	DMA1->IFCR = DMAy_IT;
+}
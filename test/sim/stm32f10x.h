@@ -0,0 +1,479 @@
+/**
+ ******************************************************************************
+ * @file	stm32f10x.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Replaces the device header and the StdPeriph library for the host
+ *			simulator. The registers are at the same addresses as on the
+ *			STM32F10x and are accessed exactly like on the device, the
+ *			simulator traps every access, see sim.c. Only the parts used by
+ *			the drivers under test are here:
+ *			- SPI1, SPI2 (8 bit master)
+ *			- DMA1 channels 1-7
+ *			- GPIOA-C, EXTI, NVIC
+ *			- DWT cycle counter
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef STM32F10X_H_
+#define STM32F10X_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32f10x_host.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define __IO	volatile
+
+/* Typedefs ------------------------------------------------------------------*/
+typedef enum
+{
+	EXTI0_IRQn				= 6,
+	EXTI1_IRQn				= 7,
+	EXTI2_IRQn				= 8,
+	EXTI3_IRQn				= 9,
+	EXTI4_IRQn				= 10,
+	DMA1_Channel1_IRQn		= 11,
+	DMA1_Channel2_IRQn		= 12,
+	DMA1_Channel3_IRQn		= 13,
+	DMA1_Channel4_IRQn		= 14,
+	DMA1_Channel5_IRQn		= 15,
+	DMA1_Channel6_IRQn		= 16,
+	DMA1_Channel7_IRQn		= 17,
+	EXTI9_5_IRQn			= 23,
+	SPI1_IRQn				= 35,
+	SPI2_IRQn				= 36,
+	EXTI15_10_IRQn			= 40,
+} IRQn_Type;
+
+typedef struct
+{
+	__IO uint16_t CR1;
+	uint16_t  RESERVED0;
+	__IO uint16_t CR2;
+	uint16_t  RESERVED1;
+	__IO uint16_t SR;
+	uint16_t  RESERVED2;
+	__IO uint16_t DR;
+	uint16_t  RESERVED3;
+	__IO uint16_t CRCPR;
+	uint16_t  RESERVED4;
+	__IO uint16_t RXCRCR;
+	uint16_t  RESERVED5;
+	__IO uint16_t TXCRCR;
+	uint16_t  RESERVED6;
+} SPI_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CCR;
+	__IO uint32_t CNDTR;
+	__IO uint32_t CPAR;
+	__IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t ISR;
+	__IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CRL;
+	__IO uint32_t CRH;
+	__IO uint32_t IDR;
+	__IO uint32_t ODR;
+	__IO uint32_t BSRR;
+	__IO uint32_t BRR;
+	__IO uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t EVCR;
+	__IO uint32_t MAPR;
+	__IO uint32_t EXTICR[4];
+} AFIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t IMR;
+	__IO uint32_t EMR;
+	__IO uint32_t RTSR;
+	__IO uint32_t FTSR;
+	__IO uint32_t SWIER;
+	__IO uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+	__IO uint32_t DHCSR;
+	__IO uint32_t DCRSR;
+	__IO uint32_t DCRDR;
+	__IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* Memory map ----------------------------------------------------------------*/
+#define PERIPH_BASE			((uint32_t)0x40000000)
+#define APB1PERIPH_BASE		PERIPH_BASE
+#define APB2PERIPH_BASE		(PERIPH_BASE + 0x10000)
+#define AHBPERIPH_BASE		(PERIPH_BASE + 0x20000)
+
+#define SPI2_BASE			(APB1PERIPH_BASE + 0x3800)
+#define AFIO_BASE			(APB2PERIPH_BASE + 0x0000)
+#define EXTI_BASE			(APB2PERIPH_BASE + 0x0400)
+#define GPIOA_BASE			(APB2PERIPH_BASE + 0x0800)
+#define GPIOB_BASE			(APB2PERIPH_BASE + 0x0C00)
+#define GPIOC_BASE			(APB2PERIPH_BASE + 0x1000)
+#define SPI1_BASE			(APB2PERIPH_BASE + 0x3000)
+#define DMA1_BASE			(AHBPERIPH_BASE + 0x0000)
+#define DMA1_Channel1_BASE	(AHBPERIPH_BASE + 0x0008)
+#define DMA1_Channel2_BASE	(AHBPERIPH_BASE + 0x001C)
+#define DMA1_Channel3_BASE	(AHBPERIPH_BASE + 0x0030)
+#define DMA1_Channel4_BASE	(AHBPERIPH_BASE + 0x0044)
+#define DMA1_Channel5_BASE	(AHBPERIPH_BASE + 0x0058)
+#define DMA1_Channel6_BASE	(AHBPERIPH_BASE + 0x006C)
+#define DMA1_Channel7_BASE	(AHBPERIPH_BASE + 0x0080)
+#define DWT_BASE			((uint32_t)0xE0001000)
+#define CoreDebug_BASE		((uint32_t)0xE000EDF0)
+
+#define SPI1				((SPI_TypeDef*)SPI1_BASE)
+#define SPI2				((SPI_TypeDef*)SPI2_BASE)
+#define AFIO				((AFIO_TypeDef*)AFIO_BASE)
+#define EXTI				((EXTI_TypeDef*)EXTI_BASE)
+#define GPIOA				((GPIO_TypeDef*)GPIOA_BASE)
+#define GPIOB				((GPIO_TypeDef*)GPIOB_BASE)
+#define GPIOC				((GPIO_TypeDef*)GPIOC_BASE)
+#define DMA1				((DMA_TypeDef*)DMA1_BASE)
+#define DMA1_Channel1		((DMA_Channel_TypeDef*)DMA1_Channel1_BASE)
+#define DMA1_Channel2		((DMA_Channel_TypeDef*)DMA1_Channel2_BASE)
+#define DMA1_Channel3		((DMA_Channel_TypeDef*)DMA1_Channel3_BASE)
+#define DMA1_Channel4		((DMA_Channel_TypeDef*)DMA1_Channel4_BASE)
+#define DMA1_Channel5		((DMA_Channel_TypeDef*)DMA1_Channel5_BASE)
+#define DMA1_Channel6		((DMA_Channel_TypeDef*)DMA1_Channel6_BASE)
+#define DMA1_Channel7		((DMA_Channel_TypeDef*)DMA1_Channel7_BASE)
+#define DWT					((DWT_Type*)DWT_BASE)
+#define CoreDebug			((CoreDebug_Type*)CoreDebug_BASE)
+
+/* Register bits -------------------------------------------------------------*/
+#define SPI_CR1_CPHA		((uint16_t)0x0001)
+#define SPI_CR1_CPOL		((uint16_t)0x0002)
+#define SPI_CR1_MSTR		((uint16_t)0x0004)
+#define SPI_CR1_BR			((uint16_t)0x0038)
+#define SPI_CR1_SPE			((uint16_t)0x0040)
+#define SPI_CR1_LSBFIRST	((uint16_t)0x0080)
+#define SPI_CR1_SSI			((uint16_t)0x0100)
+#define SPI_CR1_SSM			((uint16_t)0x0200)
+#define SPI_CR1_DFF			((uint16_t)0x0800)
+
+#define SPI_CR2_RXDMAEN		((uint8_t)0x01)
+#define SPI_CR2_TXDMAEN		((uint8_t)0x02)
+#define SPI_CR2_SSOE		((uint8_t)0x04)
+#define SPI_CR2_ERRIE		((uint8_t)0x20)
+#define SPI_CR2_RXNEIE		((uint8_t)0x40)
+#define SPI_CR2_TXEIE		((uint8_t)0x80)
+
+#define SPI_SR_RXNE			((uint8_t)0x01)
+#define SPI_SR_TXE			((uint8_t)0x02)
+#define SPI_SR_OVR			((uint8_t)0x40)
+#define SPI_SR_BSY			((uint8_t)0x80)
+
+#define DMA_CCR1_EN			((uint16_t)0x0001)
+#define DMA_CCR1_TCIE		((uint16_t)0x0002)
+#define DMA_CCR1_HTIE		((uint16_t)0x0004)
+#define DMA_CCR1_TEIE		((uint16_t)0x0008)
+#define DMA_CCR1_DIR		((uint16_t)0x0010)
+#define DMA_CCR1_CIRC		((uint16_t)0x0020)
+#define DMA_CCR1_PINC		((uint16_t)0x0040)
+#define DMA_CCR1_MINC		((uint16_t)0x0080)
+#define DMA_CCR1_PSIZE		((uint16_t)0x0300)
+#define DMA_CCR1_MSIZE		((uint16_t)0x0C00)
+#define DMA_CCR1_PL			((uint16_t)0x3000)
+#define DMA_CCR1_MEM2MEM	((uint16_t)0x4000)
+
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0)
+
+/* GPIO ----------------------------------------------------------------------*/
+#define GPIO_Pin_0			((uint16_t)0x0001)
+#define GPIO_Pin_1			((uint16_t)0x0002)
+#define GPIO_Pin_2			((uint16_t)0x0004)
+#define GPIO_Pin_3			((uint16_t)0x0008)
+#define GPIO_Pin_4			((uint16_t)0x0010)
+#define GPIO_Pin_5			((uint16_t)0x0020)
+#define GPIO_Pin_6			((uint16_t)0x0040)
+#define GPIO_Pin_7			((uint16_t)0x0080)
+#define GPIO_Pin_8			((uint16_t)0x0100)
+#define GPIO_Pin_9			((uint16_t)0x0200)
+#define GPIO_Pin_10			((uint16_t)0x0400)
+#define GPIO_Pin_11			((uint16_t)0x0800)
+#define GPIO_Pin_12			((uint16_t)0x1000)
+#define GPIO_Pin_13			((uint16_t)0x2000)
+#define GPIO_Pin_14			((uint16_t)0x4000)
+#define GPIO_Pin_15			((uint16_t)0x8000)
+
+#define GPIO_PortSourceGPIOA	((uint8_t)0x00)
+#define GPIO_PortSourceGPIOB	((uint8_t)0x01)
+#define GPIO_PortSourceGPIOC	((uint8_t)0x02)
+
+#define GPIO_PinSource0		((uint8_t)0x00)
+#define GPIO_PinSource1		((uint8_t)0x01)
+#define GPIO_PinSource2		((uint8_t)0x02)
+#define GPIO_PinSource3		((uint8_t)0x03)
+#define GPIO_PinSource4		((uint8_t)0x04)
+#define GPIO_PinSource5		((uint8_t)0x05)
+#define GPIO_PinSource6		((uint8_t)0x06)
+#define GPIO_PinSource7		((uint8_t)0x07)
+#define GPIO_PinSource8		((uint8_t)0x08)
+#define GPIO_PinSource9		((uint8_t)0x09)
+#define GPIO_PinSource10	((uint8_t)0x0A)
+#define GPIO_PinSource11	((uint8_t)0x0B)
+#define GPIO_PinSource12	((uint8_t)0x0C)
+#define GPIO_PinSource13	((uint8_t)0x0D)
+#define GPIO_PinSource14	((uint8_t)0x0E)
+#define GPIO_PinSource15	((uint8_t)0x0F)
+
+typedef enum
+{
+	GPIO_Speed_10MHz = 1,
+	GPIO_Speed_2MHz,
+	GPIO_Speed_50MHz
+} GPIOSpeed_TypeDef;
+
+typedef enum
+{
+	GPIO_Mode_AIN = 0x0,
+	GPIO_Mode_IN_FLOATING = 0x04,
+	GPIO_Mode_IPD = 0x28,
+	GPIO_Mode_IPU = 0x48,
+	GPIO_Mode_Out_OD = 0x14,
+	GPIO_Mode_Out_PP = 0x10,
+	GPIO_Mode_AF_OD = 0x1C,
+	GPIO_Mode_AF_PP = 0x18
+} GPIOMode_TypeDef;
+
+typedef struct
+{
+	uint16_t GPIO_Pin;
+	GPIOSpeed_TypeDef GPIO_Speed;
+	GPIOMode_TypeDef GPIO_Mode;
+} GPIO_InitTypeDef;
+
+/* EXTI ----------------------------------------------------------------------*/
+#define EXTI_Line0			((uint32_t)0x00001)
+#define EXTI_Line1			((uint32_t)0x00002)
+#define EXTI_Line2			((uint32_t)0x00004)
+#define EXTI_Line3			((uint32_t)0x00008)
+#define EXTI_Line4			((uint32_t)0x00010)
+#define EXTI_Line5			((uint32_t)0x00020)
+#define EXTI_Line6			((uint32_t)0x00040)
+#define EXTI_Line7			((uint32_t)0x00080)
+#define EXTI_Line8			((uint32_t)0x00100)
+#define EXTI_Line9			((uint32_t)0x00200)
+#define EXTI_Line10			((uint32_t)0x00400)
+#define EXTI_Line11			((uint32_t)0x00800)
+#define EXTI_Line12			((uint32_t)0x01000)
+#define EXTI_Line13			((uint32_t)0x02000)
+#define EXTI_Line14			((uint32_t)0x04000)
+#define EXTI_Line15			((uint32_t)0x08000)
+
+typedef enum
+{
+	EXTI_Mode_Interrupt = 0x00,
+	EXTI_Mode_Event = 0x04
+} EXTIMode_TypeDef;
+
+typedef enum
+{
+	EXTI_Trigger_Rising = 0x08,
+	EXTI_Trigger_Falling = 0x0C,
+	EXTI_Trigger_Rising_Falling = 0x10
+} EXTITrigger_TypeDef;
+
+typedef struct
+{
+	uint32_t EXTI_Line;
+	EXTIMode_TypeDef EXTI_Mode;
+	EXTITrigger_TypeDef EXTI_Trigger;
+	FunctionalState EXTI_LineCmd;
+} EXTI_InitTypeDef;
+
+/* NVIC ----------------------------------------------------------------------*/
+typedef struct
+{
+	uint8_t NVIC_IRQChannel;
+	uint8_t NVIC_IRQChannelPreemptionPriority;
+	uint8_t NVIC_IRQChannelSubPriority;
+	FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+/* SPI -----------------------------------------------------------------------*/
+#define SPI_Direction_2Lines_FullDuplex	((uint16_t)0x0000)
+#define SPI_Mode_Master					((uint16_t)0x0104)
+#define SPI_Mode_Slave					((uint16_t)0x0000)
+#define SPI_DataSize_16b				((uint16_t)0x0800)
+#define SPI_DataSize_8b					((uint16_t)0x0000)
+#define SPI_CPOL_Low					((uint16_t)0x0000)
+#define SPI_CPOL_High					((uint16_t)0x0002)
+#define SPI_CPHA_1Edge					((uint16_t)0x0000)
+#define SPI_CPHA_2Edge					((uint16_t)0x0001)
+#define SPI_NSS_Soft					((uint16_t)0x0200)
+#define SPI_NSS_Hard					((uint16_t)0x0000)
+#define SPI_BaudRatePrescaler_2			((uint16_t)0x0000)
+#define SPI_BaudRatePrescaler_4			((uint16_t)0x0008)
+#define SPI_BaudRatePrescaler_8			((uint16_t)0x0010)
+#define SPI_BaudRatePrescaler_16		((uint16_t)0x0018)
+#define SPI_BaudRatePrescaler_32		((uint16_t)0x0020)
+#define SPI_BaudRatePrescaler_64		((uint16_t)0x0028)
+#define SPI_BaudRatePrescaler_128		((uint16_t)0x0030)
+#define SPI_BaudRatePrescaler_256		((uint16_t)0x0038)
+#define SPI_FirstBit_MSB				((uint16_t)0x0000)
+#define SPI_FirstBit_LSB				((uint16_t)0x0080)
+
+#define SPI_I2S_IT_TXE					((uint8_t)0x71)
+#define SPI_I2S_IT_RXNE					((uint8_t)0x60)
+#define SPI_I2S_IT_ERR					((uint8_t)0x50)
+
+typedef struct
+{
+	uint16_t SPI_Direction;
+	uint16_t SPI_Mode;
+	uint16_t SPI_DataSize;
+	uint16_t SPI_CPOL;
+	uint16_t SPI_CPHA;
+	uint16_t SPI_NSS;
+	uint16_t SPI_BaudRatePrescaler;
+	uint16_t SPI_FirstBit;
+	uint16_t SPI_CRCPolynomial;
+} SPI_InitTypeDef;
+
+/* DMA -----------------------------------------------------------------------*/
+#define DMA_DIR_PeripheralDST			((uint32_t)0x00000010)
+#define DMA_DIR_PeripheralSRC			((uint32_t)0x00000000)
+#define DMA_PeripheralInc_Enable		((uint32_t)0x00000040)
+#define DMA_PeripheralInc_Disable		((uint32_t)0x00000000)
+#define DMA_MemoryInc_Enable			((uint32_t)0x00000080)
+#define DMA_MemoryInc_Disable			((uint32_t)0x00000000)
+#define DMA_PeripheralDataSize_Byte		((uint32_t)0x00000000)
+#define DMA_MemoryDataSize_Byte			((uint32_t)0x00000000)
+#define DMA_Mode_Circular				((uint32_t)0x00000020)
+#define DMA_Mode_Normal					((uint32_t)0x00000000)
+#define DMA_Priority_VeryHigh			((uint32_t)0x00003000)
+#define DMA_Priority_High				((uint32_t)0x00002000)
+#define DMA_Priority_Medium				((uint32_t)0x00001000)
+#define DMA_Priority_Low				((uint32_t)0x00000000)
+#define DMA_M2M_Enable					((uint32_t)0x00004000)
+#define DMA_M2M_Disable					((uint32_t)0x00000000)
+
+#define DMA_IT_TC						((uint32_t)0x00000002)
+#define DMA_IT_HT						((uint32_t)0x00000004)
+#define DMA_IT_TE						((uint32_t)0x00000008)
+
+#define DMA1_IT_GL1		((uint32_t)0x00000001)
+#define DMA1_IT_TC1		((uint32_t)0x00000002)
+#define DMA1_IT_HT1		((uint32_t)0x00000004)
+#define DMA1_IT_TE1		((uint32_t)0x00000008)
+#define DMA1_IT_GL2		((uint32_t)0x00000010)
+#define DMA1_IT_TC2		((uint32_t)0x00000020)
+#define DMA1_IT_HT2		((uint32_t)0x00000040)
+#define DMA1_IT_TE2		((uint32_t)0x00000080)
+#define DMA1_IT_GL3		((uint32_t)0x00000100)
+#define DMA1_IT_TC3		((uint32_t)0x00000200)
+#define DMA1_IT_HT3		((uint32_t)0x00000400)
+#define DMA1_IT_TE3		((uint32_t)0x00000800)
+#define DMA1_IT_GL4		((uint32_t)0x00001000)
+#define DMA1_IT_TC4		((uint32_t)0x00002000)
+#define DMA1_IT_HT4		((uint32_t)0x00004000)
+#define DMA1_IT_TE4		((uint32_t)0x00008000)
+#define DMA1_IT_GL5		((uint32_t)0x00010000)
+#define DMA1_IT_TC5		((uint32_t)0x00020000)
+#define DMA1_IT_HT5		((uint32_t)0x00040000)
+#define DMA1_IT_TE5		((uint32_t)0x00080000)
+#define DMA1_IT_GL6		((uint32_t)0x00100000)
+#define DMA1_IT_TC6		((uint32_t)0x00200000)
+#define DMA1_IT_HT6		((uint32_t)0x00400000)
+#define DMA1_IT_TE6		((uint32_t)0x00800000)
+#define DMA1_IT_GL7		((uint32_t)0x01000000)
+#define DMA1_IT_TC7		((uint32_t)0x02000000)
+#define DMA1_IT_HT7		((uint32_t)0x04000000)
+#define DMA1_IT_TE7		((uint32_t)0x08000000)
+
+typedef struct
+{
+	uint32_t DMA_PeripheralBaseAddr;
+	uint32_t DMA_MemoryBaseAddr;
+	uint32_t DMA_DIR;
+	uint32_t DMA_BufferSize;
+	uint32_t DMA_PeripheralInc;
+	uint32_t DMA_MemoryInc;
+	uint32_t DMA_PeripheralDataSize;
+	uint32_t DMA_MemoryDataSize;
+	uint32_t DMA_Mode;
+	uint32_t DMA_Priority;
+	uint32_t DMA_M2M;
+} DMA_InitTypeDef;
+
+/* RCC -----------------------------------------------------------------------*/
+#define RCC_AHBPeriph_DMA1				((uint32_t)0x00000001)
+#define RCC_APB2Periph_AFIO				((uint32_t)0x00000001)
+#define RCC_APB2Periph_GPIOA			((uint32_t)0x00000004)
+#define RCC_APB2Periph_GPIOB			((uint32_t)0x00000008)
+#define RCC_APB2Periph_GPIOC			((uint32_t)0x00000010)
+#define RCC_APB2Periph_SPI1				((uint32_t)0x00001000)
+#define RCC_APB1Periph_SPI2				((uint32_t)0x00004000)
+
+/* Function prototypes -------------------------------------------------------*/
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState);
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState);
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState);
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct);
+void GPIO_EXTILineConfig(uint8_t GPIO_PortSource, uint8_t GPIO_PinSource);
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct);
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line);
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line);
+
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct);
+
+void SPI_Init(SPI_TypeDef* SPIx, SPI_InitTypeDef* SPI_InitStruct);
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState);
+void SPI_I2S_ITConfig(SPI_TypeDef* SPIx, uint8_t SPI_I2S_IT, FunctionalState NewState);
+ITStatus SPI_I2S_GetITStatus(SPI_TypeDef* SPIx, uint8_t SPI_I2S_IT);
+void SPI_I2S_SendData(SPI_TypeDef* SPIx, uint16_t Data);
+uint16_t SPI_I2S_ReceiveData(SPI_TypeDef* SPIx);
+
+void DMA_DeInit(DMA_Channel_TypeDef* DMAy_Channelx);
+void DMA_Init(DMA_Channel_TypeDef* DMAy_Channelx, DMA_InitTypeDef* DMA_InitStruct);
+void DMA_ITConfig(DMA_Channel_TypeDef* DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState);
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT);
+void DMA_ClearITPendingBit(uint32_t DMAy_IT);
+
+/* Interrupt handlers, the application defines the ones it uses */
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void DMA1_Channel1_IRQHandler(void);
+void DMA1_Channel2_IRQHandler(void);
+void DMA1_Channel3_IRQHandler(void);
+void DMA1_Channel4_IRQHandler(void);
+void DMA1_Channel5_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+void DMA1_Channel7_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void SPI1_IRQHandler(void);
+void SPI2_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+#endif /* STM32F10X_H_ */
@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * @file	task.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Task functions of the FreeRTOS API for the host simulator
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define taskSCHEDULER_NOT_STARTED	((BaseType_t)1)
+#define taskSCHEDULER_RUNNING		((BaseType_t)2)
+
+/* Function prototypes -------------------------------------------------------*/
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* const pcName, uint16_t usStackDepth,
+					   void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+void vTaskStartScheduler(void);
+BaseType_t xTaskGetSchedulerState(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken);
+
+void vTaskSetTimeOutState(TimeOut_t* const pxTimeOut);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* const pxTimeOut, TickType_t* const pxTicksToWait);
+
+#endif /* INC_TASK_H */
@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * @file	bench_modes.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Compares the polled, interrupt and DMA transfer modes of the SPI
+ *			driver in the simulator, for SPI1 at 9 MHz (prescaler 8). For each
+ *			length and mode it reports the time per transfer, the throughput,
+ *			the interrupts and context switches per transfer and how much of
+ *			the time the CPU was busy. The bus timing is exact, the CPU costs
+ *			are the estimates in sim.h
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "spi/spi.h"
+
+#include <stdio.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define ITERATIONS		(20)
+#define MAX_LENGTH		(64)
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+static SPI_Slave slave = { .SPIDevice = &spi1, .CS_GPIO = GPIOA, .CS_Pin = GPIO_Pin_4,
+						   .BaudRatePrescaler = SPI_BaudRatePrescaler_8 };
+static SIM_CounterSlave model = { .Slave.Name = "counter" };
+
+static uint8_t txData[MAX_LENGTH];
+static uint8_t rxData[MAX_LENGTH];
+
+static const uint16_t lengths[] = { 1, 2, 4, 8, 16, 32, 64 };
+static const char* modeNames[] = { "polled", "interrupt", "DMA" };
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief	Times ITERATIONS transfers of one length in one mode, the chip
+ *			select is held so only the transfer itself is measured
+ */
+static void prvMeasure(uint16_t Length, SPI_TransferMode Mode)
+{
+	if (Mode == SPI_TransferMode_Polled)
+		SPI_SetThresholds(&spi1, MAX_LENGTH, MAX_LENGTH + 1);
+	else if (Mode == SPI_TransferMode_Interrupt)
+		SPI_SetThresholds(&spi1, 0, MAX_LENGTH + 1);
+	else
+		SPI_SetThresholds(&spi1, 0, 1);
+
+	SPI_Select(&slave, portMAX_DELAY);
+	SIM_Statistics sim;
+	SIM_ResetStatistics();
+	uint64_t start = SIM_GetCycles();
+	for (uint32_t i = 0; i < ITERATIONS; i++)
+		SPI_Transfer(&spi1, txData, rxData, Length, portMAX_DELAY);
+	uint64_t cycles = SIM_GetCycles() - start;
+	SIM_GetStatistics(&sim);
+	SPI_Deselect(&slave);
+
+	uint32_t interrupts = sim.interrupts[SPI1_IRQn] + sim.interrupts[DMA1_Channel2_IRQn];
+	printf("%6u %-9s %8.1f %10.0f %8.1f %8.1f %6.0f%% %8lu\n",
+		   Length, modeNames[Mode],
+		   (double)cycles / ITERATIONS,
+		   (double)Length * ITERATIONS * SIM_CPU_CLOCK_HZ / cycles / 1000.0,
+		   (double)interrupts / ITERATIONS,
+		   (double)sim.contextSwitches / ITERATIONS,
+		   100.0 * (double)(cycles - sim.idleCycles) / cycles,
+		   (unsigned long)sim.spiOverruns[0]);
+}
+
+static void prvBenchTask(void* pvParameters)
+{
+	(void)pvParameters;
+	SPI_Device_Init(&spi1);
+	SPI_SlaveInit(&slave);
+	SIM_CounterSlave_Init(&model, SPI1, GPIOA, GPIO_Pin_4);
+
+	printf("SPI1 at %lu Hz, %u transfers per row\n",
+		   (unsigned long)(SIM_CPU_CLOCK_HZ / 8), ITERATIONS);
+	printf("%6s %-9s %8s %10s %8s %8s %7s %8s\n",
+		   "length", "mode", "cycles", "kbytes/s", "irqs", "switches", "cpu", "overruns");
+	for (uint32_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		for (uint32_t mode = SPI_TransferMode_Polled; mode <= SPI_TransferMode_DMA; mode++)
+			prvMeasure(lengths[i], (SPI_TransferMode)mode);
+	}
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	for (uint32_t i = 0; i < MAX_LENGTH; i++)
+		txData[i] = (uint8_t)i;
+
+	xTaskCreate(prvBenchTask, "bench", configMINIMAL_STACK_SIZE, 0, 2, 0);
+	vTaskStartScheduler();
+	return 0;
+}
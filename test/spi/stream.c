@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ * @file	stream.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests SPI_StartStream in the simulator at the highest SPI1 clock
+ *			of the STM32F103, 18 MHz. A slave sends a byte counter, the half
+ *			callback passes each half to a task which checks that the counter
+ *			continues where the last half ended while the other half fills.
+ *			- With the task spending half of the frame time on each frame no
+ *			  frame is dropped, the bus never pauses and nothing overruns
+ *			- With the interrupts masked for longer than a frame the lost
+ *			  frame is counted in Overruns
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "spi/spi.h"
+
+#include <stdio.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define HALF_LENGTH			(64)
+#define FRAMES				(2000)
+#define BYTE_CYCLES			(8 * 4)		/* Prescaler 4 on the 72 MHz APB2 */
+#define FRAME_CYCLES		(HALF_LENGTH * BYTE_CYCLES)
+#define PENDING_SIZE		(4)
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+static SPI_Slave slave = { .SPIDevice = &spi1, .CS_GPIO = GPIOA, .CS_Pin = GPIO_Pin_4,
+						   .BaudRatePrescaler = SPI_BaudRatePrescaler_4 };
+static SIM_CounterSlave model = { .Slave.Name = "counter" };
+
+static void prvHalfDone(SPI_Stream* Stream, uint8_t Half, BaseType_t* pxHigherPriorityTaskWoken);
+
+static uint8_t rxData[2 * HALF_LENGTH];
+static SPI_Stream stream = { .Slave = &slave, .RxData = rxData, .HalfLength = HALF_LENGTH, .Callback = prvHalfDone };
+
+static TaskHandle_t consumerTask;
+static volatile uint8_t pending[PENDING_SIZE];	/* Halves waiting for the consumer */
+static volatile uint32_t pendingIn;
+static uint32_t pendingOut;
+
+static uint32_t frames;
+static uint32_t lateFrames;
+static uint32_t gaps;
+static uint8_t expected;
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What)
+{
+	if (!Condition && errors++ < 20)
+		printf("  %s failed\n", What);
+}
+
+static void prvHalfDone(SPI_Stream* Stream, uint8_t Half, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	(void)Stream;
+	pending[pendingIn++ % PENDING_SIZE] = Half;
+	vTaskNotifyGiveFromISR(consumerTask, pxHigherPriorityTaskWoken);
+}
+
+static void prvCountHalf(SPI_Stream* Stream, uint8_t Half, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	(void)Stream;
+	(void)Half;
+	(void)pxHigherPriorityTaskWoken;
+	lateFrames++;
+}
+
+/**
+ * @brief	Checks the frames as they arrive
+ */
+static void prvConsumerTask(void* pvParameters)
+{
+	(void)pvParameters;
+	while (ulTaskNotifyTake(pdFALSE, 10) != 0)
+	{
+		const uint8_t* half = &rxData[pending[pendingOut++ % PENDING_SIZE] * HALF_LENGTH];
+		if (half[0] != expected)
+			gaps++;
+		for (uint32_t i = 1; i < HALF_LENGTH; i++)
+		{
+			if (half[i] != (uint8_t)(half[0] + i))
+				gaps++;
+		}
+		expected = (uint8_t)(half[HALF_LENGTH - 1] + 1);
+		frames++;
+
+		/* Processing the frame takes half of the time the next one takes to arrive */
+		SIM_Spend(FRAME_CYCLES / 2);
+	}
+}
+
+/**
+ * @brief	Streams FRAMES frames with a consumer that keeps up
+ */
+static void prvTestFullRate(void)
+{
+	SIM_Statistics sim;
+	xTaskCreate(prvConsumerTask, "consumer", configMINIMAL_STACK_SIZE, 0, 3, &consumerTask);
+
+	prvExpect(SPI_StartStream(&stream, portMAX_DELAY) == SUCCESS, "SPI_StartStream");
+	SIM_ResetStatistics();
+	uint64_t start = SIM_GetCycles();
+	while (frames < FRAMES)
+		vTaskDelay(1);
+	uint64_t cycles = SIM_GetCycles() - start;
+	SIM_GetStatistics(&sim);
+	SPI_StopStream(&stream);
+	vTaskDelay(20);
+
+	prvExpect(gaps == 0, "no gaps in the data");
+	prvExpect(stream.Overruns == 0, "no stream overruns");
+	prvExpect(sim.spiOverruns[0] == 0, "no SPI overruns");
+	prvExpect(model.Slave.selects == 1 && model.Slave.deselects == 1, "one chip select for the whole stream");
+	/* The bus has to shift all the time, one byte of slack for the start */
+	prvExpect(sim.spiBusyCycles[0] + BYTE_CYCLES >= cycles, "no pauses on the bus");
+	prvExpect(sim.interrupts[DMA1_Channel2_IRQn] == sim.spiBytes[0] / HALF_LENGTH ||
+			  sim.interrupts[DMA1_Channel2_IRQn] == sim.spiBytes[0] / HALF_LENGTH + 1, "one interrupt per frame");
+
+	printf("  %lu frames of %u bytes at %lu bytes/s: %lu gaps, %lu overruns, bus busy %.1f%%, cpu busy %.1f%%\n",
+		   (unsigned long)frames, HALF_LENGTH, (unsigned long)((uint64_t)sim.spiBytes[0] * SIM_CPU_CLOCK_HZ / cycles),
+		   (unsigned long)gaps, (unsigned long)stream.Overruns,
+		   100.0 * (double)sim.spiBusyCycles[0] / cycles, 100.0 * (double)(cycles - sim.idleCycles) / cycles);
+}
+
+/**
+ * @brief	Masks the interrupts longer than a frame during a stream
+ */
+static void prvTestLateInterrupt(void)
+{
+	/* The consumer is done, the callback only counts */
+	stream.Callback = prvCountHalf;
+	prvExpect(SPI_StartStream(&stream, portMAX_DELAY) == SUCCESS, "SPI_StartStream");
+	vTaskDelay(1);
+
+	taskENTER_CRITICAL();
+	SIM_Spend(3 * FRAME_CYCLES);
+	taskEXIT_CRITICAL();
+
+	vTaskDelay(1);
+	SPI_StopStream(&stream);
+	vTaskDelay(20);
+
+	prvExpect(stream.Overruns > 0, "overrun counted when the interrupt is late");
+	printf("  interrupts masked for 3 frames: %lu frames, %lu overruns counted\n",
+		   (unsigned long)lateFrames, (unsigned long)stream.Overruns);
+}
+
+static void prvTestTask(void* pvParameters)
+{
+	(void)pvParameters;
+	SPI_Device_Init(&spi1);
+	SPI_SlaveInit(&slave);
+	SIM_CounterSlave_Init(&model, SPI1, GPIOA, GPIO_Pin_4);
+
+	prvTestFullRate();
+	prvTestLateInterrupt();
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	xTaskCreate(prvTestTask, "test", configMINIMAL_STACK_SIZE, 0, 2, 0);
+	vTaskStartScheduler();
+
+	printf("spi stream: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,266 @@
+/**
+ ******************************************************************************
+ * @file	transfer.c
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Tests the SPI driver in the simulator with two slaves on SPI1 that
+ *			use different clocks:
+ *			- Every transfer mode moves the right data with the expected
+ *			  number of interrupts and one chip select per transfer
+ *			- The bus time follows the prescaler of the selected slave
+ *			- Submitted transactions are done in order
+ *			- SPI_Calibrate doesn't select a slave, and a transaction
+ *			  submitted by another task meanwhile is started when it's done
+ *			- The driver statistics agree with what the simulator counted
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "spi/spi.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define LENGTH			(16)
+#define TEST_PRIORITY	(2)
+#define HELPER_PRIORITY	(3)
+
+/* Private variables ---------------------------------------------------------*/
+static SPI_Device spi1 = { .SPI_Channel = 1, .SPIx = SPI1 };
+static SPI_Slave fastSlave = { .SPIDevice = &spi1, .CS_GPIO = GPIOA, .CS_Pin = GPIO_Pin_4,
+							   .BaudRatePrescaler = SPI_BaudRatePrescaler_4 };
+static SPI_Slave slowSlave = { .SPIDevice = &spi1, .CS_GPIO = GPIOB, .CS_Pin = GPIO_Pin_0,
+							   .BaudRatePrescaler = SPI_BaudRatePrescaler_16 };
+
+static uint8_t responses[LENGTH];
+static uint8_t fastLog[4 * LENGTH];
+static uint8_t slowLog[4 * LENGTH];
+static SIM_ScriptedSlave fastModel = { .Slave.Name = "fast", .Responses = responses, .ResponseCount = LENGTH,
+									   .RestartOnSelect = 1, .Log = fastLog, .LogSize = sizeof(fastLog) };
+static SIM_ScriptedSlave slowModel = { .Slave.Name = "slow", .Responses = responses, .ResponseCount = LENGTH,
+									   .RestartOnSelect = 1, .Log = slowLog, .LogSize = sizeof(slowLog) };
+
+static uint8_t txData[LENGTH];
+static uint8_t rxData[3][LENGTH];
+static SPI_Transaction transactions[3];
+static uint8_t doneOrder[3];
+static uint8_t doneCount;
+
+static SPI_Transaction calibrationTransaction;
+static uint8_t calibrationRx[LENGTH];
+static volatile uint8_t calibrating;
+static uint8_t submittedWhileCalibrating;
+
+static uint32_t errors;
+
+/* Private functions ---------------------------------------------------------*/
+static void prvExpect(int Condition, const char* What)
+{
+	if (!Condition && errors++ < 20)
+		printf("  %s failed\n", What);
+}
+
+static void prvTransactionDone(SPI_Transaction* Transaction, BaseType_t* pxHigherPriorityTaskWoken)
+{
+	(void)pxHigherPriorityTaskWoken;
+	doneOrder[doneCount++] = (uint8_t)(uintptr_t)Transaction->Context;
+}
+
+/**
+ * @brief	Does one transfer with the thresholds forced to a mode and checks
+ *			the data and the counts
+ */
+static void prvTestMode(SPI_TransferMode Mode, uint16_t PollMaxLength, uint16_t DMAMinLength, const char* Name)
+{
+	SIM_Statistics sim;
+	SPI_Statistics driver;
+	SPI_SetThresholds(&spi1, PollMaxLength, DMAMinLength);
+	prvExpect(SPI_GetTransferMode(&spi1, LENGTH) == Mode, "mode selection");
+
+	SIM_ResetStatistics();
+	SPI_ResetStatistics(&spi1);
+	uint32_t selects = fastModel.Slave.selects;
+	fastModel.logCount = 0;
+	memset(rxData[0], 0, LENGTH);
+
+	uint64_t start = SIM_GetCycles();
+	prvExpect(SPI_SlaveTransfer(&fastSlave, txData, rxData[0], LENGTH, portMAX_DELAY) == SUCCESS, "SPI_SlaveTransfer");
+	uint64_t cycles = SIM_GetCycles() - start;
+	SIM_GetStatistics(&sim);
+	SPI_GetStatistics(&spi1, &driver);
+
+	prvExpect(memcmp(rxData[0], responses, LENGTH) == 0, "received data");
+	prvExpect(fastModel.logCount == LENGTH && memcmp(fastLog, txData, LENGTH) == 0, "sent data");
+	prvExpect(fastModel.Slave.selects == selects + 1 && fastModel.Slave.emptySelects == 0, "one chip select per transfer");
+	prvExpect(sim.spiOverruns[0] == 0, "no overruns");
+
+	prvExpect(sim.interrupts[SPI1_IRQn] == ((Mode == SPI_TransferMode_Interrupt) ? LENGTH : 0), "SPI interrupts");
+	prvExpect(sim.interrupts[DMA1_Channel2_IRQn] == ((Mode == SPI_TransferMode_DMA) ? 1 : 0), "DMA interrupts");
+	prvExpect(driver.transfers[Mode] == 1 && driver.bytes[Mode] == LENGTH, "driver transfer count");
+	prvExpect(driver.spiInterrupts == sim.interrupts[SPI1_IRQn], "driver SPI interrupt count");
+	prvExpect(driver.dmaInterrupts == sim.interrupts[DMA1_Channel2_IRQn], "driver DMA interrupt count");
+	prvExpect(driver.selects == 1, "driver select count");
+	prvExpect(driver.transferTime.count == 1 && driver.transferTime.maxCycles <= cycles, "driver transfer time");
+
+	printf("  %-9s %2u bytes: %5lu cycles, %lu bytes/s, %2lu interrupts, %4lu register accesses, %lu RTOS calls, %lu context switches\n",
+		   Name, LENGTH, (unsigned long)cycles, (unsigned long)(LENGTH * SIM_CPU_CLOCK_HZ / cycles),
+		   (unsigned long)(sim.interrupts[SPI1_IRQn] + sim.interrupts[DMA1_Channel2_IRQn]),
+		   (unsigned long)sim.accesses, (unsigned long)sim.rtosCalls, (unsigned long)sim.contextSwitches);
+}
+
+/**
+ * @brief	Checks that the bus time follows the prescaler of each slave
+ */
+static void prvTestSlaveClocks(void)
+{
+	SIM_Statistics sim;
+	SPI_Statistics driver;
+	SPI_SetThresholds(&spi1, 0, 1);
+	SPI_ResetStatistics(&spi1);
+
+	const SPI_Slave* order[] = { &slowSlave, &fastSlave, &fastSlave, &slowSlave };
+	const uint32_t prescalers[] = { 16, 4, 4, 16 };
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		SIM_ResetStatistics();
+		SPI_SlaveTransfer((SPI_Slave*)order[i], txData, rxData[0], LENGTH, portMAX_DELAY);
+		SIM_GetStatistics(&sim);
+		prvExpect(sim.spiBusyCycles[0] == 8ULL * prescalers[i] * LENGTH, "bus time follows the slave prescaler");
+	}
+
+	/* The active slave was the fast one, so the first and last transfer switch */
+	SPI_GetStatistics(&spi1, &driver);
+	prvExpect(driver.slaveSwitches == 3, "CR1 only rewritten for another slave");
+}
+
+/**
+ * @brief	Submits transactions to both slaves and checks the order
+ */
+static void prvTestQueue(void)
+{
+	SPI_SetThresholds(&spi1, 0, 1);
+	uint32_t fastSelects = fastModel.Slave.selects;
+	uint32_t slowSelects = slowModel.Slave.selects;
+	doneCount = 0;
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		memset(rxData[i], 0, LENGTH);
+		transactions[i] = (SPI_Transaction) {
+			.Slave = (i == 1) ? &slowSlave : &fastSlave,
+			.TxData = txData,
+			.RxData = rxData[i],
+			.Length = LENGTH,
+			.Callback = prvTransactionDone,
+			.NotifyTask = xTaskGetCurrentTaskHandle(),
+			.Context = (void*)(uintptr_t)i,
+		};
+		prvExpect(SPI_Submit(&transactions[i]) == SUCCESS, "SPI_Submit");
+	}
+
+	uint32_t notifications = 0;
+	while (notifications < 3)
+		notifications += ulTaskNotifyTake(pdTRUE, 100);
+
+	prvExpect(doneCount == 3 && doneOrder[0] == 0 && doneOrder[1] == 1 && doneOrder[2] == 2, "transactions done in order");
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		prvExpect(transactions[i].Done, "Done set");
+		prvExpect(memcmp(rxData[i], responses, LENGTH) == 0, "queued transaction data");
+	}
+	prvExpect(fastModel.Slave.selects == fastSelects + 2 && slowModel.Slave.selects == slowSelects + 1, "one chip select per transaction");
+	prvExpect(SPI_Select(&fastSlave, 0) == SUCCESS, "bus released after the queue");
+	SPI_Deselect(&fastSlave);
+}
+
+/**
+ * @brief	Submits a transaction while the test task calibrates
+ */
+static void prvHelperTask(void* pvParameters)
+{
+	(void)pvParameters;
+	vTaskDelay(1);
+	submittedWhileCalibrating = calibrating;
+
+	calibrationTransaction = (SPI_Transaction) {
+		.Slave = &fastSlave,
+		.TxData = txData,
+		.RxData = calibrationRx,
+		.Length = LENGTH,
+		.NotifyTask = xTaskGetCurrentTaskHandle(),
+	};
+	prvExpect(SPI_Submit(&calibrationTransaction) == SUCCESS, "SPI_Submit during calibration");
+	prvExpect(ulTaskNotifyTake(pdTRUE, 1000) == 1, "transaction submitted during calibration is done");
+}
+
+static void prvTestCalibrate(void)
+{
+	uint32_t selects = fastModel.Slave.selects;
+	uint32_t emptySelects = fastModel.Slave.emptySelects;
+	fastModel.logCount = 0;
+
+	xTaskCreate(prvHelperTask, "helper", configMINIMAL_STACK_SIZE, 0, HELPER_PRIORITY, 0);
+	uint64_t start = SIM_GetCycles();
+	calibrating = 1;
+	SPI_Calibrate(&fastSlave);
+	calibrating = 0;
+	uint64_t cycles = SIM_GetCycles() - start;
+
+	/* Let the queued transaction finish */
+	vTaskDelay(2);
+
+	prvExpect(submittedWhileCalibrating, "helper submitted during calibration");
+	prvExpect(calibrationTransaction.Done && memcmp(calibrationRx, responses, LENGTH) == 0, "transaction after calibration");
+	prvExpect(fastModel.Slave.selects == selects + 1 && fastModel.Slave.emptySelects == emptySelects, "calibration doesn't select the slave");
+	prvExpect(fastModel.logCount == LENGTH, "only the transaction reached the slave");
+	prvExpect(spi1.PollMaxLength < spi1.DMAMinLength, "calibrated thresholds");
+
+	printf("  calibrated in %lu cycles: polled up to %u bytes, DMA from %u bytes\n",
+		   (unsigned long)cycles, spi1.PollMaxLength, spi1.DMAMinLength);
+}
+
+static void prvTestTask(void* pvParameters)
+{
+	(void)pvParameters;
+	SPI_Device_Init(&spi1);
+	SPI_SlaveInit(&fastSlave);
+	SPI_SlaveInit(&slowSlave);
+	SIM_ScriptedSlave_Init(&fastModel, SPI1, GPIOA, GPIO_Pin_4);
+	SIM_ScriptedSlave_Init(&slowModel, SPI1, GPIOB, GPIO_Pin_0);
+
+	prvTestMode(SPI_TransferMode_Polled, LENGTH, LENGTH + 1, "polled");
+	prvTestMode(SPI_TransferMode_Interrupt, 0, LENGTH + 1, "interrupt");
+	prvTestMode(SPI_TransferMode_DMA, 0, 1, "DMA");
+	prvTestSlaveClocks();
+	prvTestQueue();
+	prvTestCalibrate();
+}
+
+/* Interrupt Handlers --------------------------------------------------------*/
+void SPI1_IRQHandler(void)
+{
+	SPI_Interrupt(&spi1);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+	SPI_DMAInterrupt(&spi1);
+}
+
+/* Functions -----------------------------------------------------------------*/
+int main(void)
+{
+	for (uint32_t i = 0; i < LENGTH; i++)
+	{
+		txData[i] = (uint8_t)(0x10 + i);
+		responses[i] = (uint8_t)(0xA0 + i);
+	}
+
+	xTaskCreate(prvTestTask, "test", configMINIMAL_STACK_SIZE, 0, TEST_PRIORITY, 0);
+	vTaskStartScheduler();
+
+	printf("spi transfer: %lu errors: %s\n", (unsigned long)errors, errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
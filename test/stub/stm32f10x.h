@@ -0,0 +1,18 @@
+/**
+ ******************************************************************************
+ * @file	stm32f10x.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	Replaces the device header for host tests that don't touch any
+ *			peripherals, e.g. the circular buffer tests
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef STM32F10X_H_
+#define STM32F10X_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f10x_host.h"
+
+#endif /* STM32F10X_H_ */
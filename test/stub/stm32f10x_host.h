@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file	stm32f10x_host.h
+ * @version	0.1
+ * @date	2026-10-17
+ * @brief	The parts of stm32f10x.h and the CMSIS core that the drivers use
+ *			for synchronization, implemented for the host so the drivers can
+ *			be tested with several threads on a PC
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef STM32F10X_HOST_H_
+#define STM32F10X_HOST_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Typedefs ------------------------------------------------------------------*/
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrorStatus;
+
+/* Functions -----------------------------------------------------------------*/
+/*
+ * __DMB() is a full fence, unless STM32F10X_HOST_SINGLE_THREAD is defined for
+ * benchmarks that only run one thread. LDREX/STREX are emulated with a
+ * per-thread reservation that STREX turns into a compare-and-swap, so it
+ * fails exactly when another thread has changed the value since LDREX
+ */
+#if defined(STM32F10X_HOST_SINGLE_THREAD)
+/* Only keeps the compiler from reordering, close to what a DMB costs on a Cortex-M3 */
+#define __DMB()		__asm__ volatile("" : : : "memory")
+#else
+#define __DMB()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#if defined(__cplusplus)
+#define STM32F10X_HOST_THREAD_LOCAL	thread_local
+#else
+#define STM32F10X_HOST_THREAD_LOCAL	__thread
+#endif
+
+static STM32F10X_HOST_THREAD_LOCAL volatile uint32_t* prvHostReservationAddress;
+static STM32F10X_HOST_THREAD_LOCAL uint32_t prvHostReservationValue;
+
+static inline uint32_t __LDREXW(volatile uint32_t* Address)
+{
+	prvHostReservationAddress = Address;
+	prvHostReservationValue = __atomic_load_n(Address, __ATOMIC_SEQ_CST);
+	return prvHostReservationValue;
+}
+
+static inline uint32_t __STREXW(uint32_t Value, volatile uint32_t* Address)
+{
+	uint32_t expected = prvHostReservationValue;
+	if (prvHostReservationAddress != Address)
+		return 1;
+
+	prvHostReservationAddress = 0;
+	return __atomic_compare_exchange_n(Address, &expected, Value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 0 : 1;
+}
+
+static inline void __CLREX(void)
+{
+	prvHostReservationAddress = 0;
+}
+
+#endif /* STM32F10X_HOST_H_ */